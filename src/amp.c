@@ -0,0 +1,326 @@
+/*
+ * AMP shared-memory frame rings
+ *
+ * Ring n carries the frames produced by core n (see amp.h for who produces
+ * what). head is written only by the producer and tail only by the consumer,
+ * each on its own cache line. The shared window is ordinary cacheable RAM
+ * mapped identically by every image (qemu-arm.c), so the inner-shareable
+ * barriers below are all the coherency the rings need.
+ */
+
+#include "amp.h"
+
+#ifdef AMP_CORE_ID
+
+#include "includes.h"
+#include "virtio_net.h"
+#include <net.h>
+#include <lib_def.h>
+#include <bsp_int.h>
+#include <bsp_cpu.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define AMP_SHM_MAGIC           0x414d5031u     /* "AMP1" */
+#define AMP_PEER_ID             (AMP_CORE_NBR - 1u - AMP_CORE_ID)
+
+#define AMP_STATE_OFF           0u
+#define AMP_STATE_UP            1u      /* Rings and doorbell ready */
+#define AMP_STATE_NET_UP        2u      /* Owned NIC initialised */
+
+struct amp_slot {
+    u32 len;
+    u8 rsvd[60];                        /* Frame data starts on its own cache line */
+    u8 data[AMP_SLOT_SIZE];
+} __attribute__((aligned(64)));
+
+struct amp_ring {
+    volatile u32 head;                  /* Producer-owned line */
+    u32 drops;                          /* Frames refused because the ring was full */
+    u8 pad0[56];
+    volatile u32 tail;                  /* Consumer-owned line */
+    u8 pad1[60];
+    struct amp_slot slot[AMP_RING_SLOTS];
+} __attribute__((aligned(64)));
+
+struct amp_shm {
+    volatile u32 magic;
+    volatile u32 state[AMP_CORE_NBR];
+    u8 wan_mac[6];
+    struct amp_ring ring[AMP_CORE_NBR];
+};
+
+_Static_assert(sizeof(struct amp_shm) <= AMP_SHM_SIZE, "AMP rings do not fit the shared window");
+_Static_assert((AMP_RING_SLOTS & (AMP_RING_SLOTS - 1u)) == 0u, "AMP_RING_SLOTS must be a power of two");
+
+extern char __amp_shm_start[];          /* linker.ld */
+
+static struct amp_shm *const amp_shm = (struct amp_shm *)__amp_shm_start;
+
+static u32 amp_tx_tail;                 /* Producer's last view of the peer's tail */
+static u32 amp_tx_resv;                 /* Next slot to hand to a local sender */
+static bool amp_tx_done[AMP_RING_SLOTS]; /* Slot filled, waiting to be published */
+static OS_TCB amp_rx_task_tcb;
+static OS_STK amp_rx_task_stk[AMP_RX_TASK_STK_SIZE / sizeof(OS_STK)];
+
+#if (AMP_CORE_ID == AMP_CORE_LAN)
+static struct eth_device amp_wan_proxy;
+#endif
+
+/**
+ * amp_deliver() - Hand a frame received from the peer to this core's stack
+ * @frame: Frame inside a ring slot; the slot is released when this returns
+ * @len: Frame length in bytes
+ */
+static void amp_deliver(u8 *frame, int len)
+{
+#if (AMP_CORE_ID == AMP_CORE_LAN)
+    /* Frame arrived on the WAN NIC: route/NAT it in place */
+    net_process_received_packet(frame, len);
+#else
+    /* Frame routed by the LAN core: put it on the wire */
+    struct virtio_net_dev *dev = virtio_net_get_device(0);
+
+    if (dev) {
+        virtio_net_send(&dev->eth_dev, frame, len);
+    }
+#endif
+}
+
+static void amp_ring_isr(CPU_INT32U int_id)
+{
+    (void)int_id;
+
+    OSTaskNotifyPost(AMP_RX_TASK_PRIO, 1u, OS_NOTIFY_OPT_INC);
+}
+
+/* Consumer side of the peer's ring */
+static void amp_rx_task(void *p_arg)
+{
+    struct amp_ring *ring = &amp_shm->ring[AMP_PEER_ID];
+    struct amp_slot *slot;
+    u32 tail = ring->tail;
+    u32 head;
+    INT8U err;
+
+    (void)p_arg;
+
+    while (1) {
+        OSTaskNotifyPend(0, ~0u, &err);
+
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            do {
+                slot = &ring->slot[tail & (AMP_RING_SLOTS - 1u)];
+                amp_deliver(slot->data, (int)slot->len);
+                tail++;
+                __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+            } while (tail != head);
+
+            /* Pairs with the barrier in amp_ring_send(): either the producer
+             * sees the ring empty and rings the doorbell, or we see its head */
+            __asm__ volatile("dmb ish" ::: "memory");
+            head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        }
+    }
+}
+
+static int amp_wait_peer(u32 state)
+{
+    u32 waited;
+
+    for (waited = 0u; waited < AMP_PEER_TIMEOUT_MS; waited += 10u) {
+        if (__atomic_load_n(&amp_shm->state[AMP_PEER_ID], __ATOMIC_ACQUIRE) >= state) {
+            return 0;
+        }
+        OSTimeDlyHMSM(0, 0, 0, 10);
+    }
+
+    return -1;
+}
+
+#if (AMP_CORE_ID == AMP_CORE_LAN)
+static int amp_proxy_send(struct eth_device *dev, void *packet, int length)
+{
+    (void)dev;
+
+    return amp_ring_send(packet, length);
+}
+#endif
+
+/**
+ * amp_ring_send() - Queue a frame for the peer core
+ * @frame: Frame to copy into the ring
+ * @len: Frame length in bytes
+ *
+ * Several tasks of this image may transmit, so each sender reserves a slot
+ * with interrupts off, copies the frame with interrupts on, and publishes
+ * under a second short critical section. Publishing advances head over
+ * every filled slot in order, so a sender preempted mid-copy only delays
+ * the frames behind it. Across cores the ring stays single-producer.
+ *
+ * Return: 0 on success, -1 if the frame is too big or the ring is full.
+ */
+int amp_ring_send(const void *frame, int len)
+{
+    struct amp_ring *ring = &amp_shm->ring[AMP_CORE_ID];
+    struct amp_slot *slot;
+    bool was_empty = false;
+    u32 resv;
+    u32 head;
+    u32 start;
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (len <= 0 || len > (int)AMP_SLOT_SIZE) {
+        return -1;
+    }
+
+    OS_ENTER_CRITICAL();
+    resv = amp_tx_resv;
+
+    /* Only re-read the consumer's line when the cached view says full */
+    if ((u32)(resv - amp_tx_tail) >= AMP_RING_SLOTS) {
+        amp_tx_tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if ((u32)(resv - amp_tx_tail) >= AMP_RING_SLOTS) {
+            ring->drops++;
+            OS_EXIT_CRITICAL();
+            return -1;
+        }
+    }
+    amp_tx_resv = resv + 1u;
+    OS_EXIT_CRITICAL();
+
+    /* The slot is ours until head passes it: copy with interrupts on */
+    slot = &ring->slot[resv & (AMP_RING_SLOTS - 1u)];
+    memcpy(slot->data, frame, len);
+    slot->len = (u32)len;
+
+    OS_ENTER_CRITICAL();
+    amp_tx_done[resv & (AMP_RING_SLOTS - 1u)] = true;
+    start = ring->head;
+    head = start;
+    while ((head != amp_tx_resv) && amp_tx_done[head & (AMP_RING_SLOTS - 1u)]) {
+        amp_tx_done[head & (AMP_RING_SLOTS - 1u)] = false;
+        head++;
+    }
+    if (head != start) {
+        __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+        /* Doorbell only when the consumer had drained everything before us */
+        __asm__ volatile("dmb ish" ::: "memory");
+        was_empty = (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == start);
+    }
+    OS_EXIT_CRITICAL();
+
+    if (was_empty) {
+        BSP_SGITrig(BSP_SGI_TARGET(AMP_PEER_ID) | AMP_SGI_RING);
+    }
+
+    return 0;
+}
+
+/**
+ * amp_init() - Set up the shared rings and this core's consumer
+ *
+ * The LAN core clears the shared window before it starts the peer, so the
+ * peer only has to check the magic.
+ *
+ * Return: 0 on success, -1 on failure.
+ */
+int amp_init(void)
+{
+    INT8U err;
+
+#if (AMP_CORE_ID == AMP_CORE_LAN)
+    memset(amp_shm, 0, sizeof(*amp_shm));
+    __atomic_store_n(&amp_shm->magic, AMP_SHM_MAGIC, __ATOMIC_RELEASE);
+#else
+    if (__atomic_load_n(&amp_shm->magic, __ATOMIC_ACQUIRE) != AMP_SHM_MAGIC) {
+        printf("[AMP] Shared memory not initialised by core %u\n", AMP_CORE_LAN);
+        return -1;
+    }
+#endif
+
+    amp_tx_tail = amp_shm->ring[AMP_CORE_ID].tail;
+    amp_tx_resv = amp_shm->ring[AMP_CORE_ID].head;
+
+    err = OSTaskCreateStatic(&amp_rx_task_tcb,
+                             amp_rx_task,
+                             NULL,
+                             &amp_rx_task_stk[AMP_RX_TASK_STK_SIZE / sizeof(OS_STK) - 1],
+                             AMP_RX_TASK_PRIO);
+    if (err != OS_ERR_NONE) {
+        printf("[AMP] Failed to create ring task (err=%d)\n", err);
+        return -1;
+    }
+
+    BSP_IntVectSet(AMP_SGI_RING, BSP_INT_PRIO_DFLT, 0u, amp_ring_isr);
+    BSP_IntSrcEn(AMP_SGI_RING);
+
+    __atomic_store_n(&amp_shm->state[AMP_CORE_ID], AMP_STATE_UP, __ATOMIC_RELEASE);
+    printf("[AMP] Core %u up, %u-slot rings at %p\n",
+           AMP_CORE_ID, AMP_RING_SLOTS, (void *)amp_shm);
+
+    return 0;
+}
+
+/**
+ * amp_peer_start() - Boot the WAN image on its core (LAN core only)
+ *
+ * Return: 0 once the peer reports its rings ready, -1 on failure.
+ */
+int amp_peer_start(void)
+{
+#if (AMP_CORE_ID == AMP_CORE_LAN)
+    if (BSP_CPU_StartImage(AMP_CORE_WAN, AMP_IMAGE_BASE(AMP_CORE_WAN)) != DEF_OK) {
+        printf("[AMP] PSCI refused to start core %u\n", AMP_CORE_WAN);
+        return -1;
+    }
+
+    if (amp_wait_peer(AMP_STATE_UP) != 0) {
+        printf("[AMP] Core %u did not come up\n", AMP_CORE_WAN);
+        return -1;
+    }
+#endif
+
+    return 0;
+}
+
+/**
+ * amp_net_attach() - Connect the two halves of the network stack
+ *
+ * Call after eth_init(). The WAN core publishes its NIC's MAC; the LAN core
+ * waits for it and registers the proxy device that stands in for the WAN
+ * NIC, so net_register_iface() binds it to the WAN interface as usual.
+ *
+ * Return: 0 on success, -1 on failure.
+ */
+int amp_net_attach(void)
+{
+#if (AMP_CORE_ID == AMP_CORE_LAN)
+    if (amp_wait_peer(AMP_STATE_NET_UP) != 0) {
+        printf("[AMP] WAN core has no network device\n");
+        return -1;
+    }
+
+    memcpy(amp_wan_proxy.enetaddr, amp_shm->wan_mac, sizeof(amp_wan_proxy.enetaddr));
+    sprintf(amp_wan_proxy.name, "amp-wan");
+    amp_wan_proxy.send = amp_proxy_send;
+
+    eth_register(&amp_wan_proxy);
+    net_register_iface(&amp_wan_proxy);
+#else
+    struct virtio_net_dev *dev = virtio_net_get_device(0);
+
+    if (!dev) {
+        return -1;
+    }
+
+    memcpy(amp_shm->wan_mac, dev->eth_dev.enetaddr, sizeof(amp_shm->wan_mac));
+    __atomic_store_n(&amp_shm->state[AMP_CORE_ID], AMP_STATE_NET_UP, __ATOMIC_RELEASE);
+#endif
+
+    return 0;
+}
+
+#endif /* AMP_CORE_ID */
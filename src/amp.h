@@ -0,0 +1,52 @@
+/*
+ * Asymmetric multiprocessing (AMP) support
+ *
+ * `make amp` links one uC/OS-II image per core (-DAMP_CORE_ID=n). Each image
+ * has its own kernel, heap and page tables in a 64M slot of RAM (linker.ld);
+ * the images only share the 1M window after the last slot, which holds one
+ * single-producer/single-consumer frame ring per direction. A producer rings
+ * the consumer with an SGI when the ring goes from empty to non-empty.
+ *
+ * Partitioning: core 0 owns the LAN NIC and all NAT/ARP state and sees the
+ * WAN NIC through a proxy eth_device whose send() feeds the ring. Core 1
+ * owns the WAN NIC only: it forwards every received frame to core 0 and
+ * transmits whatever core 0 queues for it.
+ */
+
+#ifndef _AMP_H_
+#define _AMP_H_
+
+#include <asm/types.h>
+
+#define AMP_CORE_NBR            2u
+#define AMP_CORE_LAN            0u      /* LAN NIC, NAT and ARP state */
+#define AMP_CORE_WAN            1u      /* WAN NIC, I/O only */
+
+/* Image and shared-memory layout, keep in sync with linker.ld */
+#define AMP_IMAGE_SIZE          0x4000000UL
+#define AMP_IMAGE_BASE(core)    (0x40000000UL + (unsigned long)(core) * AMP_IMAGE_SIZE)
+#define AMP_SHM_SIZE            0x100000UL
+
+#define AMP_RING_SLOTS          256u    /* Power of two */
+#define AMP_SLOT_SIZE           1536u   /* PKTSIZE_ALIGN */
+#define AMP_SGI_RING            2u      /* Doorbell; SGI 1 is BSP_CPU_SGI_WAKE */
+
+#define AMP_RX_TASK_PRIO        9u      /* Above the virtio RX tasks (10+) */
+#define AMP_RX_TASK_STK_SIZE    8192u
+
+#define AMP_PEER_TIMEOUT_MS     5000u   /* Peer boot and NIC probe */
+
+#ifdef AMP_CORE_ID
+
+#if (AMP_CORE_ID >= AMP_CORE_NBR)
+#error "AMP_CORE_ID out of range"
+#endif
+
+int amp_init(void);
+int amp_peer_start(void);
+int amp_net_attach(void);
+int amp_ring_send(const void *frame, int len);
+
+#endif /* AMP_CORE_ID */
+
+#endif /* _AMP_H_ */
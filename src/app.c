@@ -42,6 +42,7 @@
 
 #include  <bsp.h>
 #include  <bsp_os.h>
+#include  <bsp_cpu.h>
 #include  <cpu.h>
 #include  <cpu_core.h>
 #include  <lib_mem.h>
@@ -53,6 +54,9 @@
 #include  "virtio_net.h"
 #include  "net_ping.h"
 #include  "nat.h"
+#include  "amp.h"
+#include  "pktbuf.h"
+#include  "pl011.h"
 
 /* Enable NAT functionality - Full NAT Router */
 #define ENABLE_NAT 1
@@ -137,10 +141,22 @@ int main (void)
 
 static void  AppTaskStart (void *p_arg)
 {
+#ifndef AMP_CORE_ID
+    CPU_INT32U  cpu_nbr;
+#endif
+
+
     (void)p_arg;
 
     uart_puts("AppTaskStart init\n");
 
+#ifdef AMP_CORE_ID
+    printf("[AMP] Image for core %u\n", (unsigned)AMP_CORE_ID);   /* Peer bring-up: see AppTaskNetwork()  */
+#else
+    cpu_nbr = BSP_CPU_StartAll();                               /* Secondaries idle until tasks are pinned to them      */
+    printf("[SMP] %u core(s) running\n", (unsigned)cpu_nbr);
+#endif
+
     OSTaskCreateExt(AppTaskNetwork,
                     0,
                     &AppTaskNetworkStk[APP_CFG_TASK_START_STK_SIZE - 1],
@@ -161,6 +177,18 @@ extern void net_enable_nat(void);
 
 #define ENABLE_NET_SELF_TEST   0u
 #define NAT_MAINTENANCE_TICKS  1000u
+#define PROF_REPORT_TICKS      (10u * OS_TICKS_PER_SEC)    /* Run time report period, 0 disables */
+
+/* Console keys, read whenever UART RX wakes the network task */
+#define APP_KEY_TRACE_DUMP     't'     /* Dump the trace rings, for tools/trace2json.py */
+#define APP_KEY_IRQOFF         'i'     /* Start IRQs-off measurement, then report it */
+#define APP_KEY_IRQOFF_STOP    'I'     /* Stop IRQs-off measurement */
+#define APP_KEY_HEAP           'h'     /* Heap usage and fragmentation */
+#define APP_KEY_PKTBUF         'p'     /* Packet buffer pool usage */
+
+/* Default WAN gateway: next hop for destinations off the WAN /24, pinned in
+ * the ARP cache and refreshed in the background */
+static const u8 app_wan_gateway_ip[4] = {10u, 3u, 5u, 103u};
 
 #if ENABLE_NET_SELF_TEST
 static const struct net_ping_target app_ping_targets[] = {
@@ -179,13 +207,58 @@ static const struct net_ping_target app_ping_targets[] = {
 };
 #endif
 
+static void  AppConsoleCmd (int key)
+{
+    switch (key) {
+#if OS_TRACE_EN > 0u
+    case APP_KEY_TRACE_DUMP:
+        OSTraceDump();
+        break;
+#endif
+
+#if OS_CPU_INT_DIS_MEAS_EN > 0u
+    case APP_KEY_IRQOFF:
+        if (OS_CPU_IntDisMeasEn == OS_FALSE) {
+            OS_CPU_IntDisMeasCtl(OS_TRUE);
+            printf("[IRQOFF] Measuring, press '%c' for the report, '%c' to stop\n",
+                   APP_KEY_IRQOFF, APP_KEY_IRQOFF_STOP);
+        } else {
+            BSP_OS_IntDisReport();
+        }
+        break;
+
+    case APP_KEY_IRQOFF_STOP:
+        OS_CPU_IntDisMeasCtl(OS_FALSE);
+        printf("[IRQOFF] Stopped\n");
+        break;
+#endif
+
+    case APP_KEY_HEAP:
+        malloc_stats();
+        break;
+
+    case APP_KEY_PKTBUF:
+        pktbuf_report();
+        break;
+
+    default:
+        break;
+    }
+}
+
 static void  AppTaskNetwork (void *p_arg)
 {
     int rc;
+    int key;
+    INT8U err;
+#if OS_TASK_PROFILE_EN > 0u
+    INT32U prof_last;
+#endif
 
     (void)p_arg;
 
     uart_puts("AppTaskNetwork init\n");
+    OSTaskNameSet(OS_PRIO_SELF, (INT8U *)"App Network", &err);
 
     uart_puts("Initializing network driver...\n");
     rc = eth_init();
@@ -201,6 +274,23 @@ static void  AppTaskNetwork (void *p_arg)
 
     BSP_OS_TmrTickInit(1000);
 
+#ifdef AMP_CORE_ID
+    /* One image per core; frames cross over the shared-memory rings (amp.h).
+     * The peer handshake sleeps, so this runs once the tick is up. */
+    if ((amp_init() != 0) ||
+        (amp_peer_start() != 0) ||
+        (amp_net_attach() != 0)) {
+        uart_puts("ERROR: AMP bring-up failed!\n");
+        while (DEF_TRUE) {
+            OSTimeDlyHMSM(0, 0, 5, 0);
+        }
+    }
+#if (AMP_CORE_ID == AMP_CORE_WAN)
+    uart_puts("[AMP] WAN I/O core running\n");
+    OSTaskDel(OS_PRIO_SELF);                                    /* The RX and ring tasks do the rest */
+#endif
+#endif
+
 #if ENABLE_NAT
     /* Enable NAT - Full Router Mode */
     uart_puts("\n========================================\n");
@@ -208,6 +298,7 @@ static void  AppTaskNetwork (void *p_arg)
     uart_puts("========================================\n");
     uart_puts("[NAT] Initializing NAT router...\n");
     net_enable_nat();
+    net_neigh_add_gateway(app_wan_gateway_ip, NULL);
     uart_puts("[NAT] NAT router enabled for ICMP/TCP/UDP\n");
     uart_puts("[INFO] LAN: 192.168.1.1/24 -> WAN: 10.3.5.99\n");
     uart_puts("[INFO] Ready to forward traffic from LAN to WAN\n\n");
@@ -237,12 +328,32 @@ static void  AppTaskNetwork (void *p_arg)
     uart_puts("Network initialization completed.\n");
     uart_puts("NAT router is ready to forward traffic.\n");
 
+    uart_rx_notify(APP_CFG_TASK_START_PRIO + 1);                /* Key presses end the wait below early */
+
+#if OS_TASK_PROFILE_EN > 0u
+    prof_last = OSTimeGet();
+#endif
     while (DEF_TRUE) {
         INT32U ticks = OSTimeGet();
 
         nat_cleanup_expired(ticks);
-        arp_cache_cleanup(ticks);
+        net_neigh_refresh(ticks);
 
+#if OS_TASK_PROFILE_EN > 0u
+        if ((PROF_REPORT_TICKS > 0u) && ((ticks - prof_last) >= PROF_REPORT_TICKS)) {
+            BSP_OS_ProfReport();
+            prof_last = ticks;
+        }
+#endif
+
+        while ((key = uart_trygetc()) >= 0) {
+            AppConsoleCmd(key);
+        }
+
+#if OS_TASK_NOTIFY_EN > 0u
+        (void)OSTaskNotifyPend(NAT_MAINTENANCE_TICKS, ~0u, &err);
+#else
         OSTimeDly(NAT_MAINTENANCE_TICKS);
+#endif
     }
 }
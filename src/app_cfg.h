@@ -59,6 +59,41 @@ void  BSP_Ser_Printf (CPU_CHAR  *format, ...);
 #define  APP_TRACE_DBG(x)                ((APP_CFG_TRACE_LEVEL >= TRACE_LEVEL_DBG)   ? (void)(APP_CFG_TRACE x) : (void)0)
 
 
+/*
+*********************************************************************************************************
+*                                        KERNEL OBJECT TABLE
+*
+* Note(s) : (1) One row per firmware component that takes objects from the kernel pools:
+*
+*                   X(name, tasks, events, queues)
+*
+*               'events' counts every ECB (semaphores, mutexes, mailboxes and queues), 'queues' the OS_Qs
+*               among them.  os_cfg.h sizes OS_MAX_TASKS, OS_MAX_EVENTS and OS_MAX_QS from the column
+*               sums, so adding a component means adding its row here.
+*
+*           (2) Objects created with OSTaskCreateStatic(), OSSemCreateStatic() or OSQCreateStatic() live
+*               in their owner (e.g. the virtio-net RX task and queue of each queue pair, the AMP ring
+*               task) and have no row.
+*
+*           (3) APP_SPARE is headroom for objects created at run time by the test programs.
+*********************************************************************************************************
+*/
+
+#define  APP_CFG_OBJ_TBL(X)                                                                        \
+    X(APP_TASKS,   2u,  0u,                0u)          /* AppTaskStart, AppTaskNetwork         */ \
+    X(BSP_SER,     0u,  3u,                0u)          /* Tx wait, Rx wait and lock semaphores */ \
+    X(OS_TMR,      0u,  (2u * OS_TMR_EN),  0u)          /* OSTmrSem, OSTmrSemSignal             */ \
+    X(APP_SPARE,   6u,  4u,                2u)          /* Test programs, see Note (3)          */
+
+#define  APP_CFG_OBJ_TASKS(name, tasks, events, queues)    + (tasks)
+#define  APP_CFG_OBJ_EVENTS(name, tasks, events, queues)   + (events)
+#define  APP_CFG_OBJ_QS(name, tasks, events, queues)       + (queues)
+
+#define  APP_CFG_TASKS_TOT          (0u APP_CFG_OBJ_TBL(APP_CFG_OBJ_TASKS))
+#define  APP_CFG_EVENTS_TOT         (0u APP_CFG_OBJ_TBL(APP_CFG_OBJ_EVENTS))
+#define  APP_CFG_QS_TOT             (0u APP_CFG_OBJ_TBL(APP_CFG_OBJ_QS))
+
+
 
 
 #endif /* __APP_CFG_H__ */
@@ -198,4 +198,6 @@ int __asm_flush_l3_dcache(void);
 int __asm_invalidate_l3_icache(void);
 void __asm_switch_ttbr(u64 new_ttbr);
 
+void mmu_secondary_enable(void);
+
 #endif
@@ -152,11 +152,15 @@ void  BSP_Init (void)
 	IMX6_REG_AIPSTZ3_OPACR4 = 0x0;
 #endif
 	BSP_Int_Init();
+#if (BSP_INT_DIST_OWNER == DEF_YES)
 	if (BSP_Int_GICVariantGet() == 2u) {
 		GIC_Enable();
 	} else {
 		gic_v3_init();
 	}
+#else
+	BSP_IntInitCPU();	/* AMP: the core 0 image already set up the distributor */
+#endif
 	BSP_OS_UARTInit();
 	return;
 }
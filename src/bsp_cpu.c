@@ -0,0 +1,756 @@
+/*
+*********************************************************************************************************
+*
+*                                    MICRIUM BOARD SUPPORT PACKAGE
+*
+*                          (c) Copyright 2003-2015; Micrium, Inc.; Weston, FL
+*
+*               All rights reserved.  Protected by international copyright laws.
+*
+*               This BSP is provided in source form to registered licensees ONLY.  It is
+*               illegal to distribute this source code to any third party unless you receive
+*               written permission by an authorized Micrium representative.  Knowledge of
+*               the source code may NOT be used to develop a similar product.
+*
+*               Please help us continue to provide the Embedded community with the finest
+*               software available.  Your honesty is greatly appreciated.
+*
+*               You can contact us at www.micrium.com.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                    MICRIUM BOARD SUPPORT PACKAGE
+*                                  SECONDARY CORE BRING-UP & SCHEDULER
+*
+* Filename      : bsp_cpu.c
+* Version       : V1.00
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                             INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include  <lib_def.h>
+#include  <cpu.h>
+
+#include  <bsp.h>
+#include  <bsp_int.h>
+#include  <bsp_cpu.h>
+#include  <stdint.h>
+#include  <aarch64.h>
+#include  <uart.h>
+#include  <asm/types.h>
+#include  <asm/system.h>
+#include  <os_trace.h>                                         /* Recorder only; no kernel services on secondaries.    */
+
+
+/*
+*********************************************************************************************************
+*                                            LOCAL DEFINES
+*********************************************************************************************************
+*/
+
+#define  BSP_CPU_TMR_INT_ID            27u                      /* Virtual timer PPI, banked per core / 虛擬計時器 PPI */
+#define  BSP_CPU_START_TIMEOUT_MS     100u                      /* Wait for a core to report RUNNING.                   */
+
+
+/*
+*********************************************************************************************************
+*                                           LOCAL DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  struct  bsp_cpu_task {
+    BSP_CPU_TASK_FNCT   FnctPtr;                                /* Task body, NULL if the slot is free.                 */
+    void               *ArgPtr;
+    CPU_INT32U          Period;                                 /* Ticks between activations, 0 = BSP_CPU_TaskRdy() only*/
+    CPU_INT32U          NextTick;                               /* Next activation, in the owner core's ticks.          */
+    CPU_INT32U          RunCtr;                                 /* Number of completed activations.                     */
+} BSP_CPU_TASK;
+
+typedef  struct  bsp_cpu_data {
+    volatile  CPU_INT32U  RdyMask;                              /* Ready bitmap, bit n = prio n / 就緒位元圖            */
+    volatile  CPU_INT32U  State;                                /* BSP_CPU_STATE_xxx.                                   */
+    volatile  CPU_INT32U  PeriodMask;                           /* Tasks with a non-zero period / 週期任務位元圖        */
+    volatile  CPU_INT32U  TickCtr;                              /* Owner core's tick counter / 本核節拍計數            */
+    CPU_INT32U            TmrReload;                            /* Counter cycles per tick.                             */
+    CPU_INT64U            TmrLast;                              /* Deadline of the last tick.                           */
+    BSP_CPU_TASK          TaskTbl[BSP_CPU_TASK_PRIO_MAX];
+    BSP_INT_FNCT_PTR      IntVectTbl[ARM_GIC_INT_SRC_CNT];      /* This core's vector table / 本核向量表               */
+} __attribute__((aligned(64))) BSP_CPU_DATA;                    /* One cache line boundary per core / 每核對齊快取列   */
+
+
+/*
+*********************************************************************************************************
+*                                       LOCAL GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+static  BSP_CPU_DATA  BSP_CPU_Tbl[BSP_CPU_MAX];
+
+static  CPU_INT64U    BSP_CPU_StkTbl[BSP_CPU_MAX][BSP_CPU_STK_SIZE / sizeof(CPU_INT64U)] __attribute__((aligned(16)));
+
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+extern  void  BSP_CPU_SecondaryEntry(void);                     /* See bsp_cpu_a.S.                                     */
+
+static  void  BSP_CPU_TmrInit      (BSP_CPU_DATA  *p_cpu);
+
+static  void  BSP_CPU_TmrTickHandler(CPU_INT32U    int_id);
+
+
+/*
+*********************************************************************************************************
+*                                         LOCAL HELPERS
+*********************************************************************************************************
+*/
+
+static  CPU_INT64S  BSP_CPU_PSCI_Call (CPU_INT64U  fnct_id,
+                                       CPU_INT64U  arg0,
+                                       CPU_INT64U  arg1,
+                                       CPU_INT64U  arg2)
+{
+    register  CPU_INT64U  x0 __asm__("x0") = fnct_id;
+    register  CPU_INT64U  x1 __asm__("x1") = arg0;
+    register  CPU_INT64U  x2 __asm__("x2") = arg1;
+    register  CPU_INT64U  x3 __asm__("x3") = arg2;
+
+
+#if (BSP_CPU_PSCI_CONDUIT_SMC > 0u)
+    __asm__ __volatile__("smc #0"
+#else
+    __asm__ __volatile__("hvc #0"
+#endif
+                         : "+r" (x0), "+r" (x1), "+r" (x2), "+r" (x3)
+                         :
+                         : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11",
+                           "x12", "x13", "x14", "x15", "x16", "x17", "memory");
+
+    return ((CPU_INT64S)x0);
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                          GLOBAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                            BSP_CPU_IdGet()
+*
+* Description : Return the index of the calling core.
+*
+* Argument(s) : none.
+*
+* Return(s)   : MPIDR_EL1.Aff0, which QEMU virt numbers 0..N-1.
+*
+* Caller(s)   : Application, BSP.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  BSP_CPU_IdGet (void)
+{
+    CPU_INT64U  mpidr;
+
+
+    __asm__ __volatile__("mrs %0, mpidr_el1" : "=r" (mpidr));
+
+    return ((CPU_INT32U)(mpidr & DEF_INT_08_MASK));
+}
+
+
+/*
+*********************************************************************************************************
+*                                            BSP_CPU_Start()
+*
+* Description : Power on a secondary core through PSCI CPU_ON and wait until its scheduler runs.
+*
+* Argument(s) : cpu         Core to start, 1..BSP_CPU_MAX-1.
+*
+* Return(s)   : DEF_OK      if the core reported BSP_CPU_STATE_RUNNING,
+*               DEF_FAIL    otherwise (no such core, PSCI refused, or timeout).
+*
+* Caller(s)   : Application, on CPU0 once BSP_Init() has set up the distributor.
+*
+* Note(s)     : (1) The new core starts with its MMU and caches off and reads the page-table descriptor
+*                   and its stack through memory, so CPU0's data cache is cleaned first.
+*                   新核心啟動時 MMU 與快取皆關閉，故先清除 CPU0 資料快取。
+*
+*               (2) The stack top is passed as the PSCI context id and arrives in x0 at
+*                   BSP_CPU_SecondaryEntry.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  BSP_CPU_Start (CPU_INT32U  cpu)
+{
+    BSP_CPU_DATA  *p_cpu;
+    CPU_INT64S     err;
+    CPU_INT64U     stk_top;
+    CPU_INT64U     deadline;
+
+
+    if ((cpu == 0u) || (cpu >= BSP_CPU_MAX)) {
+        return (DEF_FAIL);
+    }
+
+    p_cpu = &BSP_CPU_Tbl[cpu];
+    if (p_cpu->State == BSP_CPU_STATE_RUNNING) {
+        return (DEF_OK);
+    }
+
+    p_cpu->State = BSP_CPU_STATE_STARTING;
+    stk_top      = (CPU_INT64U)&BSP_CPU_StkTbl[cpu][BSP_CPU_STK_SIZE / sizeof(CPU_INT64U)];
+
+    __asm_flush_dcache_all();                                   /* See Note #1.                                         */
+
+    err = BSP_CPU_PSCI_Call(BSP_CPU_PSCI_CPU_ON,
+                            cpu,                                /* Target MPIDR: Aff0 = cpu.                            */
+                            (CPU_INT64U)BSP_CPU_SecondaryEntry,
+                            stk_top);                           /* See Note #2.                                         */
+    if ((err != BSP_CPU_PSCI_SUCCESS) &&
+        (err != BSP_CPU_PSCI_ALREADY_ON)) {
+        p_cpu->State = BSP_CPU_STATE_OFF;
+        return (DEF_FAIL);
+    }
+
+    deadline = raw_read_cntvct_el0()
+             + ((CPU_INT64U)raw_read_cntfrq_el0() * BSP_CPU_START_TIMEOUT_MS) / 1000u;
+    while (p_cpu->State != BSP_CPU_STATE_RUNNING) {
+        if (raw_read_cntvct_el0() > deadline) {
+            return (DEF_FAIL);
+        }
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                          BSP_CPU_StartAll()
+*
+* Description : Start every secondary core the platform provides.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Number of cores running, CPU0 included.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : (1) Cores that QEMU was not given (-smp) are rejected by PSCI and simply skipped.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  BSP_CPU_StartAll (void)
+{
+    CPU_INT32U  cpu;
+    CPU_INT32U  nbr;
+
+
+    nbr = 1u;
+    for (cpu = 1u; cpu < BSP_CPU_MAX; cpu++) {
+        if (BSP_CPU_Start(cpu) == DEF_OK) {
+            nbr++;
+        }
+    }
+
+    return (nbr);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         BSP_CPU_StartImage()
+*
+* Description : Power on a core at the reset entry of a separately linked image (AMP builds).
+*
+* Argument(s) : cpu         Core to start, 1..BSP_CPU_MAX-1.
+*
+*               entry       Physical address of the image's _Reset.
+*
+* Return(s)   : DEF_OK      if PSCI accepted the request,
+*               DEF_FAIL    otherwise.
+*
+* Caller(s)   : amp_peer_start().
+*
+* Note(s)     : (1) The image runs its own startup code and kernel, so there is no BSP_CPU_Tbl[] state
+*                   to wait on; the caller handshakes through shared memory instead.
+*                   目標映像自行初始化，無 BSP_CPU_Tbl[] 狀態可等待，由呼叫端經共享記憶體確認。
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  BSP_CPU_StartImage (CPU_INT32U  cpu,
+                                 CPU_INT64U  entry)
+{
+    CPU_INT64S  err;
+
+
+    if ((cpu == 0u) || (cpu >= BSP_CPU_MAX)) {
+        return (DEF_FAIL);
+    }
+
+    __asm_flush_dcache_all();                                   /* Shared memory set up by this core, caches off there. */
+
+    err = BSP_CPU_PSCI_Call(BSP_CPU_PSCI_CPU_ON,
+                            cpu,
+                            entry,
+                            0u);
+    if ((err != BSP_CPU_PSCI_SUCCESS) &&
+        (err != BSP_CPU_PSCI_ALREADY_ON)) {
+        return (DEF_FAIL);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         BSP_CPU_TaskCreate()
+*
+* Description : Pin a run-to-completion task to a secondary core.
+*
+* Argument(s) : cpu         Owner core, 1..BSP_CPU_MAX-1.
+*
+*               prio        Priority on that core, 0 (highest) .. BSP_CPU_TASK_PRIO_MAX-1.  Also the task's
+*                           handle for BSP_CPU_TaskRdy().
+*
+*               p_fnct      Task body.  Runs to completion each time the task is made ready.
+*
+*               p_arg       Argument passed to p_fnct.
+*
+*               period      Ticks of the owner core between activations, or 0 for a task that only runs
+*                           when another core or an ISR calls BSP_CPU_TaskRdy().
+*
+* Return(s)   : DEF_OK      if the task was created,
+*               DEF_FAIL    if an argument is invalid or the priority is taken.
+*
+* Caller(s)   : Application, from any core.
+*
+* Note(s)     : (1) The body pointer is published last, with release ordering, so the owner core never
+*                   runs a half-filled slot.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  BSP_CPU_TaskCreate (CPU_INT32U         cpu,
+                                 CPU_INT32U         prio,
+                                 BSP_CPU_TASK_FNCT  p_fnct,
+                                 void              *p_arg,
+                                 CPU_INT32U         period)
+{
+    BSP_CPU_DATA  *p_cpu;
+    BSP_CPU_TASK  *p_task;
+
+
+    if ((cpu == 0u) || (cpu >= BSP_CPU_MAX) ||
+        (prio >= BSP_CPU_TASK_PRIO_MAX)     ||
+        (p_fnct == DEF_NULL)) {
+        return (DEF_FAIL);
+    }
+
+    p_cpu  = &BSP_CPU_Tbl[cpu];
+    p_task = &p_cpu->TaskTbl[prio];
+    if (p_task->FnctPtr != DEF_NULL) {
+        return (DEF_FAIL);
+    }
+
+    p_task->ArgPtr   = p_arg;
+    p_task->Period   = period;
+    p_task->NextTick = p_cpu->TickCtr + period;
+    p_task->RunCtr   = 0u;
+    __atomic_store_n(&p_task->FnctPtr, p_fnct, __ATOMIC_RELEASE); /* See Note #1.                                       */
+
+    if (period != 0u) {
+        (void)__atomic_fetch_or(&p_cpu->PeriodMask, DEF_BIT(prio), __ATOMIC_ACQ_REL);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                           BSP_CPU_TaskRdy()
+*
+* Description : Make a secondary core's task ready and wake that core.
+*
+* Argument(s) : cpu         Owner core of the task.
+*
+*               prio        Task priority on that core.
+*
+* Return(s)   : DEF_OK      if the ready bit was set,
+*               DEF_FAIL    if an argument is invalid.
+*
+* Caller(s)   : Application and ISRs, on any core.
+*
+* Note(s)     : (1) A remote core gets BSP_CPU_SGI_WAKE through BSP_SGITrig(), which pulls it out of WFI;
+*                   the ready bit is already visible when the SGI is taken.  Setting a bit that is already
+*                   set coalesces with the pending activation.
+*                   遠端核心以 SGI 喚醒；重複設定已就緒的位元會與尚未執行的啟動合併。
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  BSP_CPU_TaskRdy (CPU_INT32U  cpu,
+                              CPU_INT32U  prio)
+{
+    if ((cpu == 0u) || (cpu >= BSP_CPU_MAX) || (prio >= BSP_CPU_TASK_PRIO_MAX)) {
+        return (DEF_FAIL);
+    }
+
+    (void)__atomic_fetch_or(&BSP_CPU_Tbl[cpu].RdyMask, DEF_BIT(prio), __ATOMIC_ACQ_REL);
+
+    if (cpu != BSP_CPU_IdGet()) {
+        BSP_SGITrig(BSP_SGI_TARGET(cpu) | BSP_CPU_SGI_WAKE);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         BSP_CPU_IntVectSet()
+*
+* Description : Register a handler in the vector table of the calling secondary core.
+*
+* Argument(s) : int_id      Interrupt ID, 0..ARM_GIC_INT_SRC_CNT-1.
+*
+*               int_fnct    Handler, called with int_id from BSP_CPU_IntHandler().
+*
+* Return(s)   : DEF_OK      if the handler was registered,
+*               DEF_FAIL    otherwise.
+*
+* Caller(s)   : Tasks running on a secondary core.
+*
+* Note(s)     : (1) SGIs and PPIs are banked and simply land here.  An SPI is also routed to this core
+*                   once its handler is in place (BSP_IntAffinitySet()).
+*                   SGI/PPI 為每核私有；SPI 在處理函式就緒後導向本核心。
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  BSP_CPU_IntVectSet (CPU_INT32U        int_id,
+                                 BSP_INT_FNCT_PTR  int_fnct)
+{
+    CPU_INT32U  cpu;
+
+
+    cpu = BSP_CPU_IdGet();
+    if ((cpu == 0u) || (cpu >= BSP_CPU_MAX) || (int_id >= ARM_GIC_INT_SRC_CNT)) {
+        return (DEF_FAIL);
+    }
+
+    BSP_CPU_Tbl[cpu].IntVectTbl[int_id] = int_fnct;
+
+    if ((int_id >= 32u) && (int_fnct != DEF_NULL)) {            /* See Note #1.                                         */
+        __atomic_thread_fence(__ATOMIC_RELEASE);                 /* Handler visible before the first IRQ arrives.        */
+        BSP_IntAffinitySet(int_id, cpu);
+    }
+
+    return (DEF_OK);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         BSP_CPU_IntOwnerGet()
+*
+* Description : Find the secondary core that handles an interrupt.
+*
+* Argument(s) : int_id      Interrupt ID.
+*
+* Return(s)   : Lowest running secondary with a handler for int_id, BSP_CPU_MAX if there is none.
+*
+* Caller(s)   : BSP_IntAffinityRebalance().
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  BSP_CPU_IntOwnerGet (CPU_INT32U  int_id)
+{
+    CPU_INT32U  cpu;
+
+
+    if (int_id >= ARM_GIC_INT_SRC_CNT) {
+        return (BSP_CPU_MAX);
+    }
+
+    for (cpu = 1u; cpu < BSP_CPU_MAX; cpu++) {
+        if ((BSP_CPU_Tbl[cpu].State == BSP_CPU_STATE_RUNNING) &&
+            (BSP_CPU_Tbl[cpu].IntVectTbl[int_id] != DEF_NULL)) {
+            return (cpu);
+        }
+    }
+
+    return (BSP_CPU_MAX);
+}
+
+
+/*
+*********************************************************************************************************
+*                                        BSP_CPU_SecondaryMain()
+*
+* Description : Per-core scheduler of a secondary core.
+*
+* Argument(s) : cpu         Index of the calling core.
+*
+* Return(s)   : none, never returns.
+*
+* Caller(s)   : BSP_CPU_SecondaryEntry, once the MMU, caches and FP unit are on.
+*
+* Note(s)     : (1) The highest priority ready task is picked with a count-trailing-zeros on the ready
+*                   bitmap and run to completion; the pick repeats after every task.
+*                   以 CTZ 自就緒位元圖選出最高優先權任務並執行至完成。
+*
+*               (2) The ready check and WFI happen with IRQs masked.  A pending IRQ still ends WFI, and
+*                   is taken as soon as they are unmasked, so a wakeup between the check and WFI is not
+*                   lost.
+*********************************************************************************************************
+*/
+
+void  BSP_CPU_SecondaryMain (CPU_INT32U  cpu)
+{
+    BSP_CPU_DATA       *p_cpu;
+    BSP_CPU_TASK       *p_task;
+    BSP_CPU_TASK_FNCT   p_fnct;
+    CPU_INT32U          rdy;
+    CPU_INT32U          prio;
+
+
+    p_cpu = &BSP_CPU_Tbl[cpu];
+
+    BSP_IntInitCPU();
+    BSP_CPU_TmrInit(p_cpu);
+
+    __atomic_store_n(&p_cpu->State, BSP_CPU_STATE_RUNNING, __ATOMIC_RELEASE);
+
+    while (DEF_TRUE) {
+        CPU_IntDis();                                           /* See Note #2.                                         */
+        rdy = p_cpu->RdyMask;
+        if (rdy == 0u) {
+            CPU_WaitForInt();
+            CPU_IntEn();
+            continue;
+        }
+        CPU_IntEn();
+
+        prio = (CPU_INT32U)__builtin_ctz(rdy);                  /* See Note #1.                                         */
+        (void)__atomic_fetch_and(&p_cpu->RdyMask, ~DEF_BIT(prio), __ATOMIC_ACQ_REL);
+
+        p_task = &p_cpu->TaskTbl[prio];
+        p_fnct = __atomic_load_n(&p_task->FnctPtr, __ATOMIC_ACQUIRE);
+        if (p_fnct != DEF_NULL) {
+            p_fnct(p_task->ArgPtr);
+            p_task->RunCtr++;
+        }
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                         BSP_CPU_IntHandler()
+*
+* Description : IRQ dispatcher of a secondary core.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : BSP_CPU_Vectors (bsp_cpu_a.S), with IRQs masked.
+*
+* Note(s)     : (1) BSP_CPU_SGI_WAKE needs no handler: the ready bit was set before the SGI was sent, and
+*                   taking the interrupt is enough to leave WFI.
+*                   喚醒 SGI 不需處理函式：就緒位元已先設定，進入中斷即可離開 WFI。
+*********************************************************************************************************
+*/
+
+void  BSP_CPU_IntHandler (void)
+{
+    CPU_INT32U        int_ack;
+    CPU_INT32U        int_id;
+    BSP_INT_FNCT_PTR  p_isr;
+
+
+    int_ack = BSP_IntAck();
+    int_id  = int_ack & DEF_BIT_FIELD(10u, 0u);
+    if (int_id == 1023u) {                                      /* Spurious interrupt.                                  */
+        return;
+    }
+
+    if (int_id < ARM_GIC_INT_SRC_CNT) {
+        p_isr = BSP_CPU_Tbl[BSP_CPU_IdGet()].IntVectTbl[int_id];
+        if (p_isr != DEF_NULL) {
+            OS_TRACE_ISR_ENTER(int_id);
+            (*p_isr)(int_id);
+            OS_TRACE_ISR_EXIT(int_id);
+        }
+    }
+
+    BSP_IntEOI(int_ack);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       BSP_CPU_ExceptHandler()
+*
+* Description : Report a synchronous exception, FIQ or SError taken on a secondary core, then halt it.
+*
+* Argument(s) : esr         ESR_EL1 at the time of the exception.
+*
+*               elr         ELR_EL1 at the time of the exception.
+*
+* Return(s)   : none, never returns.
+*
+* Caller(s)   : BSP_CPU_Vectors (bsp_cpu_a.S).
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+void  BSP_CPU_ExceptHandler (CPU_INT64U  esr,
+                             CPU_INT64U  elr)
+{
+    uart_puts("[CPU] exception on core ");
+    uart_puthex(BSP_CPU_IdGet());
+    uart_puts(" esr=");
+    uart_puthex(esr);
+    uart_puts(" elr=");
+    uart_puthex(elr);
+    uart_puts("\n");
+
+    BSP_CPU_Tbl[BSP_CPU_IdGet()].State = BSP_CPU_STATE_OFF;
+    while (DEF_TRUE) {
+        CPU_WaitForEvent();
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*                                          BSP_CPU_TmrInit()
+*
+* Description : Start the calling core's virtual timer at BSP_CPU_TICK_RATE_HZ.
+*
+* Argument(s) : p_cpu       Per-core data of the calling core.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : BSP_CPU_SecondaryMain().
+*
+* Note(s)     : (1) CNTV_* and PPI 27 are banked, so this does not disturb CPU0's uC/OS-II tick.
+*                   CNTV_* 與 PPI 27 為每核獨立，不影響 CPU0 的 uC/OS-II 節拍。
+*********************************************************************************************************
+*/
+
+static  void  BSP_CPU_TmrInit (BSP_CPU_DATA  *p_cpu)
+{
+    CPU_INT32U  reload;
+
+
+    reload = raw_read_cntfrq_el0() / BSP_CPU_TICK_RATE_HZ;
+    if (reload == 0u) {
+        reload = 1u;
+    }
+
+    p_cpu->TmrReload = reload;
+    p_cpu->TmrLast   = raw_read_cntvct_el0();
+    p_cpu->IntVectTbl[BSP_CPU_TMR_INT_ID] = BSP_CPU_TmrTickHandler;
+
+    __asm__ __volatile__("msr cntv_cval_el0, %0" :: "r" (p_cpu->TmrLast + reload));
+    __asm__ __volatile__("msr cntv_ctl_el0, %0"  :: "r" ((CPU_INT64U)1u));   /* ENABLE, not masked.      */
+
+    BSP_IntSrcEn(BSP_CPU_TMR_INT_ID);
+}
+
+
+/*
+*********************************************************************************************************
+*                                       BSP_CPU_TmrTickHandler()
+*
+* Description : Tick of a secondary core: advance its tick counter and ready the periodic tasks that are
+*               due.
+*
+* Argument(s) : int_id      Interrupt ID (unused).
+*
+* Return(s)   : none.
+*
+* Caller(s)   : BSP_CPU_IntHandler().
+*
+* Note(s)     : (1) Deadlines are absolute on CNTVCT, as on CPU0, so a late IRQ catches up all the ticks
+*                   it missed instead of drifting.
+*
+*               (2) A task that missed several periods runs once and is rescheduled one period from now.
+*********************************************************************************************************
+*/
+
+static  void  BSP_CPU_TmrTickHandler (CPU_INT32U  int_id)
+{
+    BSP_CPU_DATA  *p_cpu;
+    BSP_CPU_TASK  *p_task;
+    CPU_INT64U     now;
+    CPU_INT32U     ticks;
+    CPU_INT32U     mask;
+    CPU_INT32U     rdy;
+    CPU_INT32U     prio;
+
+
+    (void)int_id;
+
+    p_cpu = &BSP_CPU_Tbl[BSP_CPU_IdGet()];
+    now   = raw_read_cntvct_el0();
+    ticks = (CPU_INT32U)((now - p_cpu->TmrLast) / p_cpu->TmrReload);
+    p_cpu->TmrLast += (CPU_INT64U)ticks * p_cpu->TmrReload;     /* See Note #1.                                         */
+    __asm__ __volatile__("msr cntv_cval_el0, %0" :: "r" (p_cpu->TmrLast + p_cpu->TmrReload));
+    if (ticks == 0u) {                                          /* Early or spurious: same deadline re-armed.           */
+        return;
+    }
+
+    p_cpu->TickCtr += ticks;
+
+    rdy  = 0u;
+    mask = p_cpu->PeriodMask;
+    while (mask != 0u) {
+        prio   = (CPU_INT32U)__builtin_ctz(mask);
+        mask  &= mask - 1u;
+        p_task = &p_cpu->TaskTbl[prio];
+        if ((CPU_INT32S)(p_cpu->TickCtr - p_task->NextTick) >= 0) {
+            rdy |= DEF_BIT(prio);
+            p_task->NextTick += p_task->Period;
+            if ((CPU_INT32S)(p_cpu->TickCtr - p_task->NextTick) >= 0) {
+                p_task->NextTick = p_cpu->TickCtr + p_task->Period;   /* See Note #2.                            */
+            }
+        }
+    }
+
+    if (rdy != 0u) {
+        (void)__atomic_fetch_or(&p_cpu->RdyMask, rdy, __ATOMIC_ACQ_REL);
+    }
+}
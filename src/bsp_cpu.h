@@ -0,0 +1,123 @@
+/*
+*********************************************************************************************************
+*
+*                                    MICRIUM BOARD SUPPORT PACKAGE
+*
+*                          (c) Copyright 2003-2015; Micrium, Inc.; Weston, FL
+*
+*               All rights reserved.  Protected by international copyright laws.
+*
+*               This BSP is provided in source form to registered licensees ONLY.  It is
+*               illegal to distribute this source code to any third party unless you receive
+*               written permission by an authorized Micrium representative.  Knowledge of
+*               the source code may NOT be used to develop a similar product.
+*
+*               Please help us continue to provide the Embedded community with the finest
+*               software available.  Your honesty is greatly appreciated.
+*
+*               You can contact us at www.micrium.com.
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                    MICRIUM BOARD SUPPORT PACKAGE
+*                                  SECONDARY CORE BRING-UP & SCHEDULER
+*
+* Filename      : bsp_cpu.h
+* Version       : V1.00
+*********************************************************************************************************
+* Note(s)       : (1) uC/OS-II keeps all of its kernel state in globals and is not re-entrant across
+*                     cores, so it stays on CPU0.  CPU1..BSP_CPU_MAX-1 are started through PSCI and each
+*                     runs its own small partitioned scheduler : a private ready bitmap, a fixed table
+*                     of run-to-completion tasks pinned to that core, its own virtual timer tick and
+*                     its own GIC CPU interface.  Other cores make a task ready with BSP_CPU_TaskRdy(),
+*                     which sets the ready bit and rings the target core with an SGI.
+*                     uC/OS-II 的核心狀態為全域變數且不可跨核重入，因此保留在 CPU0；其餘核心經 PSCI 啟動後
+*                     各自執行分區排程器（私有就緒位元圖、固定綁定的任務表、獨立節拍與 GIC 介面），
+*                     跨核喚醒以 SGI 通知。
+*********************************************************************************************************
+*/
+
+#ifndef  BSP_CPU_PRESENT
+#define  BSP_CPU_PRESENT
+
+#include  <cpu.h>
+#include  <bsp_int.h>
+
+
+/*
+*********************************************************************************************************
+*                                               DEFINES
+*********************************************************************************************************
+*/
+
+#define  BSP_CPU_MAX                    4u                      /* Cores handled, including CPU0 / 支援核心數（含 CPU0） */
+#define  BSP_CPU_STK_SIZE            8192u                      /* Per-core stack, bytes / 每核堆疊大小（位元組）         */
+#define  BSP_CPU_TASK_PRIO_MAX         32u                      /* Tasks per core, prio 0 is highest / 每核任務數         */
+
+#define  BSP_CPU_SGI_WAKE               1u                      /* SGI used for cross-core wakeups / 跨核喚醒用 SGI        */
+#define  BSP_CPU_TICK_RATE_HZ         100u                      /* Secondary tick rate / 次要核心節拍頻率                 */
+
+#define  BSP_CPU_STATE_OFF              0u
+#define  BSP_CPU_STATE_STARTING         1u
+#define  BSP_CPU_STATE_RUNNING          2u
+
+                                                                /* ------------------ PSCI (DEN0022) ------------------ */
+#define  BSP_CPU_PSCI_CPU_ON       0xC4000003u                  /* CPU_ON, SMC64/HVC64 calling convention.              */
+#define  BSP_CPU_PSCI_SUCCESS           0
+#define  BSP_CPU_PSCI_ALREADY_ON       -4
+
+#ifndef  BSP_CPU_PSCI_CONDUIT_SMC                               /* QEMU virt without EL2/EL3 answers PSCI on HVC.       */
+#define  BSP_CPU_PSCI_CONDUIT_SMC       0u
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef  void  (*BSP_CPU_TASK_FNCT)(void *p_arg);
+
+
+/*
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+CPU_INT32U   BSP_CPU_IdGet      (void);
+
+CPU_BOOLEAN  BSP_CPU_Start      (CPU_INT32U         cpu);
+
+CPU_INT32U   BSP_CPU_StartAll   (void);
+
+CPU_BOOLEAN  BSP_CPU_StartImage (CPU_INT32U         cpu,
+                                 CPU_INT64U         entry);
+
+CPU_BOOLEAN  BSP_CPU_TaskCreate (CPU_INT32U         cpu,
+                                 CPU_INT32U         prio,
+                                 BSP_CPU_TASK_FNCT  p_fnct,
+                                 void              *p_arg,
+                                 CPU_INT32U         period);
+
+CPU_BOOLEAN  BSP_CPU_TaskRdy    (CPU_INT32U         cpu,
+                                 CPU_INT32U         prio);
+
+CPU_BOOLEAN  BSP_CPU_IntVectSet (CPU_INT32U         int_id,
+                                 BSP_INT_FNCT_PTR   int_fnct);
+
+CPU_INT32U   BSP_CPU_IntOwnerGet(CPU_INT32U         int_id);
+
+void         BSP_CPU_SecondaryMain(CPU_INT32U       cpu);       /* Called from BSP_CPU_SecondaryEntry (bsp_cpu_a.S).    */
+
+void         BSP_CPU_IntHandler (void);                         /* Secondary IRQ dispatcher / 次要核心 IRQ 分派入口      */
+
+void         BSP_CPU_ExceptHandler(CPU_INT64U       esr,
+                                   CPU_INT64U       elr);
+
+
+#endif /* BSP_CPU_PRESENT */
@@ -37,9 +37,12 @@
 
 #include  <cpu.h>
 #include  <lib_def.h>
+#include  <stdio.h>
 
 #include  "bsp.h"
 #include  "bsp_int.h"
+#include  "bsp_os.h"
+#include  "bsp_cpu.h"
 
 //Ruby mark
 //#include  "../include/imx_defs.h"
@@ -59,10 +62,14 @@
 #define  BSP_GIC_DIST_BASE_ADDR       (0x08000000u)
 #define  BSP_GIC_CPU_IF_BASE_ADDR     (0x08010000u)
 #define  BSP_GIC_RDIST_SGI_BASE_ADDR  (0x080b0000u)
+#define  BSP_GIC_RDIST_STRIDE         (0x00020000u)             /* RD_base + SGI_base frames per core.                  */
 #define  BSP_INT_GIC_DIST_REG         ((ARM_REG_GIC_DIST_PTR)(BSP_GIC_DIST_BASE_ADDR))
 #define  BSP_INT_GIC_IF_REG           ((ARM_REG_GIC_IF_PTR)(BSP_GIC_CPU_IF_BASE_ADDR))
-#define  BSP_INT_GIC_RDIST_SGI_BASE   ((ARM_REG_GIC_DIST_PTR)(BSP_GIC_RDIST_SGI_BASE_ADDR))
+#define  BSP_INT_GIC_RDIST_SGI_BASE   ((ARM_REG_GIC_DIST_PTR)(BSP_GIC_RDIST_SGI_BASE_ADDR + BSP_CPU_IdGet() * BSP_GIC_RDIST_STRIDE))
 #endif
+
+#define  BSP_INT_IRQ_EN()             __asm__ __volatile__("msr daifclr, #2" ::: "memory")
+#define  BSP_INT_IRQ_DIS()            __asm__ __volatile__("msr daifset, #2" ::: "memory")
 
 /*
 *********************************************************************************************************
@@ -70,22 +77,42 @@
 *********************************************************************************************************
 */
 
+extern void gic_write_sgi1r(unsigned long long val);
+extern void gic_v3_cpu_init_secondary(unsigned int cpu);
+extern void gic_v3_irq_route(unsigned int irq, unsigned int cpu);
+
 static  BSP_INT_FNCT_PTR BSP_IntVectTbl[ARM_GIC_INT_SRC_CNT];   /* Interrupt vector table.                              */
+static  CPU_INT08U        BSP_IntAffinityTbl[ARM_GIC_INT_SRC_CNT]; /* Core each SPI is routed to, 0 after reset.        */
+
+#if   (BSP_CFG_GIC_VARIANT == 2u) || (BSP_CFG_GIC_VARIANT == 3u)
+#define  BSP_GIC_Variant              BSP_CFG_GIC_VARIANT       /* Constant: every variant test folds at build time.    */
+#elif (BSP_CFG_GIC_VARIANT == 0u)
 static  CPU_INT08U        BSP_GIC_Variant = 2u;                 /* Detected GIC variant (2 or 3).                       */
+#else
+#error  "BSP_CFG_GIC_VARIANT must be 0 (detect), 2 or 3"
+#endif
 
 static void BSP_IntDetectVariant(void)
 {
     CPU_INT32U typer = *((volatile CPU_REG32 *)(BSP_GIC_DIST_BASE_ADDR + 0x004u));
+    CPU_INT08U variant;
 
-    if (typer & (1u << 19)) {
-        BSP_GIC_Variant = 3u;
+    variant = (typer & (1u << 19)) ? 3u : 2u;
+    if (variant == 3u) {
         uart_puts("Detected GICv3\n");
     } else {
-        BSP_GIC_Variant = 2u;
         uart_puts("Detected GICv2\n");
     }
+
+#if (BSP_CFG_GIC_VARIANT == 0u)
+    BSP_GIC_Variant = variant;
+#else
+    if (variant != BSP_CFG_GIC_VARIANT) {                       /* Wrong image for this machine: IRQs will not work.    */
+        uart_puts("BSP_CFG_GIC_VARIANT does not match the GIC, rebuild with the right GIC_VERSION\n");
+    }
+#endif
 }
-
+
 static CPU_INT32U intc_icdicfrn_table[] =
 {
     0xa0a0a0a0,            /* ICDICFR0  :  15 to   0 */
@@ -177,6 +204,50 @@ typedef  struct  arm_reg_gic_if {
 #define  ARM_BIT_GIC_IF_ICCICR_FIQEN           DEF_BIT_03       /* Enable FIQ.                                          */
 
 
+/*
+*********************************************************************************************************
+*                                     IRQ ACKNOWLEDGE / EOI FAST PATH
+*
+* Note(s) : (1) GICv3 CPU interface registers are system registers: inline MRS/MSR, no MMIO and no call
+*               into gic_v3.c.  With BSP_CFG_GIC_VARIANT set, the variant test below is a constant and
+*               only one side is compiled in.
+*               GICv3 CPU 介面為系統暫存器，直接內嵌 MRS/MSR；設定 BSP_CFG_GIC_VARIANT 後於編譯期選定變體。
+*
+*           (2) With BSP_CFG_GIC_EOI_SPLIT (ICC_CTLR_EL1.EOImode = 1) the EOIR write only drops the running
+*               priority and ICC_DIR_EL1 deactivates the interrupt.  One ISB covers both writes.
+*********************************************************************************************************
+*/
+
+static  __inline  CPU_INT32U  BSP_IntAckRd (void)
+{
+    CPU_INT64U  iar;
+
+
+    if (BSP_GIC_Variant == 2u) {
+        return (BSP_INT_GIC_IF_REG->ICCIAR);
+    }
+    __asm__ __volatile__("mrs %0, S3_0_C12_C12_0" : "=r" (iar) :: "memory");   /* ICC_IAR1_EL1 */
+    return ((CPU_INT32U)iar);
+}
+
+static  __inline  void  BSP_IntEOIWr (CPU_INT32U  int_ack)
+{
+    CPU_INT64U  int_id;
+
+
+    if (BSP_GIC_Variant == 2u) {
+        BSP_INT_GIC_IF_REG->ICCEOIR = int_ack;                  /* Keep the source CPUID: SGIs from other cores.        */
+        return;
+    }
+    int_id = int_ack;
+    __asm__ __volatile__("msr S3_0_C12_C12_1, %0" :: "r" (int_id) : "memory");  /* ICC_EOIR1_EL1 */
+#if (BSP_CFG_GIC_EOI_SPLIT == DEF_ENABLED)
+    __asm__ __volatile__("msr S3_0_C12_C11_1, %0" :: "r" (int_id) : "memory");  /* ICC_DIR_EL1   */
+#endif
+    __asm__ __volatile__("isb" ::: "memory");
+}
+
+
 /*
 *********************************************************************************************************
 *********************************************************************************************************
@@ -196,7 +267,9 @@ typedef  struct  arm_reg_gic_if {
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) In an AMP image other than core 0's (BSP_INT_DIST_OWNER == DEF_NO) the shared
+*                   distributor is left alone; only this core's CPU interface is set up.
+*                   AMP 模式下非 core 0 映像不重設共用分配器，僅設定本核心 CPU 介面。
 *
 *********************************************************************************************************
 */
@@ -210,6 +283,7 @@ void BSP_Int_Init (void)
     BSP_IntDetectVariant();
 
     if (BSP_GIC_Variant == 2u) {
+#if (BSP_INT_DIST_OWNER == DEF_YES)                             /* See Note #1.                                         */
 #if (BSP_CFG_FIQ_EN == DEF_ENABLED)
         for(i = 0; i < 32; i++) {
             BSP_INT_GIC_DIST_REG->ICDISRn[i] = 0xFFFFFFFFu;
@@ -217,13 +291,16 @@ void BSP_Int_Init (void)
 #endif
 
         BSP_INT_GIC_DIST_REG->ICDDCR |= 3u;
+#endif
                                                                 /* Enable the GIC interface.                            */
         BSP_INT_GIC_IF_REG->ICCICR |= (ARM_BIT_GIC_IF_ICCICR_ENS | ARM_BIT_GIC_IF_ICCICR_ENNS);
+        BSP_INT_GIC_IF_REG->ICCBPR  = 0u;                       /* Lowest binary point: nest on every priority bit.     */
 
 #if (BSP_CFG_FIQ_EN == DEF_ENABLED)
         BSP_INT_GIC_IF_REG->ICCICR |= ARM_BIT_GIC_IF_ICCICR_FIQEN | ARM_BIT_GIC_IF_ICCICR_ACKCTL;
 #endif
 
+#if (BSP_INT_DIST_OWNER == DEF_YES)
 	    int offset;
 
 	    for (offset = 0; offset < 32; offset++)
@@ -233,6 +310,7 @@ void BSP_Int_Init (void)
 //		BSP_INT_GIC_DIST_REG->ICDISERn[offset]=0xffffffff;
 //		BSP_INT_GIC_DIST_REG->ICDICPRn[offset]=0xFfffffff;
 	    }
+#endif
     } else {
 	    int offset;
 
@@ -251,6 +329,38 @@ void BSP_Int_Init (void)
     BSP_IntPrioMaskSet(0xFFu);
 }
 
+
+/*
+*********************************************************************************************************
+*                                           BSP_IntInitCPU()
+*
+* Description : Initialise the banked GIC state of the calling secondary core.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : BSP_CPU_SecondaryMain().
+*
+* Note(s)     : (1) The distributor is shared and was set up by BSP_Int_Init() on CPU0.  Only the CPU
+*                   interface (GICv2) or the core's own redistributor and ICC_* registers (GICv3) are
+*                   touched here.
+*                   分配器為共用，已由 CPU0 初始化；此處僅設定本核心的 CPU 介面或重分配器。
+*********************************************************************************************************
+*/
+
+void  BSP_IntInitCPU (void)
+{
+    if (BSP_GIC_Variant == 2u) {
+        BSP_INT_GIC_DIST_REG->ICDISERn[0] = DEF_BIT_FIELD(16u, 0u);    /* Banked: SGIs 0..15 for this core.                    */
+        BSP_INT_GIC_IF_REG->ICCICR |= (ARM_BIT_GIC_IF_ICCICR_ENS | ARM_BIT_GIC_IF_ICCICR_ENNS);
+        BSP_INT_GIC_IF_REG->ICCBPR  = 0u;                       /* Lowest binary point: nest on every priority bit.     */
+        BSP_IntPrioMaskSet(0xFFu);
+    } else {
+        gic_v3_cpu_init_secondary(BSP_CPU_IdGet());
+    }
+}
+
 /*
 *********************************************************************************************************
 *                                            BSP_IntSrcEn()
@@ -374,22 +484,24 @@ void  BSP_IntPrioMaskSet (CPU_INT32U prio)
 *
 * Argument(s) : int_id  Interrupt id.
 *
-*               prio    Interrupt priority.
+*               prio    Interrupt priority, 0 is the highest (see BSP_INT_PRIO_xxx).
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The GIC only implements the upper bits of each priority field (at least 4), so
+*                   priorities that must preempt each other differ in bits [7:4].
+*                   GIC 僅實作優先權欄位的高位元（至少 4 位），需互相搶佔的優先權應於 [7:4] 不同。
 *
+*               (2) On GICv3 the priorities of SGIs and PPIs are banked in the calling core's
+*                   redistributor.
 *********************************************************************************************************
 */
 
 void  BSP_IntPrioSet (CPU_INT32U  int_id,
                       CPU_INT32U  prio)
 {
-    CPU_INT32U  reg_off;
-    CPU_INT32U  reg_byte;
-    CPU_INT32U  temp_reg;
-    CPU_SR_ALLOC();
+    ARM_REG_GIC_DIST_PTR  p_dist;
+
 
     if(int_id >= ARM_GIC_INT_SRC_CNT) {
         return;
@@ -399,18 +511,12 @@ void  BSP_IntPrioSet (CPU_INT32U  int_id,
         return;
     }
 
-    CPU_CRITICAL_ENTER();
-
-    reg_off = int_id >> 2u;
-    reg_byte = int_id & 0x03;
-
-    temp_reg = BSP_INT_GIC_DIST_REG->ICDIPRn[reg_off];
-    temp_reg = temp_reg & ~(0xFF << (reg_byte * 8u));
-    temp_reg = temp_reg | ((prio & 0x1Fu) << (reg_byte * 8u));
-
-    BSP_INT_GIC_DIST_REG->ICDIPRn[reg_off] = temp_reg;
-
-    CPU_CRITICAL_EXIT();
+    p_dist = BSP_INT_GIC_DIST_REG;
+    if ((BSP_GIC_Variant != 2u) && (int_id < 32u)) {            /* See Note #2.                                         */
+        p_dist = BSP_INT_GIC_RDIST_SGI_BASE;
+    }
+                                                                /* Byte accessible: no read-modify-write needed.        */
+    ((volatile CPU_INT08U *)&p_dist->ICDIPRn[0])[int_id] = (CPU_INT08U)prio;
 }
 
 
@@ -422,11 +528,17 @@ void  BSP_IntPrioSet (CPU_INT32U  int_id,
 *
 * Argument(s) : int_id              Interrupt id.
 *
-*               int_target_list     Interrupt CPU target list.
+*               int_target_list     Interrupt CPU target list, bit n = CPUn.
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Note(s)     : (1) GICD_ITARGETSR is byte accessible, so each target is written on its own rather than
+*                   read-modified-written: cores may retarget different interrupts concurrently.
+*                   GICD_ITARGETSR 可按位元組寫入，避免多核同時修改時的讀-改-寫競爭。
+*
+*               (2) GICv3 routes an SPI to a single core through GICD_IROUTER; the lowest core in the
+*                   list is used.  SGI/PPI targets are fixed on both variants.
+*                   GICv3 以 GICD_IROUTER 將 SPI 導向單一核心，取清單中編號最小者。
 *
 *********************************************************************************************************
 */
@@ -434,28 +546,131 @@ void  BSP_IntPrioSet (CPU_INT32U  int_id,
 void  BSP_IntTargetSet (CPU_INT32U  int_id,
                         CPU_INT08U  int_target_list)
 {
-    CPU_INT32U  reg_off;
-    CPU_INT32U  reg_byte;
-    CPU_INT32U  temp_reg;
-    CPU_SR_ALLOC();
+    if ((int_id >= ARM_GIC_INT_SRC_CNT) ||
+        (int_target_list == 0u)) {
+        return;
+    }
 
+    if (BSP_GIC_Variant == 2u) {                                /* See Note #1.                                         */
+        ((volatile CPU_INT08U *)&BSP_INT_GIC_DIST_REG->ICDIPTRn[0])[int_id] = int_target_list;
+    } else if (int_id >= 32u) {                                 /* See Note #2.                                         */
+        gic_v3_irq_route(int_id, (CPU_INT32U)__builtin_ctz(int_target_list));
+    }
 
-    if(int_id >= ARM_GIC_INT_SRC_CNT) {
-        return;
+    BSP_IntAffinityTbl[int_id] = (CPU_INT08U)__builtin_ctz(int_target_list);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         BSP_IntAffinitySet()
+*
+* Description : Route a shared peripheral interrupt to one core.
+*
+* Argument(s) : int_id      SPI to route (32..ARM_GIC_INT_SRC_CNT-1).
+*
+*               cpu         Target core, 0..BSP_CPU_MAX-1.
+*
+* Return(s)   : DEF_OK      if the interrupt was routed,
+*               DEF_FAIL    otherwise.
+*
+* Caller(s)   : Application, drivers, BSP_CPU_IntVectSet().
+*
+* Note(s)     : (1) The handler must already be in the target core's vector table: BSP_IntVectSet() for
+*                   CPU0 (uC/OS-II), BSP_CPU_IntVectSet() on the secondary itself.  Keeping a device's
+*                   interrupt on the core that runs its RX task keeps the descriptors and buffers in
+*                   that core's cache.
+*                   目標核心須已註冊處理函式；中斷與 RX 任務同核可避免跨核快取搬移。
+*
+*               (2) An instance already active on the old core completes there; only later ones move.
+*********************************************************************************************************
+*/
+
+CPU_BOOLEAN  BSP_IntAffinitySet (CPU_INT32U  int_id,
+                                 CPU_INT32U  cpu)
+{
+    if ((int_id < 32u) ||
+        (int_id >= ARM_GIC_INT_SRC_CNT) ||
+        (cpu >= BSP_CPU_MAX)) {
+        return (DEF_FAIL);
     }
 
-    CPU_CRITICAL_ENTER();
+    BSP_IntTargetSet(int_id, (CPU_INT08U)DEF_BIT(cpu));
+
+    return (DEF_OK);
+}
 
-    reg_off = int_id >> 2u;
-    reg_byte = int_id & 0x03;
 
-    temp_reg = BSP_INT_GIC_DIST_REG->ICDIPTRn[reg_off];
-    temp_reg = temp_reg & ~(0xFF << (reg_byte * 8u));
-    temp_reg = temp_reg | ((int_target_list & 0x1Fu) << (reg_byte * 8u));
+/*
+*********************************************************************************************************
+*                                         BSP_IntAffinityGet()
+*
+* Description : Return the core an interrupt is routed to.
+*
+* Argument(s) : int_id      Interrupt id.
+*
+* Return(s)   : Core index; 0 for SGIs, PPIs and out-of-range ids.
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
 
-    BSP_INT_GIC_DIST_REG->ICDIPTRn[reg_off] = temp_reg;
+CPU_INT32U  BSP_IntAffinityGet (CPU_INT32U  int_id)
+{
+    if (int_id >= ARM_GIC_INT_SRC_CNT) {
+        return (0u);
+    }
 
-    CPU_CRITICAL_EXIT();
+    return (BSP_IntAffinityTbl[int_id]);
+}
+
+
+/*
+*********************************************************************************************************
+*                                      BSP_IntAffinityRebalance()
+*
+* Description : Route every SPI that has a handler to the core owning that handler.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Number of interrupts moved.
+*
+* Caller(s)   : Application, e.g. after secondaries are started or handlers were registered.
+*
+* Note(s)     : (1) CPU0's table wins if several cores registered the same SPI.  A secondary only owns an
+*                   SPI while it is running, so interrupts fall back to CPU0 if a core never came up.
+*                   若多核皆註冊同一 SPI 則以 CPU0 為準；次要核心未執行時中斷回歸 CPU0。
+*********************************************************************************************************
+*/
+
+CPU_INT32U  BSP_IntAffinityRebalance (void)
+{
+    CPU_INT32U  int_id;
+    CPU_INT32U  cpu;
+    CPU_INT32U  moved;
+
+
+    moved = 0u;
+    for (int_id = 32u; int_id < ARM_GIC_INT_SRC_CNT; int_id++) {
+        if (BSP_IntVectTbl[int_id] != DEF_NULL) {               /* See Note #1.                                         */
+            cpu = 0u;
+        } else {
+            cpu = BSP_CPU_IntOwnerGet(int_id);
+            if (cpu == BSP_CPU_MAX) {                           /* No handler anywhere: leave it alone.                 */
+                continue;
+            }
+        }
+
+        if (BSP_IntAffinityTbl[int_id] != cpu) {
+            BSP_IntAffinitySet(int_id, cpu);
+            printf("[INT] IRQ %u -> CPU%u\n", (unsigned)int_id, (unsigned)cpu);
+            moved++;
+        }
+    }
+
+    return (moved);
 }
 
 
@@ -467,7 +682,7 @@ void  BSP_IntTargetSet (CPU_INT32U  int_id,
 *
 * Argument(s) : int_id              Interrupt ID.
 *
-*               int_prio            Interrupt priority.
+*               int_prio            Interrupt priority, BSP_INT_PRIO_xxx (lower values preempt higher).
 *
 *               int_target_list     Interrupt CPU target list
 *
@@ -506,13 +721,16 @@ CPU_BOOLEAN  BSP_IntVectSet (CPU_INT32U       int_id,
 
     CPU_CRITICAL_ENTER();                                       /* Prevent partially configured interrupts.             */
 
+    BSP_IntPrioSet(int_id,
+                   int_prio);
+
     if (BSP_GIC_Variant == 2u) {
         if (int_target_list == 0u) {
             int_target_list = 1u;
         }
-        BSP_IntPrioSet(int_id,
-                       int_prio);
-
+        BSP_IntTargetSet(int_id,
+                          int_target_list);
+    } else if (int_target_list != 0u) {
         BSP_IntTargetSet(int_id,
                           int_target_list);
     }
@@ -531,67 +749,80 @@ CPU_INT08U BSP_Int_GICVariantGet(void)
 }
 
 
-/*
-*********************************************************************************************************
-*                                           BSP_IntHandler()
+/*
+*********************************************************************************************************
+*                                           BSP_IntHandler()
 *
-* Description : Generic interrupt handler.
+* Description : Generic interrupt handler.  Dispatches up to BSP_INT_ACK_MAX pending interrupts per
+*               exception entry; each ISR runs with IRQs unmasked, so higher priority interrupts may
+*               preempt it.
 *
-* Argument(s) : Interrupt type.
+* Argument(s) : none.
 *
 * Return(s)   : none.
 *
-* Note(s)     : none.
+* Caller(s)   : common_irq_trap_handler(), from OS_CPU_ARM_ExceptIrqHndlr.
+*
+* Note(s)     : (1) Acknowledging raises the running priority of the CPU interface to the priority of
+*                   int_id.  Once IRQs are unmasked only a source with a higher group priority (lower
+*                   value, see BSP_INT_PRIO_xxx) is signalled; same or lower priority sources stay pending
+*                   until the EOI drops the running priority again.
+*                   確認中斷後 CPU 介面的執行優先權提升至該中斷優先權；解除遮罩後僅較高優先權可巢狀搶佔，
+*                   同級或較低者於 EOI 後才送達。
+*
+*               (2) IRQs are masked again before the EOI.  Otherwise a pending source of the same priority
+*                   would nest on this frame as soon as the running priority drops.
 *
+*               (3) OS_CPU_ARM_ExceptIrqHndlr has already saved ELR_EL1/SPSR_EL1 and counted this level in
+*                   OSIntNesting; tasks readied by a nested ISR are scheduled when the outermost level exits.
+*
+*               (4) After an EOI the next acknowledge returns whatever is still pending above the running
+*                   priority of the preempted level, saving an exception return and entry per interrupt.
+*                   The loop is bounded so that OSIntExit() still reschedules promptly.
+*                   EOI 後直接再次確認仍待處理的中斷，省去例外返回與重新進入；迴圈有上限以免延誤排程。
 *********************************************************************************************************
 */
 
-extern unsigned long long gic_read_iar(void);
-extern gic_write_eoir(unsigned int irq);
-
 void  BSP_IntHandler (void)
 {
     CPU_INT32U        int_ack;
     CPU_INT32U        int_id;
-    CPU_INT32U        int_cpu;
+    CPU_INT32U        nbr;
     BSP_INT_FNCT_PTR  p_isr;
 
-    CPU_SR_ALLOC();
-
-    CPU_CRITICAL_ENTER();                                       /* Prevent partially configured interrupts.             */
-
-    if (BSP_GIC_Variant == 2u) {
-        int_ack = BSP_INT_GIC_IF_REG->ICCIAR;                       /* Acknowledge the interrupt.                           */
-        int_id = int_ack & DEF_BIT_FIELD(10u, 0u);                  /* Mask away the CPUID.                                 */
-        int_cpu = (int_ack & DEF_BIT_FIELD(12u, 2u)) >> 10u;        /* Extract the interrupt source.                        */
-    } else {
-        int_ack = 0u;
-        int_id = (CPU_INT32U)gic_read_iar();
-        int_cpu = 0u;
-    }
-
-    if(int_id == 1023u) {                                       /* Spurious interrupt.                                  */
-        return;
-    }
-
-    p_isr = BSP_IntVectTbl[int_id];                             /* Fetch ISR handler.                                   */
-    /* Dispatch registered ISR (timer tick, peripherals, etc.) / 呼叫已註冊的 ISR（包含系統節拍與周邊） */
-
-//	if(int_id!=27)  //For debug pci interrupt
-//	printf("[%s:%d]----------------------------------------------> int_id=%d\n",__func__,__LINE__,int_id);
 
-    if(p_isr != DEF_NULL) {
-        (*p_isr)(int_id);                                      /* Call ISR handler.                                    */
+#if OS_TICKLESS_EN > 0u
+    BSP_OS_TickResume();                                        /* Catch up OSTime if the tick was suppressed.          */
+#endif
+
+    for (nbr = 0u; nbr < BSP_INT_ACK_MAX; nbr++) {              /* See Note #4.                                         */
+        int_ack = BSP_IntAckRd();                               /* Acknowledge the interrupt.                           */
+        if (BSP_GIC_Variant == 2u) {
+            int_id = int_ack & DEF_BIT_FIELD(10u, 0u);          /* Mask away the CPUID.                                 */
+        } else {
+            int_id = int_ack;
+        }
+
+        if (int_id >= 1020u) {                                  /* Spurious: nothing (left) to handle.                  */
+            break;
+        }
+
+        p_isr = DEF_NULL;
+        if (int_id < ARM_GIC_INT_SRC_CNT) {
+            p_isr = BSP_IntVectTbl[int_id];                     /* Fetch ISR handler.                                   */
+        }
+
+        if (p_isr != DEF_NULL) {
+            OS_TRACE_ISR_ENTER(int_id);
+            BSP_INT_IRQ_EN();                                   /* See Note #1.                                         */
+            (*p_isr)(int_id);                                   /* Call ISR handler.                                    */
+            BSP_INT_IRQ_DIS();                                  /* See Note #2.                                         */
+            OS_TRACE_ISR_EXIT(int_id);
+        }
+
+        CPU_MB();                                               /* Memory barrier before ending the interrupt.          */
+        BSP_IntEOIWr(int_ack);
     }
-
-    CPU_MB();                                                   /* Memory barrier before ending the interrupt.          */
-
-    if (BSP_GIC_Variant == 2u) {
-        BSP_INT_GIC_IF_REG->ICCEOIR = int_id;
-    } else {
-        gic_write_eoir(int_id);
-    }
-    CPU_CRITICAL_EXIT();
 }
 
 
@@ -612,9 +843,51 @@ void  BSP_IntHandler (void)
 
 void  BSP_SGITrig  (CPU_INT32U  int_sgi)
 {
-    CPU_MB();
-    BSP_INT_GIC_DIST_REG->ICDSGIR = DEF_BIT_16 | int_sgi;
-    CPU_MB();
+    CPU_INT32U  target_list;
+
+
+    target_list = (int_sgi >> 16u) & DEF_INT_08_MASK;
+    if (target_list == 0u) {                                    /* No target given: CPU0, as before.                    */
+        target_list = DEF_BIT_00;
+    }
+
+    __asm__ __volatile__("dsb ish" ::: "memory");               /* Publish prior stores before the doorbell.            */
+    if (BSP_GIC_Variant == 2u) {
+        BSP_INT_GIC_DIST_REG->ICDSGIR = (target_list << 16u) | (int_sgi & 0x0Fu);
+    } else {
+        gic_write_sgi1r(((CPU_INT64U)(int_sgi & 0x0Fu) << 24u) | target_list);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                       BSP_IntAck() / BSP_IntEOI()
+*
+* Description : Acknowledge the highest priority pending interrupt of the calling core, and signal its
+*               completion.
+*
+* Argument(s) : int_ack     Value returned by BSP_IntAck() (BSP_IntEOI() only).
+*
+* Return(s)   : BSP_IntAck() returns the raw acknowledge value; bits 9..0 hold the interrupt ID, 1023
+*               means spurious.
+*
+* Caller(s)   : BSP_CPU_IntHandler().
+*
+* Note(s)     : (1) On GICv2 the EOI of an SGI must carry the source CPU bits of the acknowledge value.
+*                   GICv2 的 SGI 結束中斷須帶回確認值中的來源 CPU 位元。
+*********************************************************************************************************
+*/
+
+CPU_INT32U  BSP_IntAck (void)
+{
+    return (BSP_IntAckRd());
+}
+
+void  BSP_IntEOI (CPU_INT32U  int_ack)
+{
+    __asm__ __volatile__("dsb sy" ::: "memory");
+    BSP_IntEOIWr(int_ack);
 }
 
 
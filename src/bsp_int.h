@@ -45,6 +45,28 @@
 
 typedef  void  (*BSP_INT_FNCT_PTR)(CPU_INT32U);
 
+#if defined(AMP_CORE_ID) && (AMP_CORE_ID != 0)                 /* AMP: the distributor belongs to the core 0 image.    */
+#define  BSP_INT_DIST_OWNER     DEF_NO
+#else
+#define  BSP_INT_DIST_OWNER     DEF_YES
+#endif
+
+#define  BSP_SGI_TARGET(cpu)    (DEF_BIT_16 << (cpu))           /* OR into BSP_SGITrig()'s argument / 指定 SGI 目標核心 */
+
+#ifndef  BSP_CFG_GIC_VARIANT                                    /* 0: detect at boot, 2/3: build for that GIC only.     */
+#define  BSP_CFG_GIC_VARIANT    0u                              /* Set from GIC_VERSION by the Makefile / 由 Makefile 設定 */
+#endif
+
+#ifndef  BSP_CFG_GIC_EOI_SPLIT                                  /* GICv3 EOImode 1: EOIR drops priority, DIR deactivates */
+#define  BSP_CFG_GIC_EOI_SPLIT  DEF_ENABLED
+#endif
+
+#define  BSP_INT_ACK_MAX        4u                              /* IRQs acknowledged per exception / 每次例外確認上限    */
+
+                                                                /* GIC priorities, lower value preempts higher.         */
+#define  BSP_INT_PRIO_TICK      0x40u                           /* OS tick nests into any peripheral ISR / 系統節拍     */
+#define  BSP_INT_PRIO_DFLT      0xA0u                           /* Peripherals and doorbells / 周邊與門鈴中斷           */
+
 
 /*
 *********************************************************************************************************
@@ -54,6 +76,8 @@ typedef  void  (*BSP_INT_FNCT_PTR)(CPU_INT32U);
 
 void        BSP_Int_Init        (void);
 
+void        BSP_IntInitCPU      (void);                         /* Secondary core GIC init / 次要核心 GIC 初始化 */
+
 void        BSP_IntSrcEn        (CPU_INT32U        int_id);
 
 void        BSP_IntSrcDis       (CPU_INT32U        int_id);
@@ -63,6 +87,13 @@ void        BSP_IntPrioMaskSet  (CPU_INT32U        prio);
 void        BSP_IntTargetSet    (CPU_INT32U        int_id,
                                  CPU_INT08U        int_target_list);
 
+CPU_BOOLEAN BSP_IntAffinitySet  (CPU_INT32U        int_id,
+                                 CPU_INT32U        cpu);
+
+CPU_INT32U  BSP_IntAffinityGet  (CPU_INT32U        int_id);
+
+CPU_INT32U  BSP_IntAffinityRebalance(void);                     /* SPIs follow their handler's core / SPI 跟隨處理核心 */
+
 CPU_INT08U  BSP_Int_GICVariantGet(void);
 
 CPU_BOOLEAN BSP_IntVectSet      (CPU_INT32U        int_id,
@@ -72,7 +103,11 @@ CPU_BOOLEAN BSP_IntVectSet      (CPU_INT32U        int_id,
 
 void        BSP_IntHandler      (void);                         /* Shared IRQ dispatcher / 共用 IRQ 分派入口 */
 
-void        BSP_SGITrig         (CPU_INT32U        int_sgi);
+void        BSP_SGITrig         (CPU_INT32U        int_sgi);    /* SGI ID | BSP_SGI_TARGET() bits, CPU0 if none */
+
+CPU_INT32U  BSP_IntAck          (void);
+
+void        BSP_IntEOI          (CPU_INT32U        int_ack);
 
 
 #endif /* BSP_INT_PRESENT */
@@ -40,6 +40,7 @@
 
 #include  <lib_def.h>
 #include  <cpu.h>
+#include  <cpu_core.h>
 
 #include  <os_cpu.h>
 
@@ -267,20 +268,92 @@ unsigned int arch_timer_reg_read_cp15(int access, enum arch_timer_reg reg)
 }
 
 
-static CPU_INT32U BSP_OS_TmrReload;
+static CPU_INT32U   BSP_OS_TmrReload;          /* Counter cycles per tick / 每個節拍的計數週期 */
+static CPU_INT64U   BSP_OS_TickLast;           /* Deadline of the last announced tick / 上次宣告節拍的截止時間 */
+static CPU_INT32U   BSP_OS_TickLost;           /* Ticks caught up after a late IRQ / 延遲中斷後補回的節拍數 */
+static CPU_INT64U   BSP_OS_NsMult;             /* Nanoseconds per count, 32.32 fixed point / 每計數的奈秒數 (32.32 定點) */
+static CPU_INT32U   BSP_OS_TickLatLast;        /* Deadline to tick ISR, counts / 截止至節拍 ISR 的延遲（計數） */
+static CPU_INT32U   BSP_OS_TickLatMax;
 
 #ifndef BSP_OS_TMR_PRESCALE
 #define BSP_OS_TMR_PRESCALE                1u    /* Default prescale (no downscale) / 預設為 1 表示不降頻 */
 #endif
 
-static inline void BSP_OS_VirtTimerReload(void)
+#if OS_TICKLESS_EN > 0u
+#ifndef BSP_OS_TICKLESS_MAX_TICKS
+#define BSP_OS_TICKLESS_MAX_TICKS   (OS_TICKS_PER_SEC * 60u)   /* Longest suppressed stretch / 最長的節拍抑制時間 */
+#endif
+
+static CPU_BOOLEAN  BSP_OS_TickIdle;           /* Tick suppressed by the idle task / 閒置時節拍已抑制 */
+#endif
+
+static inline void BSP_OS_VirtTimerArm(CPU_INT64U deadline)
 {
-    CPU_INT32U reload = BSP_OS_TmrReload;      /* Cached reload interval / 快取的重載週期 */
+    __asm__ volatile("msr cntv_cval_el0, %0" :: "r" (deadline));   /* Absolute compare value / 絕對比較值 */
+}
 
-    if (reload != 0u) {
-        __asm__ volatile("msr cntv_tval_el0, %0" :: "rZ" (reload));
+/*
+*********************************************************************************************************
+*                                        BSP_OS_TickAnnounce()
+*
+* Description : Announce every tick period that elapsed on CNTVCT since the last announced tick and
+*               arm the compare value for the next tick deadline.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : BSP_OS_TmrTickHandler(), BSP_OS_TickResume().
+*
+* Note(s)     : (1) Must be called with interrupts disabled.
+*
+*               (2) Deadlines are absolute (previous deadline + period), so interrupt latency never
+*                   accumulates into OSTime.  A handler that runs more than one period late announces
+*                   the missed ticks and counts them in BSP_OS_TickLost.
+*                   截止時間為絕對值（上次截止 + 週期），中斷延遲不會累積到 OSTime；
+*                   延遲超過一個週期時補回遺失的節拍並計入 BSP_OS_TickLost。
+*********************************************************************************************************
+*/
+
+static void BSP_OS_TickAnnounce(void)
+{
+    CPU_INT64U  now;
+    CPU_INT32U  reload;
+    CPU_INT32U  ticks;
+
+
+    reload = BSP_OS_TmrReload;
+    if (reload == 0u) {
+        return;
+    }
+
+    now              = raw_read_cntvct_el0();
+    ticks            = (CPU_INT32U)((now - BSP_OS_TickLast) / reload);
+    BSP_OS_TickLast += (CPU_INT64U)ticks * reload;
+    BSP_OS_VirtTimerArm(BSP_OS_TickLast + reload);             /* Next deadline is always in the future / 下個截止時間必在未來 */
+
+#if OS_TICKLESS_EN > 0u
+    if (BSP_OS_TickIdle == DEF_TRUE) {
+        BSP_OS_TickIdle = DEF_FALSE;
+        OSTimeTickN(ticks);                                    /* Catch up after idle / 閒置後補回節拍 */
+        return;
+    }
+    if (ticks > 1u) {
+        BSP_OS_TickLost += ticks - 1u;
+        OSTimeTickN(ticks);                                    /* Catch up lost ticks / 補回遺失的節拍 */
+        return;
+    }
+#else
+    if (ticks > 1u) {
+        BSP_OS_TickLost += ticks - 1u;
+    }
+#endif
+    while (ticks > 0u) {
+        OSTimeTick();                                          /* Drive µC/OS-II scheduler / 推進 µC/OS-II 排程器 */
+        ticks--;
     }
 }
+
 /*
 *********************************************************************************************************
 *                                       BSP_OS_TmrTickHandler()
@@ -293,19 +366,412 @@ static inline void BSP_OS_VirtTimerReload(void)
 *
 * Caller(s)   : Application.
 *
-* Note(s)     : none.
+* Note(s)     : (1) The compare value still holds the deadline that fired, so CNTVCT - CNTV_CVAL is the
+*                   latency from the timer condition to the ISR (BSP_OS_TickLatencyGet()).  A compare value
+*                   in the future means BSP_OS_TickResume() already re-armed it: nothing to measure.
+*                   比較值仍為觸發的截止時間，兩者之差即計時器到 ISR 的延遲。
 *********************************************************************************************************
 */
 
 void  BSP_OS_TmrTickHandler(CPU_INT32U cpu_id)
 {
+    CPU_INT64U  now;
+    CPU_INT64U  cval;
+    CPU_INT32U  lat;
+
+
     (void)cpu_id;
 
-    BSP_OS_VirtTimerReload();                                  /* Program next tick / 設定下一個節拍 */
-    OSTimeTick();                                              /* Drive µC/OS-II scheduler / 推進 µC/OS-II 排程器 */
+    now = raw_read_cntvct_el0();
+    __asm__ volatile("mrs %0, cntv_cval_el0" : "=r" (cval));
+    if (now >= cval) {                                         /* See Note #1.                                         */
+        lat                = (CPU_INT32U)(now - cval);
+        BSP_OS_TickLatLast = lat;
+        if (lat > BSP_OS_TickLatMax) {
+            BSP_OS_TickLatMax = lat;
+        }
+    }
+
+    BSP_OS_TickAnnounce();                                     /* Count ticks on CNTVCT / 依 CNTVCT 計算節拍 */
+}
+
+#if OS_TICKLESS_EN > 0u
+/*
+*********************************************************************************************************
+*                                        BSP_OS_TickSuppress()
+*
+* Description : Stop the periodic tick while the CPU is idle.  The virtual timer compare value is set to
+*               the deadline of the earliest task delay or pend timeout, so the core stays in WFI until
+*               that deadline or until another interrupt arrives.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : OSTaskIdleHook().
+*
+* Note(s)     : (1) With no delayed task at all the deadline is capped at BSP_OS_TICKLESS_MAX_TICKS.
+*
+*               (2) Any interrupt taken while the tick is suppressed calls BSP_OS_TickResume() first,
+*                   so OSTime is caught up before an ISR can ready a task.
+*                   抑制期間任何中斷都會先呼叫 BSP_OS_TickResume()，確保 ISR 喚醒任務前 OSTime 已補齊。
+*********************************************************************************************************
+*/
+
+void  BSP_OS_TickSuppress (void)
+{
+    INT32U     next;
+#if OS_CRITICAL_METHOD == 3u
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+    if (BSP_OS_TmrReload == 0u) {
+        return;
+    }
+
+    OS_ENTER_CRITICAL();                                       /* CPU_CRITICAL_ENTER() is a no-op in this port / 此移植中 CPU_CRITICAL_ENTER() 為空操作 */
+    next = OSTimeNextExpiry();
+    if (next != 1u) {                                          /* Next tick is due anyway otherwise / 否則下個節拍本來就要到 */
+        if ((next == 0u) || (next > BSP_OS_TICKLESS_MAX_TICKS)) {
+            next = BSP_OS_TICKLESS_MAX_TICKS;
+        }
+        BSP_OS_VirtTimerArm(BSP_OS_TickLast + (CPU_INT64U)next * BSP_OS_TmrReload);
+        BSP_OS_TickIdle = DEF_TRUE;
+    }
+    OS_EXIT_CRITICAL();
+}
+
+/*
+*********************************************************************************************************
+*                                        BSP_OS_TickResume()
+*
+* Description : Restart the periodic tick after a suppressed stretch and announce the elapsed ticks.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : BSP_IntHandler().
+*
+* Note(s)     : (1) Must be called with interrupts disabled.  Cheap when the tick is running.
+*********************************************************************************************************
+*/
+
+void  BSP_OS_TickResume (void)
+{
+    if (BSP_OS_TickIdle == DEF_TRUE) {
+        BSP_OS_TickAnnounce();
+    }
+}
+#endif
+
+/*
+*********************************************************************************************************
+*                                        BSP_OS_TickLostGet()
+*
+* Description : Return the number of ticks that had to be caught up because the tick interrupt ran more
+*               than one period late.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Lost tick count since BSP_OS_TmrTickInit().
+*
+* Caller(s)   : Application.
+*
+* Note(s)     : none.
+*********************************************************************************************************
+*/
+
+CPU_INT32U  BSP_OS_TickLostGet (void)
+{
+    return (BSP_OS_TickLost);
 }
 
 
+/*
+*********************************************************************************************************
+*                                       BSP_OS_TickLatencyGet()
+*
+* Description : Return the interrupt latency of the tick, from the timer deadline to the tick ISR.
+*
+* Argument(s) : p_last_ns    Latency of the last tick, in ns (may be DEF_NULL).
+*
+*               p_max_ns     Worst latency since BSP_OS_TmrTickInit(), in ns (may be DEF_NULL).
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application, tests.
+*
+* Note(s)     : (1) Covers exception entry, the GIC acknowledge and any time the IRQ spent masked or behind a
+*                   higher priority ISR.
+*********************************************************************************************************
+*/
+
+void  BSP_OS_TickLatencyGet (CPU_INT32U  *p_last_ns,
+                             CPU_INT32U  *p_max_ns)
+{
+    CPU_INT64U  mult;
+
+
+    mult = BSP_OS_NsMult;
+    if (p_last_ns != DEF_NULL) {
+        *p_last_ns = (CPU_INT32U)(((unsigned __int128)BSP_OS_TickLatLast * mult) >> 32);
+    }
+    if (p_max_ns != DEF_NULL) {
+        *p_max_ns  = (CPU_INT32U)(((unsigned __int128)BSP_OS_TickLatMax * mult) >> 32);
+    }
+}
+
+/*
+*********************************************************************************************************
+*                                         BSP_OS_TimeGetNs()
+*
+* Description : Return a 64-bit monotonic time in nanoseconds, read straight from CNTVCT_EL0.
+*
+* Argument(s) : none.
+*
+* Return(s)   : Nanoseconds since the counter started (power-on).
+*
+* Caller(s)   : Application, network stack.
+*
+* Note(s)     : (1) Safe from tasks and ISRs; no lock is taken.  Resolution is one counter period
+*                   (16 ns at the 62.5 MHz QEMU virt counter), independent of OS_TICKS_PER_SEC.
+*                   可在任務與 ISR 中呼叫，不需上鎖；解析度為一個計數週期，與節拍頻率無關。
+*
+*               (2) The count is scaled with a 32.32 fixed-point multiplier so no division is done
+*                   on the fast path.
+*********************************************************************************************************
+*/
+
+CPU_INT64U  BSP_OS_TimeGetNs (void)
+{
+    CPU_INT64U  mult;
+
+
+    mult = BSP_OS_NsMult;
+    if (mult == 0u) {                                          /* Called before BSP_OS_TmrTickInit() / 初始化前呼叫 */
+        mult = ((CPU_INT64U)DEF_TIME_NBR_nS_PER_SEC << 32) / raw_read_cntfrq_el0();
+        BSP_OS_NsMult = mult;
+    }
+
+    return ((CPU_INT64U)(((unsigned __int128)raw_read_cntvct_el0() * mult) >> 32));
+}
+
+
+static CPU_INT64U  BSP_OS_CntToUs (CPU_INT64U  cnt)             /* CNTVCT counts to us / 計數轉微秒 */
+{
+    (void)BSP_OS_TimeGetNs();                                  /* Make sure BSP_OS_NsMult is set / 確保倍率已初始化 */
+
+    return ((CPU_INT64U)(((unsigned __int128)cnt * BSP_OS_NsMult) >> 32) / 1000u);
+}
+
+
+/*
+*********************************************************************************************************
+*                                         BSP_OS_ProfReport()
+*
+* Description : Print the run time accounting of every task and of the ISRs on the UART.
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application (periodically), tests.
+*
+* Note(s)     : (1) Shares are of the time since the first task started, so they add up to about 100 %
+*                   with the idle task included.  Counts come from OSTaskProfGet() / OS_CPU_IntProfGet().
+*                   比例以第一個任務啟動後的時間為基準，含閒置任務合計約 100%。
+*
+*               (2) The scheduler is locked while the task list is walked, so no task can be deleted
+*                   under it; each TCB is copied with interrupts masked.
+*********************************************************************************************************
+*/
+
+#if OS_TASK_PROFILE_EN > 0u
+static void  BSP_OS_ProfLine (const char          *p_name,
+                              CPU_INT32U           prio,
+                              const OS_TASK_PROF  *p_prof,
+                              CPU_INT64U           elapsed)
+{
+    CPU_INT32U  permille;
+
+
+    permille = (elapsed > 0u) ? (CPU_INT32U)((p_prof->OSCyclesTot * 1000u) / elapsed) : 0u;
+    printf("[PROF] %3u %3u.%u%% %9u %9u %8llu  %s\n",
+           (unsigned)prio,
+           (unsigned)(permille / 10u),
+           (unsigned)(permille % 10u),
+           (unsigned)p_prof->OSCtxSwCtr,
+           (unsigned)p_prof->OSPreemptCtr,
+           (unsigned long long)BSP_OS_CntToUs(p_prof->OSCyclesMax),
+           p_name);
+}
+
+
+void  BSP_OS_ProfReport (void)
+{
+    OS_TCB        *p_tcb;
+    OS_TASK_PROF   prof;
+    CPU_INT64U     elapsed;
+    const char    *p_name;
+    CPU_INT32U     prio;
+#if OS_CRITICAL_METHOD == 3u
+    OS_CPU_SR      cpu_sr = 0u;
+#endif
+
+
+    elapsed = raw_read_cntvct_el0() - OS_CPU_ProfCyclesStart;
+    printf("[PROF] %llu ms since start\n", (unsigned long long)(BSP_OS_CntToUs(elapsed) / 1000u));
+    printf("[PROF] pri   cpu     ctxsw   preempt   max_us  name\n");
+
+    OSSchedLock();
+    for (p_tcb = OSTCBList; p_tcb != (OS_TCB *)0; p_tcb = p_tcb->OSTCBNext) {
+        OS_ENTER_CRITICAL();
+        prio              = p_tcb->OSTCBPrio;
+        p_name            = (const char *)p_tcb->OSTCBTaskName;
+        prof.OSCtxSwCtr   = p_tcb->OSTCBCtxSwCtr;
+        prof.OSPreemptCtr = p_tcb->OSTCBPreemptCtr;
+        prof.OSCyclesTot  = p_tcb->OSTCBCyclesTot;
+        prof.OSCyclesMax  = p_tcb->OSTCBCyclesMax;
+        OS_EXIT_CRITICAL();
+        BSP_OS_ProfLine(p_name, prio, &prof, elapsed);
+    }
+    OSSchedUnlock();
+
+    OS_CPU_IntProfGet(&prof);                                  /* ctxsw column is the IRQ count / ctxsw 欄為 IRQ 次數 */
+    BSP_OS_ProfLine("(ISR)", 0u, &prof, elapsed);
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                 CPU_TS_TmrInit() / CPU_TS_TmrRd()
+*
+* Description : uC/CPU timestamp timer.  The timestamps run on CNTVCT_EL0, the counter the tick, the
+*               trace and the run time accounting already use.
+*               uC/CPU 時間戳計時器，使用 CNTVCT_EL0（與節拍、追蹤、執行時間統計相同的計數器）。
+*
+* Argument(s) : ts_cnts     Timestamp, in counts (CPU_TSxx_to_uSec() only).
+*
+* Return(s)   : CPU_TS_TmrRd() returns the current count; CPU_TSxx_to_uSec() the time in microseconds.
+*
+* Caller(s)   : CPU_TS_Init(), CPU_TS_Get32(), CPU_TS_Get64(); CPU_TSxx_to_uSec() by the application.
+*
+* Note(s)     : (1) The generic timer is 56 bits or wider and counts up, so CPU_CFG_TS_TMR_SIZE is 64 and
+*                   the value needs no complementing or accumulation (see cpu_core.h CPU_TS_TmrRd()
+*                   Note #2).
+*********************************************************************************************************
+*/
+
+#if (CPU_CFG_TS_TMR_EN == DEF_ENABLED)
+void  CPU_TS_TmrInit (void)
+{
+    CPU_TS_TmrFreqSet((CPU_TS_TMR_FREQ)raw_read_cntfrq_el0());  /* Counter already runs / 計數器已在運行 */
+}
+
+
+CPU_TS_TMR  CPU_TS_TmrRd (void)
+{
+    return ((CPU_TS_TMR)raw_read_cntvct_el0());
+}
+#endif
+
+
+#if (CPU_CFG_TS_32_EN == DEF_ENABLED)
+CPU_INT64U  CPU_TS32_to_uSec (CPU_TS32  ts_cnts)
+{
+    return (BSP_OS_CntToUs((CPU_INT64U)ts_cnts));
+}
+#endif
+
+
+#if (CPU_CFG_TS_64_EN == DEF_ENABLED)
+CPU_INT64U  CPU_TS64_to_uSec (CPU_TS64  ts_cnts)
+{
+    return (BSP_OS_CntToUs((CPU_INT64U)ts_cnts));
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                        BSP_OS_IntDisReport()
+*
+* Description : Print the longest interrupts-disabled sections measured by OS_ENTER_CRITICAL() /
+*               OS_EXIT_CRITICAL(), worst first, with the code addresses that opened and closed them.
+*               列出最長的關中斷區段及其進入/離開位址。
+*
+* Argument(s) : none.
+*
+* Return(s)   : none.
+*
+* Caller(s)   : Application (console command).
+*
+* Note(s)     : (1) Measuring is off until OS_CPU_IntDisMeasCtl(OS_TRUE) is called.
+*
+*               (2) The addresses point just after the calls in the functions that entered / left the
+*                   critical section.  Resolve them with 'addr2line -f -e bin/kernel.elf <pc>'.
+*                   位址以 addr2line 對應回函式。
+*
+*               (3) The table is copied with interrupts masked and printed afterwards, so the report
+*                   does not measure itself.
+*********************************************************************************************************
+*/
+
+#if OS_CPU_INT_DIS_MEAS_EN > 0u
+void  BSP_OS_IntDisReport (void)
+{
+    OS_CPU_INT_DIS_SITE  sites[OS_CPU_INT_DIS_MEAS_SITES];
+    OS_CPU_INT_DIS_SITE  site_max;
+    OS_CPU_INT_DIS_SITE  tmp;
+    CPU_INT32U           ctr;
+    CPU_INT32U           i;
+    CPU_INT32U           j;
+    CPU_SR               cpu_sr;
+
+
+    if (OS_CPU_IntDisMeasEn == OS_FALSE) {
+        printf("[IRQOFF] Measurement off\n");
+        return;
+    }
+
+    cpu_sr   = CPU_SR_Save();                                  /* See Note #3 / 見註 3 */
+    ctr      = OS_CPU_IntDisMeasCtr;
+    site_max = OS_CPU_IntDisMeasMax;
+    for (i = 0u; i < OS_CPU_INT_DIS_MEAS_SITES; i++) {
+        sites[i] = OS_CPU_IntDisMeasSiteTbl[i];
+    }
+    CPU_SR_Restore(cpu_sr);
+
+    for (i = 1u; i < OS_CPU_INT_DIS_MEAS_SITES; i++) {         /* Longest first / 由長至短 */
+        tmp = sites[i];
+        for (j = i; (j > 0u) && (sites[j - 1u].CntsMax < tmp.CntsMax); j--) {
+            sites[j] = sites[j - 1u];
+        }
+        sites[j] = tmp;
+    }
+
+    printf("[IRQOFF] %u sections, longest %llu us (%llu counts)\n",
+           (unsigned)ctr,
+           (unsigned long long)BSP_OS_CntToUs(site_max.CntsMax),
+           (unsigned long long)site_max.CntsMax);
+    printf("[IRQOFF]   max_us   counts  enter               exit\n");
+    for (i = 0u; i < OS_CPU_INT_DIS_MEAS_SITES; i++) {
+        if (sites[i].PcEnter == (void *)0) {
+            break;
+        }
+        printf("[IRQOFF] %8llu %8llu  0x%016llx  0x%016llx\n",
+               (unsigned long long)BSP_OS_CntToUs(sites[i].CntsMax),
+               (unsigned long long)sites[i].CntsMax,
+               (unsigned long long)(CPU_INT64U)sites[i].PcEnter,
+               (unsigned long long)(CPU_INT64U)sites[i].PcExit);
+    }
+}
+#endif
+
+
 
 /*
  *********************************************************************************************************
@@ -344,18 +810,26 @@ void BSP_OS_TmrTickInit(CPU_INT32U tick_rate)
 	if (eff_rate == 0u) {
 		eff_rate = 1u;
 	}
-	CPU_INT32U reload = cnt_freq / eff_rate;                     /* Reload value for CNTV_TVAL_EL0 / CNTV_TVAL_EL0 的重載值 */
+	CPU_INT32U reload = cnt_freq / eff_rate;                     /* Counter cycles per tick / 每個節拍的計數週期 */
 	if (reload == 0u) {
 		reload = 1u;
 	}
 
 	BSP_OS_TmrReload = reload;                                   /* Save for fast IRQ use / 保存供 IRQ 快速重載 */
+	BSP_OS_NsMult    = ((CPU_INT64U)DEF_TIME_NBR_nS_PER_SEC << 32) / cnt_freq;
+	BSP_OS_TickLost  = 0u;
+	BSP_OS_TickLatLast = 0u;
+	BSP_OS_TickLatMax  = 0u;
+	BSP_OS_TickLast  = raw_read_cntvct_el0();                    /* Tick 0 starts now / 節拍 0 從此刻開始 */
+#if OS_TICKLESS_EN > 0u
+	BSP_OS_TickIdle  = DEF_FALSE;
+#endif
+	BSP_OS_VirtTimerArm(BSP_OS_TickLast + reload);               /* First absolute deadline / 第一個絕對截止時間 */
 	arch_timer_reg_write_cp15(ARCH_TIMER_VIRT_ACCESS, ARCH_TIMER_REG_CTRL, ARCH_TIMER_CTRL_ENABLE);
-	BSP_OS_VirtTimerReload();
 
 #if 1
     BSP_IntVectSet (27u,
-                    0u,
+                    BSP_INT_PRIO_TICK,
                     0u,
                     BSP_OS_TmrTickHandler);
 
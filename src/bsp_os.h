@@ -100,6 +100,24 @@ void          BSP_OS_TimeDlyMs          (CPU_INT32U      dly_ms);
 
 void          BSP_OS_TmrTickISR_Handler (CPU_INT32U      cpu_id);
 
+CPU_INT64U    BSP_OS_TimeGetNs          (void);                        /* Monotonic ns clock on CNTVCT / 以 CNTVCT 為基準的單調奈秒時鐘 */
+CPU_INT32U    BSP_OS_TickLostGet        (void);
+void          BSP_OS_TickLatencyGet     (CPU_INT32U     *p_last_ns,      /* Timer deadline to tick ISR / 節拍中斷延遲 */
+                                         CPU_INT32U     *p_max_ns);
+
+#if OS_TASK_PROFILE_EN > 0u
+void          BSP_OS_ProfReport         (void);                        /* Per-task and ISR run time / 各任務與 ISR 執行時間 */
+#endif
+
+#if OS_CPU_INT_DIS_MEAS_EN > 0u
+void          BSP_OS_IntDisReport       (void);                        /* Longest IRQs-off sections / 最長關中斷區段 */
+#endif
+
+#if OS_TICKLESS_EN > 0u
+void          BSP_OS_TickSuppress       (void);                        /* Stop the tick while idle / 閒置時停止節拍 */
+void          BSP_OS_TickResume         (void);
+#endif
+
 void          OS_CPU_ExceptHndlr        (CPU_INT32U      except_id);
 
 
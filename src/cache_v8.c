@@ -465,6 +465,19 @@ void mmu_setup(void)
 	set_sctlr(get_sctlr() & ~CR_SA);
 }
 
+/*
+ * Turn on the MMU and caches of a secondary core, reusing the page tables
+ * the boot core built in enable_caches(). No set/way invalidate here: that
+ * would throw away the boot core's dirty lines in the shared L2.
+ */
+void mmu_secondary_enable(void)
+{
+	__asm_invalidate_tlb_all();
+	__asm_invalidate_icache_all();
+	mmu_setup();
+	set_sctlr(get_sctlr() | CR_C | CR_I);
+}
+
 /*
  * Performs a invalidation of the entire data cache at all levels
  */
@@ -511,7 +524,15 @@ void dcache_enable(void)
 {
 	/* The data cache is not active unless the mmu is enabled */
 	if (!(get_sctlr() & CR_M)) {
+#if defined(AMP_CORE_ID) && (AMP_CORE_ID != 0)
+		/*
+		 * Core 0 is already running out of the shared L2, AMP rings
+		 * included. As in mmu_secondary_enable(), skip the set/way
+		 * invalidate: this core's own L1 comes out of reset clean.
+		 */
+#else
 		invalidate_dcache_all();
+#endif
 		__asm_invalidate_tlb_all();
 		mmu_setup();
 	}
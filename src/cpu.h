@@ -414,6 +414,12 @@ typedef  CPU_INT32U                 CPU_SR;                     /* Defines   CPU
 *********************************************************************************************************
 */
 
+void        CPU_IntDis       (void);                        /* See 'cpu_a.S'.                                       */
+void        CPU_IntEn        (void);
+
+void        CPU_WaitForInt   (void);
+void        CPU_WaitForEvent (void);
+
 
 /*
 *********************************************************************************************************
@@ -96,8 +96,8 @@
 */
 
                                                                 /* Configure CPU timestamp features (see Note #1) :     */
-#define  CPU_CFG_TS_32_EN                       DEF_DISABLED
-#define  CPU_CFG_TS_64_EN                       DEF_DISABLED
+#define  CPU_CFG_TS_32_EN                       DEF_ENABLED     /* CPU_TS_TmrRd() reads CNTVCT_EL0 (bsp_os.c).          */
+#define  CPU_CFG_TS_64_EN                       DEF_ENABLED
                                                                 /*   DEF_DISABLED  CPU timestamps DISABLED              */
                                                                 /*   DEF_ENABLED   CPU timestamps ENABLED               */
 
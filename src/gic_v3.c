@@ -43,6 +43,7 @@ typedef unsigned int u32;
 #define DIST_BASE        0x08000000
 #define RDIST_RD_BASE    0x080a0000
 #define RDIST_SGI_BASE   0x080b0000
+#define RDIST_STRIDE     0x20000     /* RD_base + SGI_base frames per core */
 
 #define GIC_DIST_CTRL           0x000
 #define GIC_DIST_CTR            0x004
@@ -469,6 +470,14 @@ static inline void gic_write_bpr1(u32 val)
 
 }
 
+void gic_write_sgi1r(u64 val)
+{
+//#define SYS_ICC_SGI1R_EL1       sys_reg(3, 0, 12, 11, 5)
+	asm volatile("dsb ishst" ::: "memory");
+	asm volatile("msr S3_0_c12_c11_5, %x0" :: "rZ" (val));
+	isb();
+}
+
 
 /*
 711 #define read_sysreg_s(r) ({                     \
@@ -531,16 +540,13 @@ static void gic_cpu_sys_reg_init(void)
 	 */
 	gic_write_bpr1(0);
 
-#if 0
-	if (static_key_true(&supports_deactivate)) {
-		/* EOI drops priority only (mode 1) */
-		gic_write_ctlr(ICC_CTLR_EL1_EOImode_drop);
-	} else
+#if (BSP_CFG_GIC_EOI_SPLIT == DEF_ENABLED)
+	/* EOI drops priority only (mode 1), BSP_IntEOI() deactivates through ICC_DIR_EL1 */
+	gic_write_ctlr(ICC_CTLR_EL1_EOImode_drop);
+#else
+	/* EOI deactivates interrupt too (mode 0) */
+	gic_write_ctlr(ICC_CTLR_EL1_EOImode_drop_dir);
 #endif
-	 {
-		/* EOI deactivates interrupt too (mode 0) */
-		gic_write_ctlr(ICC_CTLR_EL1_EOImode_drop_dir);
-	}
 
 	/* ... and let's hit the road... */
 	gic_write_grpen1(1);
@@ -654,6 +660,52 @@ void gic_cpu_init()
 
 }
 
+/*
+ * Bring up the redistributor and CPU interface of a secondary core.
+ * Runs before the core has any OS services, so the waits are busy polls
+ * rather than the OSTimeDlyHMSM() ones used on the boot path.
+ */
+static void gic_redist_wait_for_rwp_cpu(unsigned int cpu)
+{
+	unsigned int count = 1000000;
+
+	while ((readl_relaxed(RDIST_RD_BASE + cpu * RDIST_STRIDE + GICR_CTLR) & GICD_CTLR_RWP) && --count)
+		;
+}
+
+void gic_v3_cpu_init_secondary(unsigned int cpu)
+{
+	unsigned int rbase = RDIST_RD_BASE + cpu * RDIST_STRIDE;
+	unsigned int count = 1000000;
+
+	writel_relaxed(readl_relaxed(rbase + GICR_WAKER) & ~GICR_WAKER_ProcessorSleep,
+		       rbase + GICR_WAKER);
+	while ((readl_relaxed(rbase + GICR_WAKER) & GICR_WAKER_ChildrenAsleep) && --count)
+		;
+
+	/* Configure SGIs/PPIs as non-secure Group-1 */
+	writel_relaxed(~0, rbase + 0x10000 + GICR_IGROUPR0);
+
+	gic_cpu_config(rbase + 0x10000, NULL);
+	gic_redist_wait_for_rwp_cpu(cpu);
+
+	gic_cpu_sys_reg_init();
+}
+
+/*
+ * Route an SPI to a single core (Aff0 = cpu). gic_dist_init() sends them all
+ * to the boot CPU; an AMP image uses this for the NIC it owns.
+ */
+void gic_v3_irq_route(unsigned int irq, unsigned int cpu)
+{
+	void *base = DIST_BASE;
+
+	if (irq < 32)
+		return;
+
+	gic_write_irouter((unsigned long long)cpu, base + GICD_IROUTER + irq * 8);
+}
+
 void gic_v3_init() //refer to gic_init_bases in drivers/irqchip/irq-gic-v3.c
 {
 	//printf("%s!\n",__func__);
@@ -0,0 +1,561 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "heap.h"
+
+/*
+ * Every block starts with a 16-byte header: the physical predecessor and the
+ * payload size. Free blocks keep their list links in the first 16 bytes of
+ * the payload, which sets the minimum payload. Sizes are multiples of
+ * HEAP_ALIGN, so bit 0 of the size is free to mark free blocks. A zero-sized,
+ * allocated sentinel ends the heap so that merging never runs off the end.
+ */
+struct heap_block {
+    struct heap_block *prev_phys;       /* NULL for the first block */
+    size_t size;                        /* Payload bytes | BLOCK_FREE */
+    struct heap_block *next_free;       /* Payload starts here */
+    struct heap_block *prev_free;
+};
+
+#define BLOCK_FREE              ((size_t)1)
+#define BLOCK_SIZE_MASK         (~(size_t)(HEAP_ALIGN - 1u))
+#define BLOCK_MIN               (sizeof(struct heap_block) - HEAP_OVERHEAD)
+#define BLOCK_MAX               (((size_t)1 << HEAP_FL_MAX_LOG2) - HEAP_ALIGN)
+#define ALLOC_MAX               ((size_t)1 << (HEAP_FL_MAX_LOG2 - 1u))
+
+_Static_assert(offsetof(struct heap_block, next_free) == HEAP_OVERHEAD, "heap header size");
+_Static_assert(HEAP_FL_COUNT <= 32u && HEAP_SL_COUNT <= 32u, "heap bitmaps are 32 bits wide");
+
+/* -------------------------------------------------------------------------- */
+/* Block helpers                                                              */
+/* -------------------------------------------------------------------------- */
+
+static inline size_t block_size(const struct heap_block *b)
+{
+    return b->size & BLOCK_SIZE_MASK;
+}
+
+static inline int block_is_free(const struct heap_block *b)
+{
+    return (b->size & BLOCK_FREE) != 0u;
+}
+
+static inline void *block_to_ptr(const struct heap_block *b)
+{
+    return (char *)b + HEAP_OVERHEAD;
+}
+
+static inline struct heap_block *ptr_to_block(const void *ptr)
+{
+    return (struct heap_block *)((char *)ptr - HEAP_OVERHEAD);
+}
+
+static inline struct heap_block *block_next(const struct heap_block *b)
+{
+    return (struct heap_block *)((char *)block_to_ptr(b) + block_size(b));
+}
+
+static inline unsigned fls_size(size_t x)
+{
+    return 63u - (unsigned)__builtin_clzll((unsigned long long)x);
+}
+
+static inline size_t align_up(size_t x, size_t align)
+{
+    return (x + align - 1u) & ~(align - 1u);
+}
+
+/* Payload size for a request, 0 if it cannot be satisfied at all */
+static inline size_t adjust_request(size_t size)
+{
+    if (size == 0u || size > ALLOC_MAX) {
+        return 0u;
+    }
+    size = align_up(size, HEAP_ALIGN);
+
+    return size < BLOCK_MIN ? BLOCK_MIN : size;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Size classes                                                               */
+/* -------------------------------------------------------------------------- */
+
+/* List a block of this size belongs on */
+static inline void mapping_insert(size_t size, unsigned *fl, unsigned *sl)
+{
+    unsigned t;
+
+    if (size < ((size_t)1 << HEAP_FL_SHIFT)) {
+        *fl = 0u;
+        *sl = (unsigned)(size >> HEAP_ALIGN_LOG2);
+    } else {
+        t = fls_size(size);
+        *sl = (unsigned)(size >> (t - HEAP_SL_LOG2)) ^ HEAP_SL_COUNT;
+        *fl = t - (HEAP_FL_SHIFT - 1u);
+    }
+}
+
+/* First list whose every block is at least this size */
+static inline void mapping_search(size_t size, unsigned *fl, unsigned *sl)
+{
+    if (size >= ((size_t)1 << HEAP_FL_SHIFT)) {
+        size += ((size_t)1 << (fls_size(size) - HEAP_SL_LOG2)) - 1u;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+static struct heap_block *find_free(const struct heap *h, size_t size)
+{
+    unsigned fl, sl;
+    uint32_t sl_map, fl_map;
+
+    mapping_search(size, &fl, &sl);
+    if (fl >= HEAP_FL_COUNT) {
+        return NULL;
+    }
+
+    sl_map = h->sl_bitmap[fl] & (~0u << sl);
+    if (sl_map == 0u) {
+        fl_map = h->fl_bitmap & (~0u << (fl + 1u));
+        if (fl_map == 0u) {
+            return NULL;
+        }
+        fl = (unsigned)__builtin_ctz(fl_map);
+        sl_map = h->sl_bitmap[fl];
+    }
+    sl = (unsigned)__builtin_ctz(sl_map);
+
+    return h->free[fl][sl];
+}
+
+/* -------------------------------------------------------------------------- */
+/* Free lists                                                                 */
+/* -------------------------------------------------------------------------- */
+
+static void block_insert(struct heap *h, struct heap_block *b)
+{
+    struct heap_block *head;
+    unsigned fl, sl;
+
+    mapping_insert(block_size(b), &fl, &sl);
+    head = h->free[fl][sl];
+    b->next_free = head;
+    b->prev_free = NULL;
+    if (head) {
+        head->prev_free = b;
+    }
+    h->free[fl][sl] = b;
+    h->fl_bitmap |= 1u << fl;
+    h->sl_bitmap[fl] |= 1u << sl;
+}
+
+static void block_remove(struct heap *h, struct heap_block *b)
+{
+    unsigned fl, sl;
+
+    mapping_insert(block_size(b), &fl, &sl);
+    if (b->next_free) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    if (b->prev_free) {
+        b->prev_free->next_free = b->next_free;
+        return;
+    }
+
+    h->free[fl][sl] = b->next_free;
+    if (!b->next_free) {
+        h->sl_bitmap[fl] &= ~(1u << sl);
+        if (h->sl_bitmap[fl] == 0u) {
+            h->fl_bitmap &= ~(1u << fl);
+        }
+    }
+}
+
+/* Absorb the following block if it is free; b must not be on a list */
+static void merge_next(struct heap *h, struct heap_block *b)
+{
+    struct heap_block *n = block_next(b);
+
+    if (block_is_free(n)) {
+        block_remove(h, n);
+        b->size += HEAP_OVERHEAD + block_size(n);
+        block_next(b)->prev_phys = b;
+    }
+}
+
+/* Let a free predecessor absorb b; returns the merged block */
+static struct heap_block *merge_prev(struct heap *h, struct heap_block *b)
+{
+    struct heap_block *p = b->prev_phys;
+
+    if (p && block_is_free(p)) {
+        block_remove(h, p);
+        p->size += HEAP_OVERHEAD + block_size(b);
+        block_next(p)->prev_phys = p;
+        return p;
+    }
+
+    return b;
+}
+
+/* Trim an allocated block to size and give the tail back */
+static void block_trim(struct heap *h, struct heap_block *b, size_t size)
+{
+    struct heap_block *rest;
+    size_t left = block_size(b) - size;
+
+    if (left < HEAP_OVERHEAD + BLOCK_MIN) {
+        return;
+    }
+
+    rest = (struct heap_block *)((char *)block_to_ptr(b) + size);
+    rest->size = (left - HEAP_OVERHEAD) | BLOCK_FREE;
+    rest->prev_phys = b;
+    block_next(rest)->prev_phys = rest;
+    b->size = size;
+
+    merge_next(h, rest);
+    block_insert(h, rest);
+}
+
+static void *block_use(struct heap *h, struct heap_block *b, size_t size)
+{
+    b->size &= ~BLOCK_FREE;
+    block_trim(h, b, size);
+
+    h->used += block_size(b);
+    h->used_blocks++;
+    if (h->used > h->peak_used) {
+        h->peak_used = h->used;
+    }
+
+    return block_to_ptr(b);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Public interface                                                           */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * heap_init() - Put a heap on a memory region
+ * @h: Control block; kept outside the region
+ * @mem: Start of the region
+ * @size: Region size in bytes; anything past 4 GiB is left unused
+ *
+ * Return: 0 on success, -1 if the region is too small.
+ */
+int heap_init(struct heap *h, void *mem, size_t size)
+{
+    struct heap_block *b;
+    uintptr_t start = align_up((uintptr_t)mem, HEAP_ALIGN);
+    uintptr_t end = ((uintptr_t)mem + size) & ~(uintptr_t)(HEAP_ALIGN - 1u);
+    size_t payload;
+
+    memset(h, 0, sizeof(*h));
+    if (end <= start || end - start < 2u * HEAP_OVERHEAD + BLOCK_MIN) {
+        return -1;
+    }
+
+    payload = (size_t)(end - start) - 2u * HEAP_OVERHEAD;
+    if (payload > BLOCK_MAX) {
+        payload = BLOCK_MAX;
+    }
+
+    b = (struct heap_block *)start;
+    b->prev_phys = NULL;
+    b->size = payload | BLOCK_FREE;
+    block_next(b)->prev_phys = b;
+    block_next(b)->size = 0u;           /* Sentinel */
+    block_insert(h, b);
+
+    h->base = b;
+    h->size = payload + 2u * HEAP_OVERHEAD;
+
+    return 0;
+}
+
+/**
+ * heap_alloc() - Allocate a block aligned to HEAP_ALIGN
+ * @h: Heap
+ * @size: Bytes wanted
+ *
+ * Return: the block, or NULL if size is 0 or nothing fits.
+ */
+void *heap_alloc(struct heap *h, size_t size)
+{
+    struct heap_block *b;
+    size_t adj = adjust_request(size);
+
+    b = adj ? find_free(h, adj) : NULL;
+    if (!b) {
+        h->fails++;
+        return NULL;
+    }
+    block_remove(h, b);
+
+    return block_use(h, b, adj);
+}
+
+/**
+ * heap_memalign() - Allocate a block with a stricter alignment
+ * @h: Heap
+ * @align: Power-of-two alignment
+ * @size: Bytes wanted
+ *
+ * Searches for size + align + one minimal block, so that the bytes in front
+ * of the aligned address can always go back to the heap as a free block.
+ *
+ * Return: the block, or NULL on a bad alignment or when nothing fits.
+ */
+void *heap_memalign(struct heap *h, size_t align, size_t size)
+{
+    const size_t gap_min = HEAP_OVERHEAD + BLOCK_MIN;
+    struct heap_block *b, *nb;
+    size_t adj, gap;
+    uintptr_t ptr, aligned;
+
+    if (align <= HEAP_ALIGN) {
+        return heap_alloc(h, size);
+    }
+
+    adj = adjust_request(size);
+    if (adj == 0u || (align & (align - 1u)) != 0u || align > ALLOC_MAX ||
+        adj + align + gap_min > ALLOC_MAX) {
+        h->fails++;
+        return NULL;
+    }
+
+    b = find_free(h, adj + align + gap_min);
+    if (!b) {
+        h->fails++;
+        return NULL;
+    }
+    block_remove(h, b);
+
+    ptr = (uintptr_t)block_to_ptr(b);
+    aligned = align_up(ptr, align);
+    gap = aligned - ptr;
+    if (gap != 0u && gap < gap_min) {
+        aligned = align_up(ptr + gap_min, align);
+        gap = aligned - ptr;
+    }
+
+    if (gap != 0u) {
+        /* b keeps the leading bytes, still free; its predecessor is in use */
+        nb = ptr_to_block((void *)aligned);
+        nb->size = block_size(b) - gap;
+        nb->prev_phys = b;
+        block_next(nb)->prev_phys = nb;
+        b->size = (gap - HEAP_OVERHEAD) | BLOCK_FREE;
+        block_insert(h, b);
+        b = nb;
+    }
+
+    return block_use(h, b, adj);
+}
+
+/**
+ * heap_free() - Return a block to the heap
+ * @h: Heap the block came from
+ * @ptr: Block, or NULL
+ *
+ * Merges with free neighbours. A block that is already free is ignored.
+ */
+void heap_free(struct heap *h, void *ptr)
+{
+    struct heap_block *b;
+
+    if (!ptr) {
+        return;
+    }
+
+    b = ptr_to_block(ptr);
+    if (block_is_free(b)) {
+        return;
+    }
+
+    h->used -= block_size(b);
+    h->used_blocks--;
+
+    b->size |= BLOCK_FREE;
+    b = merge_prev(h, b);
+    merge_next(h, b);
+    block_insert(h, b);
+}
+
+/**
+ * heap_resize() - Grow or shrink a block without moving it
+ * @h: Heap
+ * @ptr: Allocated block
+ * @size: New size in bytes, not 0
+ *
+ * Growing only succeeds when the next block is free and large enough.
+ *
+ * Return: 0 on success, -1 if the block would have to move.
+ */
+int heap_resize(struct heap *h, void *ptr, size_t size)
+{
+    struct heap_block *b = ptr_to_block(ptr);
+    struct heap_block *n;
+    size_t adj = adjust_request(size);
+    size_t cur = block_size(b);
+
+    if (adj == 0u) {
+        return -1;
+    }
+
+    if (adj > cur) {
+        n = block_next(b);
+        if (!block_is_free(n) || cur + HEAP_OVERHEAD + block_size(n) < adj) {
+            return -1;
+        }
+        block_remove(h, n);
+        b->size += HEAP_OVERHEAD + block_size(n);
+        block_next(b)->prev_phys = b;
+    }
+
+    block_trim(h, b, adj);
+    h->used = h->used - cur + block_size(b);
+    if (h->used > h->peak_used) {
+        h->peak_used = h->used;
+    }
+
+    return 0;
+}
+
+/**
+ * heap_realloc() - realloc() on a heap
+ *
+ * Copies with the caller's locking held; callers that must not copy inside
+ * their lock use heap_resize() and fall back to alloc/copy/free themselves.
+ */
+void *heap_realloc(struct heap *h, void *ptr, size_t size)
+{
+    void *n;
+    size_t cur;
+
+    if (!ptr) {
+        return heap_alloc(h, size);
+    }
+    if (size == 0u) {
+        heap_free(h, ptr);
+        return NULL;
+    }
+    if (heap_resize(h, ptr, size) == 0) {
+        return ptr;
+    }
+
+    n = heap_alloc(h, size);
+    if (n) {
+        cur = heap_usable_size(ptr);
+        memcpy(n, ptr, cur < size ? cur : size);
+        heap_free(h, ptr);
+    }
+
+    return n;
+}
+
+size_t heap_usable_size(const void *ptr)
+{
+    return ptr ? block_size(ptr_to_block(ptr)) : 0u;
+}
+
+/**
+ * heap_stats() - Fill a snapshot of the heap
+ * @h: Heap
+ * @st: Result
+ *
+ * Walks every block, so unlike the allocation paths it takes time linear in
+ * the number of blocks. Meant for diagnostics.
+ */
+void heap_stats(const struct heap *h, struct heap_stats *st)
+{
+    const struct heap_block *b;
+
+    memset(st, 0, sizeof(*st));
+    st->size = h->size;
+    st->used = h->used;
+    st->peak_used = h->peak_used;
+    st->used_blocks = h->used_blocks;
+    st->fails = h->fails;
+
+    for (b = h->base; b && block_size(b) != 0u; b = block_next(b)) {
+        if (block_is_free(b)) {
+            st->free += block_size(b);
+            st->free_blocks++;
+            if (block_size(b) > st->largest_free) {
+                st->largest_free = block_size(b);
+            }
+        }
+    }
+
+    if (st->free != 0u) {
+        st->frag_permille = 1000u - (unsigned)((st->largest_free * 1000u) / st->free);
+    }
+}
+
+/**
+ * heap_check() - Verify the heap structure
+ * @h: Heap
+ *
+ * Checks the physical chain, that no two free blocks touch, that every free
+ * block sits on the list its size maps to and that the bitmaps and counters
+ * agree. Linear time; for tests and debugging.
+ *
+ * Return: 0 if consistent, a negative code naming the first failed check.
+ */
+int heap_check(const struct heap *h)
+{
+    const struct heap_block *b, *prev = NULL;
+    size_t used = 0u, used_blocks = 0u, free_blocks = 0u, listed = 0u;
+    unsigned fl, sl, bfl, bsl;
+
+    if (!h->base) {
+        return -1;
+    }
+
+    for (b = h->base; block_size(b) != 0u; b = block_next(b)) {
+        if (b->prev_phys != prev || (b->size & (HEAP_ALIGN - 2u)) != 0u) {
+            return -2;
+        }
+        if (block_is_free(b)) {
+            if (prev && block_is_free(prev)) {
+                return -3;
+            }
+            free_blocks++;
+        } else {
+            used += block_size(b);
+            used_blocks++;
+        }
+        prev = b;
+    }
+    if (b->prev_phys != prev || block_is_free(b) ||
+        (char *)b + HEAP_OVERHEAD != (char *)h->base + h->size) {
+        return -4;
+    }
+    if (used != h->used || used_blocks != h->used_blocks) {
+        return -5;
+    }
+
+    for (fl = 0u; fl < HEAP_FL_COUNT; fl++) {
+        if (((h->fl_bitmap >> fl) & 1u) != (h->sl_bitmap[fl] != 0u)) {
+            return -6;
+        }
+        for (sl = 0u; sl < HEAP_SL_COUNT; sl++) {
+            if (((h->sl_bitmap[fl] >> sl) & 1u) != (h->free[fl][sl] != NULL)) {
+                return -7;
+            }
+            for (b = h->free[fl][sl]; b; b = b->next_free) {
+                mapping_insert(block_size(b), &bfl, &bsl);
+                if (!block_is_free(b) || bfl != fl || bsl != sl ||
+                    (b->next_free && b->next_free->prev_free != b)) {
+                    return -8;
+                }
+                listed++;
+            }
+        }
+    }
+
+    return listed == free_blocks ? 0 : -9;
+}
@@ -0,0 +1,81 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Two-level segregated fit (TLSF) allocator.
+ *
+ * Free blocks live on one of HEAP_FL_COUNT x HEAP_SL_COUNT lists: the first
+ * level splits sizes by power of two, the second level splits each power of
+ * two into HEAP_SL_COUNT equal ranges. Two bitmaps record which lists are
+ * non-empty, so finding a fitting block is a couple of count-leading/trailing
+ * zero instructions and malloc/free/memalign run in constant time whatever the
+ * heap looks like. Neighbouring free blocks are merged on free.
+ *
+ * The allocator is plain C with no kernel or target dependency: it manages
+ * whatever memory heap_init() is given and does no locking of its own. The
+ * firmware instance sits on the linker's .heap region (portable_libc.c);
+ * tools/heap_bench.c builds the same file on the host.
+ */
+
+#define HEAP_ALIGN_LOG2         4u                      /* 16-byte payloads, as AAPCS64 expects of malloc() */
+#define HEAP_ALIGN              (1u << HEAP_ALIGN_LOG2)
+#define HEAP_SL_LOG2            5u                      /* 32 second-level lists per power of two */
+#define HEAP_SL_COUNT           (1u << HEAP_SL_LOG2)
+#define HEAP_FL_SHIFT           (HEAP_SL_LOG2 + HEAP_ALIGN_LOG2)
+#define HEAP_FL_MAX_LOG2        32u                     /* Largest block is just under 4 GiB */
+#define HEAP_FL_COUNT           (HEAP_FL_MAX_LOG2 - HEAP_FL_SHIFT + 1u)
+#define HEAP_OVERHEAD           16u                     /* Header in front of every block */
+
+struct heap_block;
+
+struct heap {
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[HEAP_FL_COUNT];
+    struct heap_block *free[HEAP_FL_COUNT][HEAP_SL_COUNT];
+    void *base;
+    size_t size;
+    size_t used;                /* Payload bytes handed out */
+    size_t peak_used;
+    size_t used_blocks;
+    unsigned long fails;        /* Requests that found no block */
+};
+
+/**
+ * struct heap_stats - Snapshot returned by heap_stats()
+ * @size: Bytes managed, headers included
+ * @used: Payload bytes in allocated blocks
+ * @peak_used: High-water mark of @used
+ * @free: Payload bytes in free blocks
+ * @largest_free: Payload bytes in the largest free block
+ * @used_blocks: Allocated blocks
+ * @free_blocks: Free blocks
+ * @fails: Allocations that returned NULL
+ * @frag_permille: 1000 * (1 - largest_free / free); 0 when the free space
+ *                 is one block, approaching 1000 as it shatters
+ */
+struct heap_stats {
+    size_t size;
+    size_t used;
+    size_t peak_used;
+    size_t free;
+    size_t largest_free;
+    size_t used_blocks;
+    size_t free_blocks;
+    unsigned long fails;
+    unsigned frag_permille;
+};
+
+int heap_init(struct heap *h, void *mem, size_t size);
+void *heap_alloc(struct heap *h, size_t size);
+void *heap_memalign(struct heap *h, size_t align, size_t size);
+void heap_free(struct heap *h, void *ptr);
+int heap_resize(struct heap *h, void *ptr, size_t size);
+void *heap_realloc(struct heap *h, void *ptr, size_t size);
+size_t heap_usable_size(const void *ptr);
+void heap_stats(const struct heap *h, struct heap_stats *st);
+int heap_check(const struct heap *h);
+
+#endif /* HEAP_H */
@@ -32,26 +32,30 @@
 /* NAT translation table */
 static struct nat_entry nat_table[NAT_TABLE_SIZE];
 
-/* Hash table for fast reverse lookup (wan_port -> table index) */
-#define NAT_HASH_SIZE 128  /* Must be power of 2 */
-static s8 nat_hash_table[NAT_HASH_SIZE];  /* -1 = empty, >=0 = index into nat_table */
+/* Inbound lookup: WAN port -> index into nat_table, -1 = unused */
+static s16 nat_port_map[NAT_PORT_RANGE_END - NAT_PORT_RANGE_START + 1];
 
 /* NAT statistics */
 static struct nat_stats nat_statistics;
 
-/* ARP cache table */
+/* Next port to allocate (round-robin) */
+static u16 next_port = NAT_PORT_RANGE_START;
+
+/* ARP cache table, chained per hash bucket through arp_entry.hash_next */
 static struct arp_entry arp_table[ARP_TABLE_SIZE];
+static s8 arp_hash_table[ARP_HASH_SIZE];  /* -1 = empty, >=0 = index into arp_table */
 
 /* NAT configuration */
 static struct nat_config nat_cfg = {
     .lan_ip = {192, 168, 1, 1},
     .wan_ip = {10, 3, 5, 99},
-    .port_range_start = 20000,
-    .port_range_end = 30000
+    .port_range_start = NAT_PORT_RANGE_START,
+    .port_range_end = NAT_PORT_RANGE_END,
+    .mapping = NAT_DEFAULT_MAPPING
 };
 
-/* Next port to allocate (round-robin) */
-static u16 next_port = 20000;
+/* Bumped on every state change that invalidates cached forwarding actions */
+static u32 nat_state_gen = 1;
 
 /* Forward declarations */
 static struct nat_entry *nat_find_entry(u8 protocol, const u8 lan_ip[4],
@@ -59,13 +63,12 @@ static struct nat_entry *nat_find_entry(u8 protocol, const u8 lan_ip[4],
                                         u16 dst_port);
 static struct nat_entry *nat_find_reverse_entry(u8 protocol, u16 wan_port,
                                                 const u8 src_ip[4], u16 src_port);
+static int nat_port_session(u8 protocol, u16 wan_port);
 static struct nat_entry *nat_alloc_entry(void);
 static u16 nat_alloc_port(void);
 static u32 get_tick_count(void);
 static bool ip_equal(const u8 ip1[4], const u8 ip2[4]);
-static inline u8 nat_hash(u16 wan_port);
-static void nat_hash_add(u16 wan_port, int table_index);
-static void nat_hash_remove(u16 wan_port);
+static void nat_generation_bump(void);
 
 /**
  * nat_init() - Initialize NAT subsystem
@@ -75,15 +78,22 @@ void nat_init(void)
     memset(nat_table, 0, sizeof(nat_table));
     memset(&nat_statistics, 0, sizeof(nat_statistics));
     memset(arp_table, 0, sizeof(arp_table));
-    memset(nat_hash_table, -1, sizeof(nat_hash_table));  /* Initialize hash table to empty */
+    memset(arp_hash_table, -1, sizeof(arp_hash_table));
+    for (int i = 0; i < ARP_TABLE_SIZE; i++) {
+        arp_table[i].hash_next = -1;
+    }
+    memset(nat_port_map, -1, sizeof(nat_port_map));
     next_port = nat_cfg.port_range_start;
+    nat_generation_bump();
 
     NAT_LOG("[NAT] Initialized: LAN=%d.%d.%d.%d WAN=%d.%d.%d.%d\n",
             nat_cfg.lan_ip[0], nat_cfg.lan_ip[1],
             nat_cfg.lan_ip[2], nat_cfg.lan_ip[3],
             nat_cfg.wan_ip[0], nat_cfg.wan_ip[1],
             nat_cfg.wan_ip[2], nat_cfg.wan_ip[3]);
-    NAT_LOG("[NAT] Hash table initialized with %d buckets\n", NAT_HASH_SIZE);
+    NAT_LOG("[NAT] %d sessions, %s mapping\n",
+            NAT_TABLE_SIZE,
+            nat_cfg.mapping == NAT_MAPPING_FULL_CONE ? "full-cone" : "symmetric");
     ARP_LOG("[ARP] Cache initialized with %d entries\n", ARP_TABLE_SIZE);
 }
 
@@ -94,6 +104,7 @@ void nat_configure(const u8 lan_ip[4], const u8 wan_ip[4])
 {
     memcpy(nat_cfg.lan_ip, lan_ip, 4);
     memcpy(nat_cfg.wan_ip, wan_ip, 4);
+    nat_generation_bump();
 
     NAT_LOG("[NAT] Reconfigured: LAN=%d.%d.%d.%d WAN=%d.%d.%d.%d\n",
             nat_cfg.lan_ip[0], nat_cfg.lan_ip[1],
@@ -102,6 +113,31 @@ void nat_configure(const u8 lan_ip[4], const u8 wan_ip[4])
             nat_cfg.wan_ip[2], nat_cfg.wan_ip[3]);
 }
 
+/**
+ * nat_set_mapping() - Select the mapping/filtering behaviour
+ *
+ * Existing sessions were created under the other rules, so they are flushed.
+ */
+void nat_set_mapping(nat_mapping_t mapping)
+{
+    if (nat_cfg.mapping == mapping) {
+        return;
+    }
+
+    nat_cfg.mapping = mapping;
+    memset(nat_table, 0, sizeof(nat_table));
+    memset(nat_port_map, -1, sizeof(nat_port_map));
+    nat_generation_bump();
+}
+
+/**
+ * nat_get_mapping() - Get the active mapping/filtering behaviour
+ */
+nat_mapping_t nat_get_mapping(void)
+{
+    return (nat_mapping_t)nat_cfg.mapping;
+}
+
 /**
  * nat_translate_outbound() - Perform outbound NAT (LAN -> WAN)
  */
@@ -149,6 +185,11 @@ int nat_translate_outbound(u8 protocol, const u8 lan_ip[4], u16 lan_port,
 
     /* Allocate WAN port */
     u16 allocated_port = nat_alloc_port();
+    if (allocated_port == 0) {
+        nat_statistics.table_full++;
+        printf("[NAT] ERROR: WAN ports exhausted\n");
+        return -1;
+    }
 
     /* Calculate table index */
     int table_idx = (int)(entry - nat_table);
@@ -164,8 +205,8 @@ int nat_translate_outbound(u8 protocol, const u8 lan_ip[4], u16 lan_port,
     entry->last_activity = current_time;
     entry->timeout_sec = timeout;
 
-    /* Add to hash table for fast reverse lookup */
-    nat_hash_add(allocated_port, table_idx);
+    /* Publish in the direct-indexed port map for inbound lookup */
+    nat_port_map[allocated_port - NAT_PORT_RANGE_START] = (s16)table_idx;
 
     *wan_port = allocated_port;
     nat_statistics.translations_out++;
@@ -224,8 +265,8 @@ int nat_cleanup_expired(u32 current_ticks)
         u32 age_sec = current_sec - entry_sec;
 
         if (age_sec >= nat_table[i].timeout_sec) {
-            /* Remove from hash table before marking inactive */
-            nat_hash_remove(nat_table[i].wan_port);
+            /* Unpublish from the port map before marking inactive */
+            nat_port_map[nat_table[i].wan_port - NAT_PORT_RANGE_START] = -1;
 
             nat_table[i].active = false;
             removed++;
@@ -234,6 +275,7 @@ int nat_cleanup_expired(u32 current_ticks)
     }
 
     if (removed > 0) {
+        nat_generation_bump();
         NAT_LOG("[NAT] Cleaned up %d expired entries\n", removed);
     }
 
@@ -261,6 +303,7 @@ void nat_reset_stats(void)
  */
 void nat_print_table(void)
 {
+    const struct nat_stats *stats;
     int active_count = 0;
 
     printf("[NAT] Translation Table:\n");
@@ -268,13 +311,15 @@ void nat_print_table(void)
            "Idx", "Proto", "LAN", "Destination", "Timeout");
 
     for (int i = 0; i < NAT_TABLE_SIZE; i++) {
-        if (!nat_table[i].active) {
+        const struct nat_entry *e = &nat_table[i];
+
+        if (!e->active) {
             continue;
         }
 
         active_count++;
         const char *proto_str;
-        switch (nat_table[i].protocol) {
+        switch (e->protocol) {
             case NAT_PROTO_ICMP: proto_str = "ICMP"; break;
             case NAT_PROTO_TCP:  proto_str = "TCP"; break;
             case NAT_PROTO_UDP:  proto_str = "UDP"; break;
@@ -283,20 +328,19 @@ void nat_print_table(void)
 
         printf("%-4d %-6s %d.%d.%d.%d:%-5u %d.%d.%d.%d:%-5u %-8us\n",
                i, proto_str,
-               nat_table[i].lan_ip[0], nat_table[i].lan_ip[1],
-               nat_table[i].lan_ip[2], nat_table[i].lan_ip[3],
-               nat_table[i].lan_port,
-               nat_table[i].dst_ip[0], nat_table[i].dst_ip[1],
-               nat_table[i].dst_ip[2], nat_table[i].dst_ip[3],
-               nat_table[i].dst_port,
-               nat_table[i].timeout_sec);
+               e->lan_ip[0], e->lan_ip[1], e->lan_ip[2], e->lan_ip[3],
+               e->lan_port,
+               e->dst_ip[0], e->dst_ip[1], e->dst_ip[2], e->dst_ip[3],
+               e->dst_port,
+               e->timeout_sec);
     }
 
+    stats = nat_get_stats();
     printf("Active entries: %d/%d\n", active_count, NAT_TABLE_SIZE);
     printf("Stats: Out=%u In=%u TableFull=%u NoMatch=%u Timeouts=%u\n",
-           nat_statistics.translations_out, nat_statistics.translations_in,
-           nat_statistics.table_full, nat_statistics.no_match,
-           nat_statistics.timeouts);
+           stats->translations_out, stats->translations_in,
+           stats->table_full, stats->no_match,
+           stats->timeouts);
 }
 
 /**
@@ -318,6 +362,39 @@ bool nat_is_wan_ip(const u8 ip[4])
     return ip_equal(ip, nat_cfg.wan_ip);
 }
 
+/**
+ * nat_generation() - Get the NAT/ARP state generation counter
+ */
+u32 nat_generation(void)
+{
+    return nat_state_gen;
+}
+
+/**
+ * nat_session_index() - Find the table slot of an active NAT session
+ */
+int nat_session_index(u8 protocol, u16 wan_port)
+{
+    return nat_port_session(protocol, wan_port);
+}
+
+/**
+ * nat_session_touch() - Refresh the activity timestamp of a session
+ */
+void nat_session_touch(int index, bool outbound)
+{
+    if (index < 0 || index >= NAT_TABLE_SIZE) {
+        return;
+    }
+
+    nat_table[index].last_activity = get_tick_count();
+    if (outbound) {
+        nat_statistics.translations_out++;
+    } else {
+        nat_statistics.translations_in++;
+    }
+}
+
 /* ========== Internal Helper Functions ========== */
 
 /**
@@ -328,61 +405,73 @@ static struct nat_entry *nat_find_entry(u8 protocol, const u8 lan_ip[4],
                                         u16 dst_port)
 {
     for (int i = 0; i < NAT_TABLE_SIZE; i++) {
-        if (!nat_table[i].active) {
+        struct nat_entry *e = &nat_table[i];
+
+        if (!e->active) {
             continue;
         }
 
-        if (nat_table[i].protocol == protocol &&
-            ip_equal(nat_table[i].lan_ip, lan_ip) &&
-            nat_table[i].lan_port == lan_port &&
-            ip_equal(nat_table[i].dst_ip, dst_ip) &&
-            nat_table[i].dst_port == dst_port) {
-            return &nat_table[i];
+        if (e->protocol != protocol ||
+            !ip_equal(e->lan_ip, lan_ip) ||
+            e->lan_port != lan_port) {
+            continue;
+        }
+
+        /* Endpoint-independent mapping: one mapping serves every peer */
+        if (nat_cfg.mapping == NAT_MAPPING_FULL_CONE ||
+            (ip_equal(e->dst_ip, dst_ip) && e->dst_port == dst_port)) {
+            return e;
         }
     }
 
     return NULL;
 }
 
+/**
+ * nat_port_session() - Direct-indexed lookup of the session owning a WAN port
+ *
+ * Returns: Index into nat_table, or -1 if the port is unused
+ */
+static int nat_port_session(u8 protocol, u16 wan_port)
+{
+    s16 idx;
+
+    if (wan_port < NAT_PORT_RANGE_START || wan_port > NAT_PORT_RANGE_END) {
+        return -1;
+    }
+
+    idx = nat_port_map[wan_port - NAT_PORT_RANGE_START];
+    if (idx < 0 || nat_table[idx].protocol != protocol) {
+        return -1;
+    }
+
+    return idx;
+}
+
 /**
  * nat_find_reverse_entry() - Find entry for inbound translation
- * Uses hash table for O(1) lookup instead of O(N) linear search
+ *
+ * A single array lookup by WAN port. With endpoint-independent filtering
+ * any remote endpoint is accepted; otherwise the source must match the
+ * peer the mapping was created for.
  */
 static struct nat_entry *nat_find_reverse_entry(u8 protocol, u16 wan_port,
                                                 const u8 src_ip[4], u16 src_port)
 {
-    /* Hash table lookup - O(1) average case */
-    u8 hash_idx = nat_hash(wan_port);
-    s8 table_idx = nat_hash_table[hash_idx];
+    struct nat_entry *entry;
+    int idx = nat_port_session(protocol, wan_port);
 
-    /* Check if hash bucket is empty */
-    if (table_idx < 0) {
+    if (idx < 0) {
         return NULL;
     }
 
-    /* Verify the entry matches (handle hash collisions) */
-    struct nat_entry *entry = &nat_table[table_idx];
-
-    if (entry->active &&
-        entry->protocol == protocol &&
-        entry->wan_port == wan_port &&
-        ip_equal(entry->dst_ip, src_ip) &&
-        entry->dst_port == src_port) {
+    entry = &nat_table[idx];
+    if (nat_cfg.mapping == NAT_MAPPING_FULL_CONE) {
         return entry;
     }
 
-    /* Hash collision - fall back to linear search (rare) */
-    for (int i = 0; i < NAT_TABLE_SIZE; i++) {
-        if (!nat_table[i].active) {
-            continue;
-        }
-
-        if (nat_table[i].protocol == protocol &&
-            nat_table[i].wan_port == wan_port &&
-            ip_equal(nat_table[i].dst_ip, src_ip) &&
-            nat_table[i].dst_port == src_port) {
-            return &nat_table[i];
-        }
+    if (ip_equal(entry->dst_ip, src_ip) && entry->dst_port == src_port) {
+        return entry;
     }
 
     return NULL;
@@ -393,7 +482,6 @@ static struct nat_entry *nat_find_reverse_entry(u8 protocol, u16 wan_port,
  */
 static struct nat_entry *nat_alloc_entry(void)
 {
-    /* First pass: find completely free entry */
     for (int i = 0; i < NAT_TABLE_SIZE; i++) {
         if (!nat_table[i].active) {
             return &nat_table[i];
@@ -406,17 +494,29 @@ static struct nat_entry *nat_alloc_entry(void)
 
 /**
  * nat_alloc_port() - Allocate next available WAN port
+ *
+ * Ports still held by a live session are skipped after wrap-around.
+ *
+ * Returns: Allocated port, or 0 if the whole range is in use
  */
 static u16 nat_alloc_port(void)
 {
-    u16 port = next_port++;
+    u32 span = (u32)nat_cfg.port_range_end - nat_cfg.port_range_start + 1;
 
-    /* Wrap around if we reach the end */
-    if (next_port > nat_cfg.port_range_end) {
-        next_port = nat_cfg.port_range_start;
+    for (u32 tries = 0; tries < span; tries++) {
+        u16 port = next_port++;
+
+        /* Wrap around if we reach the end */
+        if (next_port > nat_cfg.port_range_end || next_port < nat_cfg.port_range_start) {
+            next_port = nat_cfg.port_range_start;
+        }
+
+        if (nat_port_map[port - NAT_PORT_RANGE_START] < 0) {
+            return port;
+        }
     }
 
-    return port;
+    return 0;
 }
 
 /**
@@ -438,59 +538,261 @@ static bool ip_equal(const u8 ip1[4], const u8 ip2[4])
             ip1[2] == ip2[2] && ip1[3] == ip2[3]);
 }
 
+/**
+ * nat_generation_bump() - Invalidate all cached forwarding actions
+ *
+ * Zero is reserved for "never filled" flow cache slots, so skip it on wrap.
+ */
+static void nat_generation_bump(void)
+{
+    if (++nat_state_gen == 0) {
+        nat_state_gen = 1;
+    }
+}
+
 /* ========== ARP Cache Functions ========== */
 
+/*
+ * Neighbour state machine
+ *
+ *   INCOMPLETE --reply--> REACHABLE --ARP_REACHABLE_TIME--> STALE
+ *   STALE --used recently--> PROBE --reply--> REACHABLE
+ *   PROBE --ARP_PROBE_MAX unanswered--> removed (pinned: INCOMPLETE)
+ *   STALE --unused for ARP_TIMEOUT--> removed
+ *
+ * STALE and PROBE entries remain usable for forwarding, so a neighbour that
+ * keeps answering is refreshed in the background without ever missing on
+ * the hot path. Static entries never change state.
+ */
+
 /**
- * arp_cache_add() - Add or update an ARP cache entry
+ * arp_hash() - Compute bucket index for an IPv4 address
  */
-void arp_cache_add(const u8 ip[4], const u8 mac[6])
+static inline u8 arp_hash(u32 ip)
+{
+    return (u8)((ip * 0x9e3779b1u) >> 24) & (ARP_HASH_SIZE - 1);
+}
+
+/**
+ * arp_ip_to_u32() - Pack a byte-array IPv4 address into host order
+ */
+static inline u32 arp_ip_to_u32(const u8 ip[4])
+{
+    return ((u32)ip[0] << 24) | ((u32)ip[1] << 16) | ((u32)ip[2] << 8) | ip[3];
+}
+
+/**
+ * arp_usable() - Check whether an entry carries a MAC usable for forwarding
+ */
+static inline bool arp_usable(const struct arp_entry *entry)
+{
+    return entry->state == ARP_STATE_REACHABLE ||
+           entry->state == ARP_STATE_STALE ||
+           entry->state == ARP_STATE_PROBE;
+}
+
+/**
+ * arp_find() - Find the entry for an address via its hash chain
+ */
+static struct arp_entry *arp_find(u32 ip)
+{
+    s8 idx = arp_hash_table[arp_hash(ip)];
+
+    while (idx >= 0) {
+        if (arp_table[idx].ip_addr == ip) {
+            return &arp_table[idx];
+        }
+        idx = arp_table[idx].hash_next;
+    }
+
+    return NULL;
+}
+
+/**
+ * arp_unlink() - Remove an entry from its hash chain and free the slot
+ */
+static void arp_unlink(struct arp_entry *entry)
+{
+    s8 self = (s8)(entry - arp_table);
+    s8 *link = &arp_hash_table[arp_hash(entry->ip_addr)];
+
+    while (*link >= 0) {
+        if (*link == self) {
+            *link = entry->hash_next;
+            break;
+        }
+        link = &arp_table[*link].hash_next;
+    }
+
+    entry->active = false;
+    entry->state = ARP_STATE_FREE;
+    entry->flags = 0;
+    entry->hash_next = -1;
+}
+
+/**
+ * arp_alloc() - Claim a slot for a new neighbour and link it into the hash
+ *
+ * Unresolved entries are evicted before resolved ones, oldest first.
+ * Static and pinned entries are never evicted.
+ *
+ * Returns: New entry, or NULL if every slot is static/pinned
+ */
+static struct arp_entry *arp_alloc(u32 ip, u32 current_time)
 {
     struct arp_entry *entry = NULL;
-    u32 current_time = get_tick_count();
-    int i;
+    struct arp_entry *victim = NULL;
+    u8 bucket;
+
+    for (int i = 0; i < ARP_TABLE_SIZE; i++) {
+        struct arp_entry *e = &arp_table[i];
 
-    /* Check if entry already exists */
-    for (i = 0; i < ARP_TABLE_SIZE; i++) {
-        if (arp_table[i].active && ip_equal(arp_table[i].ip, ip)) {
-            entry = &arp_table[i];
+        if (!e->active) {
+            entry = e;
             break;
         }
+        if (e->flags & (ARP_FLAG_STATIC | ARP_FLAG_PINNED)) {
+            continue;
+        }
+        if (victim == NULL ||
+            (e->state == ARP_STATE_INCOMPLETE && victim->state != ARP_STATE_INCOMPLETE) ||
+            ((e->state == ARP_STATE_INCOMPLETE) == (victim->state == ARP_STATE_INCOMPLETE) &&
+             (s32)(e->last_update - victim->last_update) < 0)) {
+            victim = e;
+        }
     }
 
-    /* If not found, allocate new entry */
     if (entry == NULL) {
-        for (i = 0; i < ARP_TABLE_SIZE; i++) {
-            if (!arp_table[i].active) {
-                entry = &arp_table[i];
-                break;
-            }
+        if (victim == NULL) {
+            return NULL;
+        }
+        ARP_LOG("[ARP] Cache full, replacing oldest entry\n");
+        if (arp_usable(victim)) {
+            nat_generation_bump();
         }
+        arp_unlink(victim);
+        entry = victim;
     }
 
-    /* If table is full, replace oldest entry */
-    if (entry == NULL) {
-        u32 oldest_time = current_time;
-        int oldest_idx = 0;
+    memset(entry, 0, sizeof(*entry));
+    entry->active = true;
+    entry->state = ARP_STATE_INCOMPLETE;
+    entry->ip_addr = ip;
+    entry->ip[0] = (u8)(ip >> 24);
+    entry->ip[1] = (u8)(ip >> 16);
+    entry->ip[2] = (u8)(ip >> 8);
+    entry->ip[3] = (u8)ip;
+    entry->last_update = current_time;
+    entry->last_used = current_time;
 
-        for (i = 0; i < ARP_TABLE_SIZE; i++) {
-            if (arp_table[i].last_update < oldest_time) {
-                oldest_time = arp_table[i].last_update;
-                oldest_idx = i;
-            }
+    bucket = arp_hash(ip);
+    entry->hash_next = arp_hash_table[bucket];
+    arp_hash_table[bucket] = (s8)(entry - arp_table);
+
+    return entry;
+}
+
+/**
+ * arp_cache_add_u32() - Add or update an ARP cache entry
+ */
+void arp_cache_add_u32(u32 ip, const u8 mac[6])
+{
+    u32 current_time = get_tick_count();
+    struct arp_entry *entry = arp_find(ip);
+
+    if (entry == NULL) {
+        entry = arp_alloc(ip, current_time);
+        if (entry == NULL) {
+            return;
         }
-        entry = &arp_table[oldest_idx];
-        ARP_LOG("[ARP] Cache full, replacing oldest entry\n");
     }
 
-    /* Update entry */
-    entry->active = true;
-    memcpy(entry->ip, ip, 4);
+    /* Static entries are authoritative and never overwritten by the wire */
+    if (entry->flags & ARP_FLAG_STATIC) {
+        return;
+    }
+
+    /* Newly resolved neighbour or changed MAC invalidates cached flows */
+    if (!arp_usable(entry) || memcmp(entry->mac, mac, 6) != 0) {
+        nat_generation_bump();
+    }
+
+    entry->state = ARP_STATE_REACHABLE;
+    entry->probes = 0;
     memcpy(entry->mac, mac, 6);
     entry->last_update = current_time;
 
-    ARP_LOG("[ARP] Learned: %d.%d.%d.%d -> %02x:%02x:%02x:%02x:%02x:%02x\n",
-            ip[0], ip[1], ip[2], ip[3],
-            mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    ARP_LOG("[ARP] Learned: %d.%d.%d.%d -> %02x:%02x:%02x:%02x:%02x:%02x\n",
+            entry->ip[0], entry->ip[1], entry->ip[2], entry->ip[3],
+            mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+/**
+ * arp_cache_add() - Add or update an ARP cache entry
+ */
+void arp_cache_add(const u8 ip[4], const u8 mac[6])
+{
+    arp_cache_add_u32(arp_ip_to_u32(ip), mac);
+}
+
+/**
+ * arp_cache_add_static() - Install a permanent ARP entry
+ */
+int arp_cache_add_static(u32 ip, const u8 mac[6])
+{
+    struct arp_entry *entry = arp_find(ip);
+
+    if (entry == NULL) {
+        entry = arp_alloc(ip, get_tick_count());
+        if (entry == NULL) {
+            return -1;
+        }
+    }
+
+    if (!arp_usable(entry) || memcmp(entry->mac, mac, 6) != 0) {
+        nat_generation_bump();
+    }
+
+    entry->flags = ARP_FLAG_STATIC;
+    entry->state = ARP_STATE_REACHABLE;
+    entry->probes = 0;
+    memcpy(entry->mac, mac, 6);
+    entry->last_update = get_tick_count();
+    return 0;
+}
+
+/**
+ * arp_cache_pin() - Keep a neighbour resolved for as long as it exists
+ */
+int arp_cache_pin(u32 ip)
+{
+    struct arp_entry *entry = arp_find(ip);
+
+    if (entry == NULL) {
+        entry = arp_alloc(ip, get_tick_count());
+        if (entry == NULL) {
+            return -1;
+        }
+    }
+
+    entry->flags |= ARP_FLAG_PINNED;
+    return 0;
+}
+
+/**
+ * arp_cache_lookup_u32() - Look up MAC address for an IP
+ */
+bool arp_cache_lookup_u32(u32 ip, u8 mac[6])
+{
+    struct arp_entry *entry = arp_find(ip);
+
+    if (entry == NULL || !arp_usable(entry)) {
+        return false;
+    }
+
+    entry->last_used = get_tick_count();
+    memcpy(mac, entry->mac, 6);
+    return true;
 }
 
 /**
@@ -498,37 +800,142 @@ void arp_cache_add(const u8 ip[4], const u8 mac[6])
  */
 bool arp_cache_lookup(const u8 ip[4], u8 mac[6])
 {
-    for (int i = 0; i < ARP_TABLE_SIZE; i++) {
-        if (arp_table[i].active && ip_equal(arp_table[i].ip, ip)) {
-            memcpy(mac, arp_table[i].mac, 6);
-            return true;
+    return arp_cache_lookup_u32(arp_ip_to_u32(ip), mac);
+}
+
+/**
+ * arp_cache_index_u32() - Get the slot of a usable entry
+ */
+int arp_cache_index_u32(u32 ip)
+{
+    struct arp_entry *entry = arp_find(ip);
+
+    if (entry == NULL || !arp_usable(entry)) {
+        return -1;
+    }
+    return (int)(entry - arp_table);
+}
+
+/**
+ * arp_cache_touch() - Mark an entry as recently used
+ */
+void arp_cache_touch(int index)
+{
+    if (index >= 0 && index < ARP_TABLE_SIZE) {
+        arp_table[index].last_used = get_tick_count();
+    }
+}
+
+/**
+ * arp_cache_resolve_due() - Rate-limit ARP requests for an unresolved neighbour
+ */
+bool arp_cache_resolve_due(u32 ip)
+{
+    u32 current_time = get_tick_count();
+    struct arp_entry *entry = arp_find(ip);
+
+    if (entry == NULL) {
+        entry = arp_alloc(ip, current_time);
+        if (entry == NULL) {
+            return false;
         }
+    } else if (arp_usable(entry)) {
+        return false;
+    } else if (entry->probes != 0 &&
+               (current_time - entry->last_request) < ARP_RESOLVE_INTERVAL) {
+        return false;
+    }
+
+    entry->last_request = current_time;
+    if (entry->probes < 0xff) {
+        entry->probes++;
     }
-    return false;
+    return true;
 }
 
 /**
- * arp_cache_cleanup() - Remove expired ARP entries
+ * arp_cache_refresh() - Run the neighbour state machine
  */
-int arp_cache_cleanup(u32 current_ticks)
+int arp_cache_refresh(u32 current_ticks, arp_probe_fn probe)
 {
     int removed = 0;
-    u32 current_sec = current_ticks / 1000;  /* Convert to seconds */
+    bool usable_removed = false;
 
     for (int i = 0; i < ARP_TABLE_SIZE; i++) {
-        if (!arp_table[i].active) {
+        struct arp_entry *e = &arp_table[i];
+        u32 age_sec;
+        bool remove = false;
+
+        if (!e->active || (e->flags & ARP_FLAG_STATIC)) {
             continue;
         }
 
-        u32 entry_sec = arp_table[i].last_update / 1000;
-        u32 age_sec = current_sec - entry_sec;
+        age_sec = (current_ticks - e->last_update) / 1000;
 
-        if (age_sec >= ARP_TIMEOUT) {
-            arp_table[i].active = false;
+        switch (e->state) {
+            case ARP_STATE_REACHABLE:
+                if (age_sec >= ARP_REACHABLE_TIME) {
+                    e->state = ARP_STATE_STALE;
+                }
+                break;
+
+            case ARP_STATE_STALE:
+                if ((e->flags & ARP_FLAG_PINNED) ||
+                    (current_ticks - e->last_used) / 1000 < ARP_TIMEOUT) {
+                    /* Still in use: confirm it before it can go away */
+                    e->state = ARP_STATE_PROBE;
+                    e->probes = 0;
+                } else if (age_sec >= ARP_TIMEOUT) {
+                    remove = true;
+                }
+                break;
+
+            case ARP_STATE_PROBE:
+                if (e->probes >= ARP_PROBE_MAX) {
+                    if (e->flags & ARP_FLAG_PINNED) {
+                        /* Gateway went silent: fall back to broadcast resolution */
+                        e->state = ARP_STATE_INCOMPLETE;
+                        e->probes = 0;
+                        nat_generation_bump();
+                    } else {
+                        remove = true;
+                    }
+                    break;
+                }
+                e->probes++;
+                e->last_request = current_ticks;
+                if (probe != NULL) {
+                    probe(e->ip_addr, e->mac);
+                }
+                break;
+
+            case ARP_STATE_INCOMPLETE:
+                if (e->flags & ARP_FLAG_PINNED) {
+                    e->last_request = current_ticks;
+                    if (probe != NULL) {
+                        probe(e->ip_addr, NULL);
+                    }
+                } else if (age_sec >= ARP_INCOMPLETE_TIMEOUT) {
+                    remove = true;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        if (remove) {
+            if (arp_usable(e)) {
+                usable_removed = true;
+            }
+            arp_unlink(e);
             removed++;
         }
     }
 
+    if (usable_removed) {
+        nat_generation_bump();
+    }
     if (removed > 0) {
         ARP_LOG("[ARP] Cleaned up %d expired entries\n", removed);
     }
@@ -536,72 +943,43 @@ int arp_cache_cleanup(u32 current_ticks)
     return removed;
 }
 
+/**
+ * arp_cache_cleanup() - Remove expired ARP entries
+ */
+int arp_cache_cleanup(u32 current_ticks)
+{
+    return arp_cache_refresh(current_ticks, NULL);
+}
+
 /**
  * arp_cache_print() - Print ARP cache for debugging
  */
 void arp_cache_print(void)
 {
+    static const char *const state_str[] = {
+        "free", "incomplete", "reachable", "stale", "probe"
+    };
     int active_count = 0;
 
     printf("[ARP] Cache Table:\n");
-    printf("%-4s %-18s %-20s\n", "Idx", "IP Address", "MAC Address");
+    printf("%-4s %-18s %-20s %s\n", "Idx", "IP Address", "MAC Address", "State");
 
     for (int i = 0; i < ARP_TABLE_SIZE; i++) {
-        if (!arp_table[i].active) {
+        const struct arp_entry *e = &arp_table[i];
+
+        if (!e->active) {
             continue;
         }
 
         active_count++;
-        printf("%-4d %d.%d.%d.%d          %02x:%02x:%02x:%02x:%02x:%02x\n",
+        printf("%-4d %d.%d.%d.%d          %02x:%02x:%02x:%02x:%02x:%02x  %s%s\n",
                i,
-               arp_table[i].ip[0], arp_table[i].ip[1],
-               arp_table[i].ip[2], arp_table[i].ip[3],
-               arp_table[i].mac[0], arp_table[i].mac[1],
-               arp_table[i].mac[2], arp_table[i].mac[3],
-               arp_table[i].mac[4], arp_table[i].mac[5]);
+               e->ip[0], e->ip[1], e->ip[2], e->ip[3],
+               e->mac[0], e->mac[1], e->mac[2],
+               e->mac[3], e->mac[4], e->mac[5],
+               (e->flags & ARP_FLAG_STATIC) ? "static" : state_str[e->state],
+               (e->flags & ARP_FLAG_PINNED) ? " (pinned)" : "");
     }
 
     printf("Active entries: %d/%d\n", active_count, ARP_TABLE_SIZE);
 }
-
-/* ========== Hash Table Helper Functions ========== */
-
-/**
- * nat_hash() - Compute hash index for wan_port
- *
- * Uses simple modulo with power-of-2 size for fast computation.
- * Hash collisions are handled by fallback to linear search.
- */
-static inline u8 nat_hash(u16 wan_port)
-{
-    return (u8)(wan_port & (NAT_HASH_SIZE - 1));  /* Fast modulo for power of 2 */
-}
-
-/**
- * nat_hash_add() - Add entry to hash table
- *
- * @wan_port: WAN port number to hash
- * @table_index: Index into nat_table[] for this entry
- *
- * Note: If there's a collision, the new entry overwrites the old one.
- * The old entry can still be found via linear search fallback.
- */
-static void nat_hash_add(u16 wan_port, int table_index)
-{
-    u8 hash_idx = nat_hash(wan_port);
-    nat_hash_table[hash_idx] = (s8)table_index;
-}
-
-/**
- * nat_hash_remove() - Remove entry from hash table
- *
- * @wan_port: WAN port number to remove
- *
- * Note: Only removes if the hash bucket points to an entry with this port.
- * Does not search for collisions.
- */
-static void nat_hash_remove(u16 wan_port)
-{
-    u8 hash_idx = nat_hash(wan_port);
-    nat_hash_table[hash_idx] = -1;
-}
@@ -18,9 +18,23 @@
 #define NAT_TIMEOUT_TCP_EST     300     /* TCP established timeout (seconds) */
 #define NAT_TIMEOUT_TCP_INIT    60      /* TCP initial timeout (seconds) */
 
+/* WAN port range handed out to sessions, indexed directly on inbound lookup */
+#define NAT_PORT_RANGE_START    20000
+#define NAT_PORT_RANGE_END      30000
+
+/* Mapping behaviour used after nat_init() (see nat_mapping_t) */
+#ifndef NAT_DEFAULT_MAPPING
+#define NAT_DEFAULT_MAPPING     NAT_MAPPING_SYMMETRIC
+#endif
+
 /* ARP Table Configuration */
 #define ARP_TABLE_SIZE          32      /* Maximum ARP cache entries */
-#define ARP_TIMEOUT             300     /* ARP entry timeout (seconds) */
+#define ARP_TIMEOUT             300     /* Unused stale entry timeout (seconds) */
+#define ARP_REACHABLE_TIME      30      /* Confirmed entry lifetime before STALE (seconds) */
+#define ARP_PROBE_MAX           3       /* Unanswered unicast probes before removal */
+#define ARP_HASH_SIZE           64      /* Hash buckets, power of 2 */
+#define ARP_RESOLVE_INTERVAL    1000    /* Min ticks between requests per neighbour */
+#define ARP_INCOMPLETE_TIMEOUT  3       /* Unresolved entry lifetime (seconds) */
 
 /* Protocol types */
 typedef enum {
@@ -35,6 +49,12 @@ typedef enum {
     NAT_DIR_INBOUND     /* WAN -> LAN (reverse SNAT) */
 } nat_dir_t;
 
+/* NAT mapping and filtering behaviour (RFC 4787) */
+typedef enum {
+    NAT_MAPPING_SYMMETRIC = 0,  /* Endpoint-dependent mapping and filtering */
+    NAT_MAPPING_FULL_CONE       /* Endpoint-independent mapping and filtering */
+} nat_mapping_t;
+
 /* NAT session entry */
 struct nat_entry {
     bool     active;            /* Entry is in use */
@@ -47,7 +67,7 @@ struct nat_entry {
     /* Translated (WAN side) */
     u16      wan_port;          /* WAN source port (or ICMP ID) */
 
-    /* Destination (for reverse lookup) */
+    /* Destination (for reverse lookup; first peer in full-cone mode) */
     u8       dst_ip[4];         /* Destination IP */
     u16      dst_port;          /* Destination port */
 
@@ -65,12 +85,39 @@ struct nat_stats {
     u32 timeouts;               /* Expired entries */
 };
 
+/* ARP neighbour state */
+typedef enum {
+    ARP_STATE_FREE = 0,
+    ARP_STATE_INCOMPLETE,       /* Request sent, no reply yet */
+    ARP_STATE_REACHABLE,        /* MAC address recently confirmed */
+    ARP_STATE_STALE,            /* MAC address usable, confirmation overdue */
+    ARP_STATE_PROBE             /* MAC address usable, unicast probes in flight */
+} arp_state_t;
+
+/* ARP entry flags */
+#define ARP_FLAG_STATIC         0x01    /* Configured MAC, never aged or replaced */
+#define ARP_FLAG_PINNED         0x02    /* Kept resolved in the background, never evicted */
+
+/**
+ * typedef arp_probe_fn - Transmit an ARP request on behalf of the cache
+ * @ip: Neighbour IP in host byte order
+ * @mac: Last known MAC for a unicast probe, NULL for a broadcast request
+ */
+typedef void (*arp_probe_fn)(u32 ip, const u8 *mac);
+
 /* ARP cache entry */
 struct arp_entry {
     bool     active;            /* Entry is in use */
+    u8       state;             /* arp_state_t */
+    u8       flags;             /* ARP_FLAG_* */
+    s8       hash_next;         /* Next entry in hash chain, -1 = end */
+    u8       probes;            /* Requests sent while unresolved */
+    u32      ip_addr;           /* IP address (host byte order), hash key */
     u8       ip[4];             /* IP address */
     u8       mac[6];            /* MAC address */
-    u32      last_update;       /* Timestamp of last update (in ticks) */
+    u32      last_update;       /* Timestamp of last confirmation (in ticks) */
+    u32      last_used;         /* Timestamp of last forwarding lookup (in ticks) */
+    u32      last_request;      /* Timestamp of last ARP request (in ticks) */
 };
 
 /* NAT configuration structure */
@@ -79,6 +126,7 @@ struct nat_config {
     u8  wan_ip[4];              /* Gateway WAN IP (10.3.5.99) */
     u16 port_range_start;       /* Dynamic port allocation start */
     u16 port_range_end;         /* Dynamic port allocation end */
+    u8  mapping;                /* nat_mapping_t */
 };
 
 /* NAT Initialization and Configuration */
@@ -100,6 +148,23 @@ void nat_init(void);
  */
 void nat_configure(const u8 lan_ip[4], const u8 wan_ip[4]);
 
+/**
+ * nat_set_mapping() - Select the mapping/filtering behaviour
+ * @mapping: NAT_MAPPING_SYMMETRIC or NAT_MAPPING_FULL_CONE
+ *
+ * In full-cone mode one mapping per LAN (protocol, IP, port) serves every
+ * remote endpoint and inbound packets are matched on WAN port alone.
+ * Switching modes flushes all sessions.
+ */
+void nat_set_mapping(nat_mapping_t mapping);
+
+/**
+ * nat_get_mapping() - Get the active mapping/filtering behaviour
+ *
+ * Returns: Current nat_mapping_t
+ */
+nat_mapping_t nat_get_mapping(void);
+
 /* NAT Translation Operations */
 
 /**
@@ -122,8 +187,8 @@ int nat_translate_outbound(u8 protocol, const u8 lan_ip[4], u16 lan_port,
  * nat_translate_inbound() - Perform inbound NAT translation (WAN -> LAN)
  * @protocol: Protocol type (ICMP, TCP, UDP)
  * @wan_port: WAN port/ICMP ID to look up
- * @src_ip: Source IP (must match original dst_ip)
- * @src_port: Source port (must match original dst_port)
+ * @src_ip: Source IP (must match original dst_ip unless full-cone)
+ * @src_port: Source port (must match original dst_port unless full-cone)
  * @lan_ip: Output parameter for original LAN IP
  * @lan_port: Output parameter for original LAN port/ICMP ID
  *
@@ -184,6 +249,42 @@ bool nat_is_lan_ip(const u8 ip[4]);
  */
 bool nat_is_wan_ip(const u8 ip[4]);
 
+/* Flow Cache Support */
+
+/**
+ * nat_generation() - Get the NAT/ARP state generation counter
+ *
+ * The counter is bumped whenever slow-path state that a cached forwarding
+ * decision depends on changes: a NAT session expires, an ARP entry is
+ * learned with a new MAC, or an ARP entry ages out. Cached rewrites that
+ * were recorded under an older generation must be discarded.
+ *
+ * Returns: Current generation (never 0)
+ */
+u32 nat_generation(void);
+
+/**
+ * nat_session_index() - Find the table slot of an active NAT session
+ * @protocol: Protocol type (ICMP, TCP, UDP)
+ * @wan_port: Translated WAN port/ICMP ID of the session
+ *
+ * The returned index stays valid for as long as nat_generation() is
+ * unchanged, since session removal always bumps the generation.
+ *
+ * Returns: Table index on success, -1 if no active session matches
+ */
+int nat_session_index(u8 protocol, u16 wan_port);
+
+/**
+ * nat_session_touch() - Refresh the activity timestamp of a session
+ * @index: Table index returned by nat_session_index()
+ * @outbound: true for LAN -> WAN traffic, false for WAN -> LAN
+ *
+ * Used by the forwarding fast path, which bypasses the translate calls,
+ * to keep established sessions from expiring.
+ */
+void nat_session_touch(int index, bool outbound);
+
 /* ARP Cache Management */
 
 /**
@@ -204,10 +305,92 @@ void arp_cache_add(const u8 ip[4], const u8 mac[6]);
  */
 bool arp_cache_lookup(const u8 ip[4], u8 mac[6]);
 
+/**
+ * arp_cache_add_u32() - Add or update an ARP cache entry
+ * @ip: IP address in host byte order
+ * @mac: MAC address
+ */
+void arp_cache_add_u32(u32 ip, const u8 mac[6]);
+
+/**
+ * arp_cache_lookup_u32() - Look up MAC address for an IP
+ * @ip: IP address in host byte order
+ * @mac: Output buffer for MAC address (6 bytes)
+ *
+ * Returns: true if a resolved entry was found, false otherwise
+ */
+bool arp_cache_lookup_u32(u32 ip, u8 mac[6]);
+
+/**
+ * arp_cache_resolve_due() - Decide whether to send an ARP request now
+ * @ip: Unresolved neighbour in host byte order
+ *
+ * Creates an incomplete entry on first use and allows at most one request
+ * per ARP_RESOLVE_INTERVAL ticks for it afterwards.
+ *
+ * Returns: true if the caller should transmit an ARP request
+ */
+bool arp_cache_resolve_due(u32 ip);
+
+/**
+ * arp_cache_add_static() - Install a permanent ARP entry
+ * @ip: IP address in host byte order
+ * @mac: MAC address
+ *
+ * Returns: 0 on success, -1 if no slot could be claimed
+ */
+int arp_cache_add_static(u32 ip, const u8 mac[6]);
+
+/**
+ * arp_cache_pin() - Keep a neighbour resolved for as long as it exists
+ * @ip: IP address in host byte order (e.g. the default gateway)
+ *
+ * A pinned neighbour is never evicted or aged out. While unresolved it is
+ * re-requested on every arp_cache_refresh() call, and once resolved it is
+ * probed before its confirmation lapses.
+ *
+ * Returns: 0 on success, -1 if no slot could be claimed
+ */
+int arp_cache_pin(u32 ip);
+
+/**
+ * arp_cache_index_u32() - Get the slot of a usable entry
+ * @ip: IP address in host byte order
+ *
+ * The slot stays valid while nat_generation() is unchanged.
+ *
+ * Returns: Slot index, or -1 if the neighbour is not resolved
+ */
+int arp_cache_index_u32(u32 ip);
+
+/**
+ * arp_cache_touch() - Mark an entry as recently used
+ * @index: Slot returned by arp_cache_index_u32()
+ *
+ * Lets forwarding paths that bypass arp_cache_lookup_u32() keep their
+ * neighbour in the background refresh set.
+ */
+void arp_cache_touch(int index);
+
+/**
+ * arp_cache_refresh() - Run the neighbour state machine
+ * @current_ticks: Current system tick count
+ * @probe: Transmit hook for background requests, may be NULL
+ *
+ * Ages REACHABLE entries to STALE, probes STALE entries that are still in
+ * use and removes neighbours that stop answering or fall out of use.
+ * Meant to be called about once per second.
+ *
+ * Returns: Number of entries removed
+ */
+int arp_cache_refresh(u32 current_ticks, arp_probe_fn probe);
+
 /**
  * arp_cache_cleanup() - Remove expired ARP entries
  * @current_ticks: Current system tick count
  *
+ * Same as arp_cache_refresh() without transmitting probes.
+ *
  * Returns: Number of entries removed
  */
 int arp_cache_cleanup(u32 current_ticks);
@@ -679,6 +679,8 @@ int net_send_udp_packet(uchar *ether, struct in_addr dest, int dport,
 /* Processes a received packet */
 void net_process_received_packet(uchar *in_packet, int len);
 void net_register_iface(struct eth_device *dev);
+void net_neigh_refresh(u32 current_ticks);
+int net_neigh_add_gateway(const u8 ip[4], const u8 *mac);
 
 #ifdef CONFIG_NETCONSOLE
 void nc_start(void);
@@ -1,6 +1,7 @@
 #include "includes.h"
 #include "virtio_net.h"
 #include "nat.h"
+#include "amp.h"
 #include <net.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -68,12 +69,29 @@ static struct net_iface net_ifaces[] = {
 /* NAT enabled flag */
 static bool nat_enabled = false;
 
+/* WAN default gateway in host byte order, 0 = none (net_neigh_add_gateway()) */
+static u32 net_wan_gateway;
+
 __attribute__((weak)) void test_net_on_frame(u8 *pkt, int len)
 {
     (void)pkt;
     (void)len;
 }
 
+/*
+ * Transmit on an interface. Normally every interface is a virtio NIC and the
+ * direct call lets LTO inline the TX path; in an AMP image the WAN interface
+ * may be the proxy device that feeds the inter-core ring (amp.c).
+ */
+static inline int net_xmit(struct eth_device *dev, void *pkt, int len)
+{
+#ifdef AMP_CORE_ID
+    return dev->send(dev, pkt, len);
+#else
+    return virtio_net_send(dev, pkt, len);
+#endif
+}
+
 /* Ethernet header */
 struct eth_hdr {
     u8 dest_mac[6];
@@ -194,7 +212,8 @@ static int net_get_iface_index(const struct net_iface *iface)
 }
 
 /* Forward declarations */
-static void net_send_arp_request(const u8 target_ip[4], struct net_iface *out_iface);
+static void net_send_arp_request(const u8 target_ip[4], const u8 *dest_mac,
+                                 struct net_iface *out_iface);
 
 void net_register_iface(struct eth_device *dev)
 {
@@ -239,6 +258,518 @@ void net_enable_nat(void)
     }
 }
 
+/*
+ * Frames waiting for ARP resolution
+ *
+ * Instead of dropping (or broadcasting) a frame whose next hop is not yet
+ * resolved, it is parked here and transmitted as soon as the neighbour
+ * answers. Each neighbour may hold at most NET_ARP_PENDING_PER_NEIGH
+ * frames; the oldest one is dropped when that limit is hit.
+ */
+#ifndef NET_ARP_PENDING_SLOTS
+#define NET_ARP_PENDING_SLOTS       16      /* Parked frames across all neighbours */
+#endif
+#ifndef NET_ARP_PENDING_PER_NEIGH
+#define NET_ARP_PENDING_PER_NEIGH   4       /* Parked frames per neighbour */
+#endif
+#define NET_ARP_PENDING_TIMEOUT     (ARP_INCOMPLETE_TIMEOUT * 1000)  /* ticks */
+
+struct net_arp_pending {
+    bool used;
+    u8   out_iface;             /* Egress interface index */
+    u16  len;                   /* Frame length */
+    u32  next_hop;              /* Neighbour IP (host byte order) */
+    u32  seq;                   /* Enqueue order, flushed oldest first */
+    u32  queued_at;             /* Tick of enqueue */
+    u8   frame[PKTSIZE_ALIGN];
+};
+
+static struct net_arp_pending net_arp_pending[NET_ARP_PENDING_SLOTS];
+static u32 net_arp_pending_seq;
+
+/**
+ * net_arp_pending_enqueue() - Park a frame until its next hop resolves
+ * @pkt: Frame with the source MAC already set
+ * @len: Frame length
+ * @out_iface_idx: Egress interface index
+ * @next_hop: Neighbour IP in host byte order
+ *
+ * Returns: 0 if the frame was parked, -1 if it was dropped
+ */
+static int net_arp_pending_enqueue(const u8 *pkt, int len, int out_iface_idx, u32 next_hop)
+{
+    struct net_arp_pending *slot = NULL;
+    struct net_arp_pending *oldest = NULL;
+    u32 now = OSTimeGet();
+    int queued = 0;
+
+    if (len <= 0 || len > PKTSIZE_ALIGN) {
+        return -1;
+    }
+
+    for (int i = 0; i < NET_ARP_PENDING_SLOTS; i++) {
+        struct net_arp_pending *p = &net_arp_pending[i];
+
+        /* Reclaim frames whose neighbour never answered */
+        if (p->used && (now - p->queued_at) >= NET_ARP_PENDING_TIMEOUT) {
+            p->used = false;
+        }
+        if (!p->used) {
+            if (slot == NULL) {
+                slot = p;
+            }
+            continue;
+        }
+        if (p->next_hop == next_hop) {
+            queued++;
+            if (oldest == NULL || (s32)(p->seq - oldest->seq) < 0) {
+                oldest = p;
+            }
+        }
+    }
+
+    if (queued >= NET_ARP_PENDING_PER_NEIGH) {
+        oldest->used = false;
+        slot = oldest;
+    }
+    if (slot == NULL) {
+        NET_TRACE("[ARP] Pending queue full, dropping frame\n");
+        return -1;
+    }
+
+    memcpy(slot->frame, pkt, len);
+    slot->len = (u16)len;
+    slot->out_iface = (u8)out_iface_idx;
+    slot->next_hop = next_hop;
+    slot->seq = net_arp_pending_seq++;
+    slot->queued_at = now;
+    slot->used = true;
+    return 0;
+}
+
+/**
+ * net_arp_pending_flush() - Transmit frames parked for a resolved neighbour
+ * @next_hop: Neighbour IP in host byte order
+ * @mac: Resolved MAC address
+ */
+static void net_arp_pending_flush(u32 next_hop, const u8 mac[6])
+{
+    for (;;) {
+        struct net_arp_pending *oldest = NULL;
+
+        for (int i = 0; i < NET_ARP_PENDING_SLOTS; i++) {
+            struct net_arp_pending *p = &net_arp_pending[i];
+
+            if (p->used && p->next_hop == next_hop &&
+                (oldest == NULL || (s32)(p->seq - oldest->seq) < 0)) {
+                oldest = p;
+            }
+        }
+        if (oldest == NULL) {
+            return;
+        }
+
+        memcpy(((struct eth_hdr *)oldest->frame)->dest_mac, mac, 6);
+        if (net_ifaces[oldest->out_iface].dev) {
+            net_xmit(net_ifaces[oldest->out_iface].dev, oldest->frame, oldest->len);
+        }
+        oldest->used = false;
+    }
+}
+
+/**
+ * net_next_hop() - Pick the neighbour an outgoing packet is handed to
+ * @out_iface_idx: Egress interface index
+ * @dst: Destination IP in host byte order
+ *
+ * Destinations outside the WAN /24 go through the WAN gateway once one is
+ * registered; everything else is delivered directly.
+ *
+ * Returns: Next-hop IP in host byte order
+ */
+static u32 net_next_hop(int out_iface_idx, u32 dst)
+{
+    const u8 *wan = net_ifaces[NET_IFACE_WAN].ip;
+    u32 wan_net = ((u32)wan[0] << 24) | ((u32)wan[1] << 16) | ((u32)wan[2] << 8);
+
+    if (out_iface_idx == NET_IFACE_WAN && net_wan_gateway != 0 &&
+        (dst & 0xffffff00u) != wan_net) {
+        return net_wan_gateway;
+    }
+    return dst;
+}
+
+/**
+ * net_neigh_resolve() - Resolve the next-hop MAC of an outgoing frame
+ * @pkt: Frame with the source MAC already set
+ * @len: Frame length
+ * @out_iface_idx: Egress interface index
+ * @next_hop: Neighbour IP in host byte order
+ *
+ * On a hit the destination MAC is written into the frame. On a miss the
+ * frame is parked and an ARP request is sent, at most once per
+ * ARP_RESOLVE_INTERVAL for the same neighbour.
+ *
+ * Returns: true if the frame is ready to send, false if it was parked/dropped
+ */
+static bool net_neigh_resolve(u8 *pkt, int len, int out_iface_idx, u32 next_hop)
+{
+    struct eth_hdr *eth = (struct eth_hdr *)pkt;
+
+    if (arp_cache_lookup_u32(next_hop, eth->dest_mac)) {
+        return true;
+    }
+
+    net_arp_pending_enqueue(pkt, len, out_iface_idx, next_hop);
+
+    if (arp_cache_resolve_due(next_hop)) {
+        u8 target_ip[4] = {
+            (u8)(next_hop >> 24), (u8)(next_hop >> 16),
+            (u8)(next_hop >> 8), (u8)next_hop
+        };
+
+        NET_TRACE("[ARP] MAC not found for %d.%d.%d.%d, sending ARP request (frame queued)\n",
+                  target_ip[0], target_ip[1], target_ip[2], target_ip[3]);
+        net_send_arp_request(target_ip, NULL, &net_ifaces[out_iface_idx]);
+    }
+
+    return false;
+}
+
+/**
+ * net_neigh_probe() - ARP cache hook used for background refresh
+ * @ip: Neighbour IP in host byte order
+ * @mac: Last known MAC for a unicast probe, NULL to broadcast
+ */
+static void net_neigh_probe(u32 ip, const u8 *mac)
+{
+    u8 target_ip[4] = {
+        (u8)(ip >> 24), (u8)(ip >> 16), (u8)(ip >> 8), (u8)ip
+    };
+    int iface_idx = nat_is_lan_ip(target_ip) ? NET_IFACE_LAN : NET_IFACE_WAN;
+
+    net_send_arp_request(target_ip, mac, &net_ifaces[iface_idx]);
+}
+
+/**
+ * net_neigh_refresh() - Background neighbour maintenance
+ * @current_ticks: Current system tick count
+ *
+ * Drives the ARP state machine, sending unicast probes to neighbours that
+ * are still in use before their entries lapse. Call about once per second.
+ */
+void net_neigh_refresh(u32 current_ticks)
+{
+    arp_cache_refresh(current_ticks, net_neigh_probe);
+}
+
+/**
+ * net_neigh_add_gateway() - Register a gateway neighbour at boot
+ * @ip: Gateway IP address
+ * @mac: Gateway MAC address, or NULL to resolve it over ARP
+ *
+ * WAN destinations outside the WAN subnet are forwarded through this
+ * neighbour from now on (see net_next_hop()). With a MAC the entry is
+ * static. Without one it is pinned and resolved right away, then kept
+ * fresh by net_neigh_refresh(), so established flows through the gateway
+ * do not hit the ARP miss path.
+ *
+ * Returns: 0 on success, -1 if the ARP table has no room
+ */
+int net_neigh_add_gateway(const u8 ip[4], const u8 *mac)
+{
+    u32 addr = ((u32)ip[0] << 24) | ((u32)ip[1] << 16) | ((u32)ip[2] << 8) | ip[3];
+
+    if (!nat_is_lan_ip(ip)) {
+        net_wan_gateway = addr;
+    }
+
+    if (mac) {
+        return arp_cache_add_static(addr, mac);
+    }
+
+    if (arp_cache_pin(addr) != 0) {
+        return -1;
+    }
+    if (arp_cache_resolve_due(addr)) {
+        net_neigh_probe(addr, NULL);
+    }
+    return 0;
+}
+
+/*
+ * Flow action cache
+ *
+ * Established flows are forwarded without touching the NAT or ARP tables:
+ * the first packet of a flow goes through the slow path and records the
+ * resulting rewrite (address, port, checksum deltas, egress interface and
+ * next-hop MAC) in a direct-mapped cache keyed by the 5-tuple. Entries are
+ * tagged with nat_generation() so any NAT expiry or ARP change drops them.
+ */
+#ifndef NET_FLOW_CACHE_SIZE
+#define NET_FLOW_CACHE_SIZE 256     /* Must be power of 2 */
+#endif
+
+/* Offsets inside the transport header */
+#define NET_L4_SPORT_OFF    0
+#define NET_L4_DPORT_OFF    2
+#define NET_ICMP_ID_OFF     4
+#define NET_ICMP_CSUM_OFF   2
+#define NET_UDP_CSUM_OFF    6
+#define NET_TCP_CSUM_OFF    16
+
+/* Flow key - all fields in network byte order */
+struct net_flow_key {
+    u32 saddr;
+    u32 daddr;
+    u16 sport;          /* Source port or ICMP ID */
+    u16 dport;          /* Destination port, 0 for ICMP */
+    u8  proto;
+    u8  in_iface;
+};
+
+/* Cached forwarding action */
+struct net_flow_entry {
+    u32 gen;                    /* nat_generation() at fill time, 0 = empty */
+    struct net_flow_key key;
+    u32 new_addr;               /* Replacement IP (network byte order) */
+    u16 new_port;               /* Replacement port/ICMP ID (network byte order) */
+    u16 ip_delta;               /* IP header checksum delta (RFC 1624) */
+    u16 l4_delta;               /* Transport checksum delta (RFC 1624) */
+    u8  port_off;               /* Offset of the rewritten port in L4 header */
+    u8  csum_off;               /* Offset of the checksum in L4 header */
+    u8  out_iface;              /* Egress interface index */
+    u8  outbound;               /* 1 = rewrite source (SNAT), 0 = destination */
+    s16 session;                /* NAT table slot refreshed on each hit */
+    s8  neigh;                  /* ARP slot kept in the refresh set by hits */
+    u8  dst_mac[6];             /* Next-hop MAC */
+};
+
+static struct net_flow_entry net_flow_cache[NET_FLOW_CACHE_SIZE];
+
+/* One's complement sum of (~old + new) for a 32-bit field - RFC 1624 */
+static inline u32 net_csum_delta32(u32 old_val, u32 new_val)
+{
+    return (u16)~(old_val & 0xffff) + (u16)~(old_val >> 16) +
+           (new_val & 0xffff) + (new_val >> 16);
+}
+
+static inline u32 net_csum_delta16(u16 old_val, u16 new_val)
+{
+    return (u16)~old_val + new_val;
+}
+
+static inline u16 net_csum_fold(u32 sum)
+{
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return (u16)sum;
+}
+
+/* HC' = ~(~HC + delta) - RFC 1624 eqn. 3 */
+static inline u16 net_csum_apply(u16 csum, u16 delta)
+{
+    return (u16)~net_csum_fold((u32)(u16)~csum + delta);
+}
+
+static inline u32 net_flow_hash(const struct net_flow_key *key)
+{
+    u32 h = key->saddr ^ key->daddr ^
+            (((u32)key->sport << 16) | key->dport) ^
+            ((u32)key->proto << 8) ^ key->in_iface;
+
+    h ^= h >> 16;
+    h *= 0x9e3779b1u;
+    return (h >> 16) & (NET_FLOW_CACHE_SIZE - 1);
+}
+
+static inline bool net_flow_key_equal(const struct net_flow_key *a,
+                                      const struct net_flow_key *b)
+{
+    return a->saddr == b->saddr && a->daddr == b->daddr &&
+           a->sport == b->sport && a->dport == b->dport &&
+           a->proto == b->proto && a->in_iface == b->in_iface;
+}
+
+/**
+ * net_flow_key_from_pkt() - Build the flow key of an IPv4 frame
+ * @key: Output key
+ * @pkt: Frame starting at the Ethernet header
+ * @len: Frame length
+ * @rx_iface_idx: Receiving interface index
+ *
+ * Only frames the NAT forwarders can handle produce a key: option-less
+ * IPv4 carrying TCP, UDP or ICMP echo in the direction NAT translates.
+ *
+ * Returns: 0 on success, -1 if the frame is not cacheable
+ */
+static int net_flow_key_from_pkt(struct net_flow_key *key, const u8 *pkt,
+                                 int len, int rx_iface_idx)
+{
+    const struct ip_hdr *ip = (const struct ip_hdr *)(pkt + sizeof(struct eth_hdr));
+    const u8 *l4 = pkt + sizeof(struct eth_hdr) + IP_HDR_SIZE;
+    int l4_min;
+
+    if (rx_iface_idx != NET_IFACE_LAN && rx_iface_idx != NET_IFACE_WAN) {
+        return -1;
+    }
+    if (len < (int)(sizeof(struct eth_hdr) + IP_HDR_SIZE) || ip->ip_hl_v != 0x45) {
+        return -1;
+    }
+
+    switch (ip->ip_p) {
+        case NAT_PROTO_TCP:
+            l4_min = 20;
+            break;
+        case NAT_PROTO_UDP:
+        case NAT_PROTO_ICMP:
+            l4_min = 8;
+            break;
+        default:
+            return -1;
+    }
+    if (len < (int)(sizeof(struct eth_hdr) + IP_HDR_SIZE) + l4_min) {
+        return -1;
+    }
+
+    key->saddr = ip->ip_src.s_addr;
+    key->daddr = ip->ip_dst.s_addr;
+    key->proto = ip->ip_p;
+    key->in_iface = (u8)rx_iface_idx;
+
+    if (ip->ip_p == NAT_PROTO_ICMP) {
+        const struct icmp_hdr *icmp = (const struct icmp_hdr *)l4;
+
+        if (!(rx_iface_idx == NET_IFACE_LAN && icmp->type == ICMP_ECHO_REQUEST) &&
+            !(rx_iface_idx == NET_IFACE_WAN && icmp->type == ICMP_ECHO_REPLY)) {
+            return -1;
+        }
+        key->sport = icmp->un.echo.id;
+        key->dport = 0;
+    } else {
+        key->sport = *(const u16 *)(l4 + NET_L4_SPORT_OFF);
+        key->dport = *(const u16 *)(l4 + NET_L4_DPORT_OFF);
+    }
+
+    return 0;
+}
+
+/**
+ * net_flow_cache_fill() - Record the action the slow path just applied
+ * @key: Flow key captured before translation
+ * @pkt: Translated frame, Ethernet header already rewritten
+ * @to_iface_idx: Egress interface index
+ *
+ * Called only when the next-hop MAC was resolved, so frames parked on an
+ * ARP miss are never cached.
+ */
+static void net_flow_cache_fill(const struct net_flow_key *key, const u8 *pkt,
+                                int to_iface_idx)
+{
+    const struct eth_hdr *eth = (const struct eth_hdr *)pkt;
+    const struct ip_hdr *ip = (const struct ip_hdr *)(pkt + sizeof(struct eth_hdr));
+    const u8 *l4 = pkt + sizeof(struct eth_hdr) + IP_HDR_SIZE;
+    struct net_flow_entry *fe = &net_flow_cache[net_flow_hash(key)];
+    bool outbound = (key->in_iface == NET_IFACE_LAN);
+    u32 old_addr;
+    u16 old_port;
+    u16 wan_port;
+    u32 addr_delta;
+
+    fe->key = *key;
+    fe->out_iface = (u8)to_iface_idx;
+    fe->outbound = outbound;
+
+    if (key->proto == NAT_PROTO_ICMP) {
+        fe->port_off = NET_ICMP_ID_OFF;
+        fe->csum_off = NET_ICMP_CSUM_OFF;
+        old_port = key->sport;
+    } else {
+        fe->port_off = outbound ? NET_L4_SPORT_OFF : NET_L4_DPORT_OFF;
+        fe->csum_off = (key->proto == NAT_PROTO_TCP) ? NET_TCP_CSUM_OFF : NET_UDP_CSUM_OFF;
+        old_port = outbound ? key->sport : key->dport;
+    }
+
+    old_addr = outbound ? key->saddr : key->daddr;
+    fe->new_addr = outbound ? ip->ip_src.s_addr : ip->ip_dst.s_addr;
+    fe->new_port = *(const u16 *)(l4 + fe->port_off);
+
+    addr_delta = net_csum_delta32(old_addr, fe->new_addr);
+    fe->ip_delta = net_csum_fold(addr_delta);
+    if (key->proto == NAT_PROTO_ICMP) {
+        /* ICMP has no pseudo-header: only the ID contributes */
+        fe->l4_delta = net_csum_fold(net_csum_delta16(old_port, fe->new_port));
+    } else {
+        fe->l4_delta = net_csum_fold(addr_delta + net_csum_delta16(old_port, fe->new_port));
+    }
+
+    memcpy(fe->dst_mac, eth->dest_mac, 6);
+
+    wan_port = ntohs(outbound ? fe->new_port : old_port);
+    fe->session = (s16)nat_session_index(key->proto, wan_port);
+    fe->neigh = (s8)arp_cache_index_u32(net_next_hop(to_iface_idx, ntohl(ip->ip_dst.s_addr)));
+    fe->gen = (fe->session >= 0) ? nat_generation() : 0;
+}
+
+/**
+ * net_flow_fast_path() - Forward a frame using a cached flow action
+ * @pkt: Frame buffer
+ * @len: Frame length
+ * @rx_iface_idx: Receiving interface index
+ *
+ * Returns: 0 if the frame was forwarded, -1 to fall back to the slow path
+ */
+static int net_flow_fast_path(u8 *pkt, int len, int rx_iface_idx)
+{
+    struct eth_hdr *eth = (struct eth_hdr *)pkt;
+    struct ip_hdr *ip = (struct ip_hdr *)(pkt + sizeof(struct eth_hdr));
+    u8 *l4 = pkt + sizeof(struct eth_hdr) + IP_HDR_SIZE;
+    struct net_flow_key key;
+    struct net_flow_entry *fe;
+    struct net_iface *out_iface;
+    u16 *csum;
+
+    if (net_flow_key_from_pkt(&key, pkt, len, rx_iface_idx) != 0) {
+        return -1;
+    }
+
+    fe = &net_flow_cache[net_flow_hash(&key)];
+    if (fe->gen != nat_generation() || !net_flow_key_equal(&fe->key, &key)) {
+        return -1;
+    }
+
+    out_iface = &net_ifaces[fe->out_iface];
+    if (!out_iface->dev) {
+        return -1;
+    }
+
+    /* Fixed header rewrite */
+    if (fe->outbound) {
+        ip->ip_src.s_addr = fe->new_addr;
+    } else {
+        ip->ip_dst.s_addr = fe->new_addr;
+    }
+    *(u16 *)(l4 + fe->port_off) = fe->new_port;
+    ip->ip_sum = net_csum_apply(ip->ip_sum, fe->ip_delta);
+
+    csum = (u16 *)(l4 + fe->csum_off);
+    if (key.proto != NAT_PROTO_UDP || *csum != 0) {
+        *csum = net_csum_apply(*csum, fe->l4_delta);
+        if (key.proto == NAT_PROTO_UDP && *csum == 0) {
+            *csum = 0xffff;         /* RFC 768: zero means "no checksum" */
+        }
+    }
+
+    memcpy(eth->dest_mac, fe->dst_mac, 6);
+    memcpy(eth->src_mac, out_iface->mac, 6);
+
+    nat_session_touch(fe->session, fe->outbound);
+    arp_cache_touch(fe->neigh);
+    net_xmit(out_iface->dev, pkt, len);
+    return 0;
+}
+
 /**
  * net_forward_icmp_with_nat() - Forward ICMP packet with NAT translation
  * @pkt: Packet buffer
@@ -258,11 +789,15 @@ static int net_forward_icmp_with_nat(u8 *pkt, int len, int from_iface_idx)
     u8 src_ip_bytes[4], dst_ip_bytes[4];
     u16 original_id, translated_id;
     u32 src_ip_u32, dst_ip_u32;
+    struct net_flow_key flow_key;
+    bool flow_cacheable;
 
     if (len < sizeof(struct eth_hdr) + IP_HDR_SIZE + 8) {
         return -1;
     }
 
+    flow_cacheable = (net_flow_key_from_pkt(&flow_key, pkt, len, from_iface_idx) == 0);
+
     /* Extract IP addresses */
     src_ip_u32 = ntohl(ip->ip_src.s_addr);
     dst_ip_u32 = ntohl(ip->ip_dst.s_addr);
@@ -354,35 +889,13 @@ static int net_forward_icmp_with_nat(u8 *pkt, int len, int from_iface_idx)
 
     memcpy(eth->src_mac, out_iface->mac, 6);
 
-    /* Perform ARP lookup for destination MAC */
-    u8 dest_ip_for_arp[4];
-    if (to_iface_idx == NET_IFACE_WAN) {
-        /* Going to WAN - use actual destination IP */
-        dest_ip_for_arp[0] = dst_ip_bytes[0];
-        dest_ip_for_arp[1] = dst_ip_bytes[1];
-        dest_ip_for_arp[2] = dst_ip_bytes[2];
-        dest_ip_for_arp[3] = dst_ip_bytes[3];
-    } else {
-        /* Going to LAN - use translated destination */
-        u32 lan_dst = ntohl(ip->ip_dst.s_addr);
-        dest_ip_for_arp[0] = (lan_dst >> 24) & 0xff;
-        dest_ip_for_arp[1] = (lan_dst >> 16) & 0xff;
-        dest_ip_for_arp[2] = (lan_dst >> 8) & 0xff;
-        dest_ip_for_arp[3] = lan_dst & 0xff;
-    }
-
-    if (arp_cache_lookup(dest_ip_for_arp, eth->dest_mac)) {
-        /* MAC found in cache - send packet */
-        virtio_net_send(out_iface->dev, pkt, len);
-    } else {
-        /* MAC not in cache - send ARP request and use broadcast for now */
-        NET_TRACE("[ARP] MAC not found for %d.%d.%d.%d, sending ARP request\n",
-                  dest_ip_for_arp[0], dest_ip_for_arp[1], dest_ip_for_arp[2], dest_ip_for_arp[3]);
-        net_send_arp_request(dest_ip_for_arp, out_iface);
-
-        /* Still send the packet with broadcast MAC - this works for some protocols */
-        memset(eth->dest_mac, 0xff, 6);
-        virtio_net_send(out_iface->dev, pkt, len);
+    /* Resolve next hop; frames for unresolved neighbours are parked, not dropped */
+    if (net_neigh_resolve(pkt, len, to_iface_idx,
+                          net_next_hop(to_iface_idx, ntohl(ip->ip_dst.s_addr)))) {
+        if (flow_cacheable) {
+            net_flow_cache_fill(&flow_key, pkt, to_iface_idx);
+        }
+        net_xmit(out_iface->dev, pkt, len);
     }
 
     return 0;
@@ -407,11 +920,15 @@ static int net_forward_tcp_with_nat(u8 *pkt, int len, int from_iface_idx)
     u8 src_ip_bytes[4], dst_ip_bytes[4];
     u16 original_port, translated_port;
     u32 src_ip_u32, dst_ip_u32;
+    struct net_flow_key flow_key;
+    bool flow_cacheable;
 
     if (len < sizeof(struct eth_hdr) + IP_HDR_SIZE + 20) {
         return -1;
     }
 
+    flow_cacheable = (net_flow_key_from_pkt(&flow_key, pkt, len, from_iface_idx) == 0);
+
     /* Extract IP addresses */
     src_ip_u32 = ntohl(ip->ip_src.s_addr);
     dst_ip_u32 = ntohl(ip->ip_dst.s_addr);
@@ -516,33 +1033,13 @@ static int net_forward_tcp_with_nat(u8 *pkt, int len, int from_iface_idx)
 
     memcpy(eth->src_mac, out_iface->mac, 6);
 
-    /* Perform ARP lookup for destination MAC */
-    u8 dest_ip_for_arp[4];
-    if (to_iface_idx == NET_IFACE_WAN) {
-        /* Going to WAN - use actual destination IP */
-        dest_ip_for_arp[0] = dst_ip_bytes[0];
-        dest_ip_for_arp[1] = dst_ip_bytes[1];
-        dest_ip_for_arp[2] = dst_ip_bytes[2];
-        dest_ip_for_arp[3] = dst_ip_bytes[3];
-    } else {
-        /* Going to LAN - use translated destination */
-        u32 lan_dst = ntohl(ip->ip_dst.s_addr);
-        dest_ip_for_arp[0] = (lan_dst >> 24) & 0xff;
-        dest_ip_for_arp[1] = (lan_dst >> 16) & 0xff;
-        dest_ip_for_arp[2] = (lan_dst >> 8) & 0xff;
-        dest_ip_for_arp[3] = lan_dst & 0xff;
-    }
-
-    if (arp_cache_lookup(dest_ip_for_arp, eth->dest_mac)) {
-        /* MAC found in cache - send packet */
-        virtio_net_send(out_iface->dev, pkt, len);
-    } else {
-        /* MAC not in cache - send ARP request and DO NOT send the packet */
-        /* TCP requires proper MAC addressing, broadcast won't work */
-        NET_TRACE("[ARP] MAC not found for %d.%d.%d.%d, sending ARP request (packet dropped)\n",
-                  dest_ip_for_arp[0], dest_ip_for_arp[1], dest_ip_for_arp[2], dest_ip_for_arp[3]);
-        net_send_arp_request(dest_ip_for_arp, out_iface);
-        return -1;
+    /* Resolve next hop; frames for unresolved neighbours are parked, not dropped */
+    if (net_neigh_resolve(pkt, len, to_iface_idx,
+                          net_next_hop(to_iface_idx, ntohl(ip->ip_dst.s_addr)))) {
+        if (flow_cacheable) {
+            net_flow_cache_fill(&flow_key, pkt, to_iface_idx);
+        }
+        net_xmit(out_iface->dev, pkt, len);
     }
 
     return 0;
@@ -567,11 +1064,15 @@ static int net_forward_udp_with_nat(u8 *pkt, int len, int from_iface_idx)
     u8 src_ip_bytes[4], dst_ip_bytes[4];
     u16 original_port, translated_port;
     u32 src_ip_u32, dst_ip_u32;
+    struct net_flow_key flow_key;
+    bool flow_cacheable;
 
     if (len < sizeof(struct eth_hdr) + IP_HDR_SIZE + 8) {
         return -1;
     }
 
+    flow_cacheable = (net_flow_key_from_pkt(&flow_key, pkt, len, from_iface_idx) == 0);
+
     /* Extract IP addresses */
     src_ip_u32 = ntohl(ip->ip_src.s_addr);
     dst_ip_u32 = ntohl(ip->ip_dst.s_addr);
@@ -664,35 +1165,13 @@ static int net_forward_udp_with_nat(u8 *pkt, int len, int from_iface_idx)
 
     memcpy(eth->src_mac, out_iface->mac, 6);
 
-    /* Perform ARP lookup for destination MAC */
-    u8 dest_ip_for_arp[4];
-    if (to_iface_idx == NET_IFACE_WAN) {
-        /* Going to WAN - use actual destination IP */
-        dest_ip_for_arp[0] = dst_ip_bytes[0];
-        dest_ip_for_arp[1] = dst_ip_bytes[1];
-        dest_ip_for_arp[2] = dst_ip_bytes[2];
-        dest_ip_for_arp[3] = dst_ip_bytes[3];
-    } else {
-        /* Going to LAN - use translated destination */
-        u32 lan_dst = ntohl(ip->ip_dst.s_addr);
-        dest_ip_for_arp[0] = (lan_dst >> 24) & 0xff;
-        dest_ip_for_arp[1] = (lan_dst >> 16) & 0xff;
-        dest_ip_for_arp[2] = (lan_dst >> 8) & 0xff;
-        dest_ip_for_arp[3] = lan_dst & 0xff;
-    }
-
-    if (arp_cache_lookup(dest_ip_for_arp, eth->dest_mac)) {
-        /* MAC found in cache - send packet */
-        virtio_net_send(out_iface->dev, pkt, len);
-    } else {
-        /* MAC not in cache - send ARP request and use broadcast for now */
-        NET_TRACE("[ARP] MAC not found for %d.%d.%d.%d, sending ARP request\n",
-                  dest_ip_for_arp[0], dest_ip_for_arp[1], dest_ip_for_arp[2], dest_ip_for_arp[3]);
-        net_send_arp_request(dest_ip_for_arp, out_iface);
-
-        /* Still send the packet with broadcast MAC - UDP can work with broadcast */
-        memset(eth->dest_mac, 0xff, 6);
-        virtio_net_send(out_iface->dev, pkt, len);
+    /* Resolve next hop; frames for unresolved neighbours are parked, not dropped */
+    if (net_neigh_resolve(pkt, len, to_iface_idx,
+                          net_next_hop(to_iface_idx, ntohl(ip->ip_dst.s_addr)))) {
+        if (flow_cacheable) {
+            net_flow_cache_fill(&flow_key, pkt, to_iface_idx);
+        }
+        net_xmit(out_iface->dev, pkt, len);
     }
 
     return 0;
@@ -701,11 +1180,13 @@ static int net_forward_udp_with_nat(u8 *pkt, int len, int from_iface_idx)
 /**
  * net_send_arp_request() - Send an ARP request for a given IP address
  * @target_ip: IP address to resolve (4 bytes)
+ * @dest_mac: Last known MAC for a unicast probe, NULL to broadcast
  * @out_iface: Network interface to send from
  *
  * Sends an ARP request to discover the MAC address of the target IP.
  */
-static void net_send_arp_request(const u8 target_ip[4], struct net_iface *out_iface)
+static void net_send_arp_request(const u8 target_ip[4], const u8 *dest_mac,
+                                 struct net_iface *out_iface)
 {
     u8 arp_pkt[64];
     struct eth_hdr *eth;
@@ -719,8 +1200,12 @@ static void net_send_arp_request(const u8 target_ip[4], struct net_iface *out_if
     eth = (struct eth_hdr *)arp_pkt;
     arp = (struct arp_hdr *)(arp_pkt + sizeof(struct eth_hdr));
 
-    /* Ethernet header - broadcast */
-    memset(eth->dest_mac, 0xff, 6);
+    /* Ethernet header - broadcast, or unicast when refreshing a known neighbour */
+    if (dest_mac) {
+        memcpy(eth->dest_mac, dest_mac, 6);
+    } else {
+        memset(eth->dest_mac, 0xff, 6);
+    }
     memcpy(eth->src_mac, out_iface->mac, 6);
     eth->ethertype = htons(0x0806);  /* ARP */
 
@@ -744,7 +1229,7 @@ static void net_send_arp_request(const u8 target_ip[4], struct net_iface *out_if
               out_iface->ip[0], out_iface->ip[1], out_iface->ip[2], out_iface->ip[3]);
 
     /* Send ARP request */
-    virtio_net_send(out_iface->dev, arp_pkt, 42);
+    net_xmit(out_iface->dev, arp_pkt, 42);
 }
 
 /* Handle ARP request */
@@ -773,7 +1258,11 @@ static void handle_arp(u8 *pkt, int len)
 
     /* Learn sender's MAC address from both ARP requests and replies */
     if (arp_op == ARPOP_REQUEST || arp_op == ARPOP_REPLY) {
-        arp_cache_add(sender_ip, sender_mac);
+        u32 sender = ((u32)sender_ip[0] << 24) | ((u32)sender_ip[1] << 16) |
+                     ((u32)sender_ip[2] << 8) | sender_ip[3];
+
+        arp_cache_add_u32(sender, sender_mac);
+        net_arp_pending_flush(sender, sender_mac);
     }
 
     /* Handle ARP request */
@@ -816,7 +1305,7 @@ static void handle_arp(u8 *pkt, int len)
 
     /* Send ARP reply */
     if (iface->dev) {
-        virtio_net_send(iface->dev, reply, 42);
+        net_xmit(iface->dev, reply, 42);
     }
 }
 
@@ -936,7 +1425,7 @@ static void handle_icmp(u8 *pkt, int len, int rx_iface_idx)
     /* Send ICMP reply */
     if (iface->dev) {
         int total_len = sizeof(struct eth_hdr) + IP_HDR_SIZE + 8 + payload_len;
-        virtio_net_send(iface->dev, reply, total_len);
+        net_xmit(iface->dev, reply, total_len);
     }
 }
 
@@ -949,6 +1438,12 @@ void net_process_received_packet(uchar *pkt, int len)
 
     test_net_on_frame((u8 *)pkt, len);
 
+#if defined(AMP_CORE_ID) && (AMP_CORE_ID == AMP_CORE_WAN)
+    /* WAN I/O core: routing, NAT and ARP all live on the LAN core */
+    amp_ring_send(pkt, len);
+    return;
+#endif
+
     if (len < sizeof(struct eth_hdr)) {
         return;
     }
@@ -979,6 +1474,11 @@ void net_process_received_packet(uchar *pkt, int len)
             {
                 struct ip_hdr *ip = (struct ip_hdr *)(pkt + sizeof(struct eth_hdr));
                 if (len >= sizeof(struct eth_hdr) + IP_HDR_SIZE) {
+                    /* Established NAT flows: single cache lookup + fixed rewrite */
+                    if (nat_enabled && net_flow_fast_path(pkt, len, rx_iface_idx) == 0) {
+                        break;
+                    }
+
                     if (ip->ip_p == 1) {  /* ICMP */
                         handle_icmp(pkt, len, rx_iface_idx);
                     } else if (ip->ip_p == 6 && nat_enabled) {  /* TCP */
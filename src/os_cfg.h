@@ -36,22 +36,29 @@
 #define OS_EVENT_MULTI_EN         1u   /* Include code for OSEventPendMulti()                          */
 #define OS_EVENT_NAME_EN          1u   /* Enable names for Sem, Mutex, Mbox and Q                      */
 
-#define OS_LOWEST_PRIO           63u   /* Defines the lowest priority that can be assigned ...         */
+#define OS_LOWEST_PRIO          254u   /* Defines the lowest priority that can be assigned ...         */
                                        /* ... MUST NEVER be higher than 254!                           */
 
-#define OS_MAX_EVENTS            10u   /* Max. number of event control blocks in your application      */
+#define OS_MAX_EVENTS  APP_CFG_EVENTS_TOT  /* ECB  pool, sum of APP_CFG_OBJ_TBL (app_cfg.h)            */
 #define OS_MAX_FLAGS              5u   /* Max. number of Event Flag Groups    in your application      */
 #define OS_MAX_MEM_PART           5u   /* Max. number of memory partitions                             */
-#define OS_MAX_QS                 4u   /* Max. number of queue control blocks in your application      */
-#define OS_MAX_TASKS             20u   /* Max. number of tasks in your application, MUST be >= 2       */
+#define OS_MAX_QS      APP_CFG_QS_TOT      /* OS_Q pool, sum of APP_CFG_OBJ_TBL (app_cfg.h)            */
+#define OS_MAX_TASKS   APP_CFG_TASKS_TOT   /* TCB  pool, sum of APP_CFG_OBJ_TBL, MUST be >= 2          */
 
 #define OS_SCHED_LOCK_EN          1u   /* Include code for OSSchedLock() and OSSchedUnlock()           */
+#define OS_STATIC_CREATE_EN       1u   /* Include code for OS???CreateStatic() (caller-owned objects)  */
 
 #define OS_TICK_STEP_EN           1u   /* Enable tick stepping feature for uC/OS-View                  */
 #define OS_TICKS_PER_SEC       1000u   /* Set the number of ticks in one second                        */
+                                       /* Differs from os_cfg_r.h on purpose: this port supports it    */
+                                       /* (bsp_os.c), the reference keeps 0 for ports that do not      */
+#define OS_TICKLESS_EN            1u   /* Suppress the tick while idle (needs port support)            */
 
 #define OS_TLS_TBL_SIZE           0u   /* Size of Thread-Local Storage Table                           */
 
+#define OS_TRACE_EN               1u   /* Record kernel events in per-core trace rings (os_trace.h)     */
+#define OS_TRACE_BUF_SIZE      1024u   /* Trace records per core, MUST be a power of 2                 */
+
 
                                        /* --------------------- TASK STACK SIZE ---------------------- */
 #define OS_TASK_TMR_STK_SIZE   1024u   /* Timer      task stack size (# of OS_STK wide entries)        */
@@ -65,6 +72,7 @@
 #define OS_TASK_CREATE_EXT_EN     1u   /*     Include code for OSTaskCreateExt()                       */
 #define OS_TASK_DEL_EN            1u   /*     Include code for OSTaskDel()                             */
 #define OS_TASK_NAME_EN           1u   /*     Enable task names                                        */
+#define OS_TASK_NOTIFY_EN         1u   /*     Include code for OSTaskNotifyPost()/Pend()               */
 #define OS_TASK_PROFILE_EN        1u   /*     Include variables in OS_TCB for profiling                */
 #define OS_TASK_QUERY_EN          1u   /*     Include code for OSTaskQuery()                           */
 #define OS_TASK_REG_TBL_SIZE      1u   /*     Size of task variables array (#of INT32U entries)        */
@@ -96,6 +104,7 @@
 
                                        /* --------------------- MEMORY MANAGEMENT -------------------- */
 #define OS_MEM_EN                 1u   /* Enable (1) or Disable (0) code generation for MEMORY MANAGER */
+#define OS_MEM_LF_EN              1u   /*     Include code for lock-free partitions, OSMemLFxxx()      */
 #define OS_MEM_NAME_EN            1u   /*     Enable memory partition names                            */
 #define OS_MEM_QUERY_EN           1u   /*     Include code for OSMemQuery()                            */
 
@@ -110,6 +119,7 @@
                                        /* ---------------------- MESSAGE QUEUES ---------------------- */
 #define OS_Q_EN                   1u   /* Enable (1) or Disable (0) code generation for QUEUES         */
 #define OS_Q_ACCEPT_EN            1u   /*     Include code for OSQAccept()                             */
+#define OS_Q_BATCH_EN             1u   /*     Include code for OSQPostBatch() and OSQPendBatch()       */
 #define OS_Q_DEL_EN               1u   /*     Include code for OSQDel()                                */
 #define OS_Q_FLUSH_EN             1u   /*     Include code for OSQFlush()                              */
 #define OS_Q_PEND_ABORT_EN        1u   /*     Include code for OSQPendAbort()                          */
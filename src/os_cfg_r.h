@@ -46,12 +46,17 @@
 #define OS_MAX_TASKS             20u   /* Max. number of tasks in your application, MUST be >= 2       */
 
 #define OS_SCHED_LOCK_EN          1u   /* Include code for OSSchedLock() and OSSchedUnlock()           */
+#define OS_STATIC_CREATE_EN       1u   /* Include code for OS???CreateStatic() (caller-owned objects)  */
 
 #define OS_TICK_STEP_EN           1u   /* Enable tick stepping feature for uC/OS-View                  */
 #define OS_TICKS_PER_SEC        100u   /* Set the number of ticks in one second                        */
+#define OS_TICKLESS_EN            0u   /* Suppress the tick while idle (needs port support)            */
 
 #define OS_TLS_TBL_SIZE           5u   /* Size of Thread-Local Storage Table                           */
 
+#define OS_TRACE_EN               1u   /* Record kernel events in per-core trace rings (os_trace.h)     */
+#define OS_TRACE_BUF_SIZE      1024u   /* Trace records per core, MUST be a power of 2                 */
+
 
                                        /* --------------------- TASK STACK SIZE ---------------------- */
 #define OS_TASK_TMR_STK_SIZE    128u   /* Timer      task stack size (# of OS_STK wide entries)        */
@@ -65,6 +70,7 @@
 #define OS_TASK_CREATE_EXT_EN     1u   /*     Include code for OSTaskCreateExt()                       */
 #define OS_TASK_DEL_EN            1u   /*     Include code for OSTaskDel()                             */
 #define OS_TASK_NAME_EN           1u   /*     Enable task names                                        */
+#define OS_TASK_NOTIFY_EN         1u   /*     Include code for OSTaskNotifyPost()/Pend()               */
 #define OS_TASK_PROFILE_EN        1u   /*     Include variables in OS_TCB for profiling                */
 #define OS_TASK_QUERY_EN          1u   /*     Include code for OSTaskQuery()                           */
 #define OS_TASK_REG_TBL_SIZE      1u   /*     Size of task variables array (#of INT32U entries)        */
@@ -96,6 +102,7 @@
 
                                        /* --------------------- MEMORY MANAGEMENT -------------------- */
 #define OS_MEM_EN                 1u   /* Enable (1) or Disable (0) code generation for MEMORY MANAGER */
+#define OS_MEM_LF_EN              1u   /*     Include code for lock-free partitions, OSMemLFxxx()      */
 #define OS_MEM_NAME_EN            1u   /*     Enable memory partition names                            */
 #define OS_MEM_QUERY_EN           1u   /*     Include code for OSMemQuery()                            */
 
@@ -110,6 +117,7 @@
                                        /* ---------------------- MESSAGE QUEUES ---------------------- */
 #define OS_Q_EN                   1u   /* Enable (1) or Disable (0) code generation for QUEUES         */
 #define OS_Q_ACCEPT_EN            1u   /*     Include code for OSQAccept()                             */
+#define OS_Q_BATCH_EN             1u   /*     Include code for OSQPostBatch() and OSQPendBatch()       */
 #define OS_Q_DEL_EN               1u   /*     Include code for OSQDel()                                */
 #define OS_Q_FLUSH_EN             1u   /*     Include code for OSQFlush()                              */
 #define OS_Q_PEND_ABORT_EN        1u   /*     Include code for OSQPendAbort()                          */
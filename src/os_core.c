@@ -28,6 +28,7 @@
 #include <ucos_ii.h>
 #endif
 
+#if OS_CPU_PRIO_BITMAP_64 == 0u
 /*
 *********************************************************************************************************
 *                                      PRIORITY RESOLUTION TABLE
@@ -55,6 +56,7 @@ INT8U  const  OSUnMapTbl[256] = {
     5u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, /* 0xE0 to 0xEF                   */
     4u, 0u, 1u, 0u, 2u, 0u, 1u, 0u, 3u, 0u, 1u, 0u, 2u, 0u, 1u, 0u  /* 0xF0 to 0xFF                   */
 };
+#endif
 
 /*$PAGE*/
 /*
@@ -79,6 +81,8 @@ static  void  OS_InitTCBList(void);
 
 static  void  OS_SchedNew(void);
 
+static  void  OS_TickListAdvance(INT32U ticks);
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -476,7 +480,7 @@ INT16U  OSEventPendMulti (OS_EVENT  **pevents_pend,
     OSTCBCur->OSTCBStat     |= events_stat  |           /* Resource not available, ...                 */
                                OS_STAT_MULTI;           /* ... pend on multiple events                 */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;                 /* Store pend timeout in TCB                   */
+    OS_TickListInsert(OSTCBCur, timeout);               /* Store pend timeout in tick list             */
     OS_EventTaskWaitMulti(pevents_pend);                /* Suspend task until events or timeout occurs */
 
     OS_EXIT_CRITICAL();
@@ -917,7 +921,6 @@ void  OSStatInit (void)
 
 void  OSTimeTick (void)
 {
-    OS_TCB    *ptcb;
 #if OS_TICK_STEP_EN > 0u
     BOOLEAN    step;
 #endif
@@ -961,35 +964,250 @@ void  OSTimeTick (void)
             return;
         }
 #endif
-        ptcb = OSTCBList;                                  /* Point at first TCB in TCB list               */
-        while (ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO) {     /* Go through all TCBs in TCB list              */
-//		printf("[%s:%d] ptcb->OSTCBDly=%d\n",__func__,__LINE__, ptcb->OSTCBDly);
-            OS_ENTER_CRITICAL();
-            if (ptcb->OSTCBDly != 0u) {                    /* No, Delayed or waiting for event with TO     */
-                ptcb->OSTCBDly--;                          /* Decrement nbr of ticks to end of delay       */
-//		printf("[%s:%d] ptcb->OSTCBDly=%d\n",__func__,__LINE__, ptcb->OSTCBDly);
-                if (ptcb->OSTCBDly == 0u) {                /* Check for timeout                            */
-
-                    if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
-                        ptcb->OSTCBStat  &= (INT8U)~(INT8U)OS_STAT_PEND_ANY;          /* Yes, Clear status flag   */
-                        ptcb->OSTCBStatPend = OS_STAT_PEND_TO;                 /* Indicate PEND timeout    */
-//		printf("[%s:%d]\n",__func__,__LINE__);
-                    } else {
-                        ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
-//		printf("[%s:%d]\n",__func__,__LINE__);
-                    }
-
-                    if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY) {  /* Is task suspended?       */
-                        OSRdyGrp               |= ptcb->OSTCBBitY;             /* No,  Make ready          */
-                        OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
-//		printf("[%s:%d]\n",__func__,__LINE__);
-                    }
-                }
-            }
-            ptcb = ptcb->OSTCBNext;                        /* Point at next TCB in TCB list                */
-            OS_EXIT_CRITICAL();
+        OS_TickListAdvance(1u);                            /* Ready the tasks whose delay expired          */
+    }
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      PROCESS MULTIPLE SYSTEM TICKS
+*
+* Description: This function announces 'ticks' clock ticks to uC/OS-II in one pass.  It is used by a
+*              tickless port to catch up on the ticks that elapsed while the periodic tick was suppressed
+*              (see OSTimeNextExpiry()).  Every delayed task sees its delay reduced by 'ticks' (but not
+*              below zero) and tasks whose delay or timeout expired are made ready exactly as OSTimeTick()
+*              would have done one tick at a time.  Only the tasks that expire are touched.
+*
+* Arguments  : ticks     is the number of ticks that elapsed since the last announced tick.
+*
+* Returns    : none
+*
+* Note(s)    : 1) OSTimeTickHook() is called once per announcement, not once per tick.
+*              2) Tick stepping (uC/OS-View) is not honoured here; OSTimeNextExpiry() never lets the port
+*                 suppress the tick while stepping is active.
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0u
+void  OSTimeTickN (INT32U ticks)
+{
+#if OS_CRITICAL_METHOD == 3u                               /* Allocate storage for CPU status register     */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+    if (ticks == 0u) {
+        return;
+    }
+#if OS_TIME_TICK_HOOK_EN > 0u
+    OSTimeTickHook();                                      /* Call user definable hook                     */
+#endif
+#if OS_TIME_GET_SET_EN > 0u
+    OS_ENTER_CRITICAL();                                   /* Update the 32-bit tick counter               */
+    OSTime += ticks;
+    OS_EXIT_CRITICAL();
+#endif
+    if (OSRunning == OS_TRUE) {
+        OS_TickListAdvance(ticks);                         /* Ready the tasks whose delay expired          */
+    }
+}
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      FIND NEXT TICK EXPIRY
+*
+* Description: This function returns the number of ticks until the earliest delay or pend timeout among
+*              all tasks expires, i.e. the head of the tick list.  A tickless port calls it from the idle
+*              task to decide how long the periodic tick can be suppressed.
+*
+* Arguments  : none
+*
+* Returns    : 0          if no task is waiting on a delay or timeout (the tick may stay off until the next
+*                         interrupt).
+*              1          if the tick must keep running (e.g. tick stepping is active).
+*              N          the number of ticks until the earliest expiry.
+*
+* Note(s)    : 1) This function MUST be called with interrupts disabled.
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0u
+INT32U  OSTimeNextExpiry (void)
+{
+    INT32U  next;
+
+
+#if OS_TICK_STEP_EN > 0u
+    if (OSTickStepState != OS_TICK_STEP_DIS) {             /* Stepping needs every tick                    */
+        return (1u);
+    }
+#endif
+    if (OSTickList == (OS_TCB *)0) {                       /* No task is delayed                           */
+        return (0u);
+    }
+    next = OSTickList->OSTCBDlyExpiry - OSTickCtr;         /* Head of the tick list expires first          */
+    if (next == 0u) {
+        next = 1u;
+    }
+    return (next);
+}
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      INSERT TASK IN TICK LIST
+*
+* Description: This function is called to place a task in the tick list, the list of tasks that are
+*              delayed or pending with a timeout.  The list is kept sorted by expiry so that a tick only
+*              has to look at the head of the list.
+*
+* Arguments  : ptcb      is a pointer to the task's OS_TCB.
+*
+*              ticks     is the number of ticks until the delay or timeout expires.  0 means no timeout,
+*                        in which case the task is not placed in the list.
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) This function MUST be called with interrupts disabled.
+*              3) OSTCBDly is non-zero exactly while the task is in the tick list.  It holds the requested
+*                 delay; the time left is (OSTCBDlyExpiry - OSTickCtr).
+*              4) Tasks with the same expiry are kept in insertion order.
+*********************************************************************************************************
+*/
+
+void  OS_TickListInsert (OS_TCB  *ptcb,
+                         INT32U   ticks)
+{
+    OS_TCB  *pprev;
+    OS_TCB  *pnext;
+
+
+    if (ptcb->OSTCBDly != 0u) {                            /* Already in the list, unlink first            */
+        OS_TickListRemove(ptcb);
+    }
+    if (ticks == 0u) {                                     /* 0 means wait forever                         */
+        return;
+    }
+    ptcb->OSTCBDly       = ticks;
+    ptcb->OSTCBDlyExpiry = OSTickCtr + ticks;
+    pprev                = (OS_TCB *)0;
+    pnext                = OSTickList;
+    while (pnext != (OS_TCB *)0) {                         /* Find first task that expires later           */
+        if ((pnext->OSTCBDlyExpiry - OSTickCtr) > ticks) {
+            break;
+        }
+        pprev = pnext;
+        pnext = pnext->OSTCBDlyNext;
+    }
+    ptcb->OSTCBDlyPrev = pprev;
+    ptcb->OSTCBDlyNext = pnext;
+    if (pnext != (OS_TCB *)0) {
+        pnext->OSTCBDlyPrev = ptcb;
+    }
+    if (pprev != (OS_TCB *)0) {
+        pprev->OSTCBDlyNext = ptcb;
+    } else {
+        OSTickList = ptcb;
+    }
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                     REMOVE TASK FROM TICK LIST
+*
+* Description: This function is called to take a task out of the tick list, e.g. because the event it
+*              was waiting on occurred, the delay was resumed or the task is deleted.
+*
+* Arguments  : ptcb      is a pointer to the task's OS_TCB.
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) This function MUST be called with interrupts disabled.
+*              3) Calling this function for a task that is not in the tick list is harmless.
+*********************************************************************************************************
+*/
+
+void  OS_TickListRemove (OS_TCB  *ptcb)
+{
+    if (ptcb->OSTCBDly == 0u) {                            /* Not in the tick list                         */
+        return;
+    }
+    if (ptcb->OSTCBDlyPrev != (OS_TCB *)0) {
+        ptcb->OSTCBDlyPrev->OSTCBDlyNext = ptcb->OSTCBDlyNext;
+    } else {
+        OSTickList = ptcb->OSTCBDlyNext;
+    }
+    if (ptcb->OSTCBDlyNext != (OS_TCB *)0) {
+        ptcb->OSTCBDlyNext->OSTCBDlyPrev = ptcb->OSTCBDlyPrev;
+    }
+    ptcb->OSTCBDlyNext = (OS_TCB *)0;
+    ptcb->OSTCBDlyPrev = (OS_TCB *)0;
+    ptcb->OSTCBDly     = 0u;
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                         ADVANCE TICK LIST
+*
+* Description: This function advances the tick list by 'ticks' and makes ready every task whose delay or
+*              pend timeout expired.  Only the expired tasks at the head of the list are visited, so the
+*              cost of a tick does not grow with the number of tasks.
+*
+* Arguments  : ticks     is the number of ticks to advance by (>= 1).
+*
+* Returns    : none
+*
+* Note(s)    : 1) Interrupts stay disabled while the expired tasks are removed so that a task inserted
+*                 by an ISR can never be placed behind an expired, not yet processed, entry.
+*********************************************************************************************************
+*/
+
+static  void  OS_TickListAdvance (INT32U  ticks)
+{
+    OS_TCB    *ptcb;
+    INT32U     base;
+#if OS_CRITICAL_METHOD == 3u                               /* Allocate storage for CPU status register     */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+    OS_ENTER_CRITICAL();
+    base       = OSTickCtr;
+    OSTickCtr += ticks;
+    ptcb       = OSTickList;
+    while (ptcb != (OS_TCB *)0) {
+        if ((ptcb->OSTCBDlyExpiry - base) > ticks) {       /* List is sorted, the rest expire later        */
+            break;
+        }
+        OSTickList = ptcb->OSTCBDlyNext;                   /* Pop the head of the list                     */
+        if (OSTickList != (OS_TCB *)0) {
+            OSTickList->OSTCBDlyPrev = (OS_TCB *)0;
         }
+        ptcb->OSTCBDlyNext = (OS_TCB *)0;
+        ptcb->OSTCBDly     = 0u;
+
+        if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
+            ptcb->OSTCBStat  &= (INT8U)~(INT8U)OS_STAT_PEND_ANY;          /* Yes, Clear status flag       */
+            ptcb->OSTCBStatPend = OS_STAT_PEND_TO;                 /* Indicate PEND timeout        */
+        } else {
+            ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
+        }
+
+        if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY) {  /* Is task suspended?           */
+            OSRdyGrp               |= ptcb->OSTCBBitY;             /* No,  Make ready              */
+            OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+        }
+        ptcb = OSTickList;
     }
+    OS_EXIT_CRITICAL();
 }
 
 /*$PAGE*/
@@ -1069,12 +1287,16 @@ INT8U  OS_EventTaskRdy (OS_EVENT  *pevent,
     INT8U     y;
     INT8U     x;
     INT8U     prio;
-#if OS_LOWEST_PRIO > 63u
+#if (OS_CPU_PRIO_BITMAP_64 == 0u) && (OS_LOWEST_PRIO > 63u)
     OS_PRIO  *ptbl;
 #endif
 
 
-#if OS_LOWEST_PRIO <= 63u
+#if OS_CPU_PRIO_BITMAP_64 > 0u
+    y    = OS_CPU_PrioLowBit(pevent->OSEventGrp);       /* Find HPT waiting for message                */
+    x    = OS_CPU_PrioLowBit(pevent->OSEventTbl[y]);
+    prio = (INT8U)((y << OS_PRIO_ROW_SHIFT) + x);       /* Find priority of task getting the msg       */
+#elif OS_LOWEST_PRIO <= 63u
     y    = OSUnMapTbl[pevent->OSEventGrp];              /* Find HPT waiting for message                */
     x    = OSUnMapTbl[pevent->OSEventTbl[y]];
     prio = (INT8U)((y << 3u) + x);                      /* Find priority of task getting the msg       */
@@ -1094,7 +1316,7 @@ INT8U  OS_EventTaskRdy (OS_EVENT  *pevent,
 #endif
 
     ptcb                  =  OSTCBPrioTbl[prio];        /* Point to this task's OS_TCB                 */
-    ptcb->OSTCBDly        =  0u;                        /* Prevent OSTimeTick() from readying task     */
+    OS_TickListRemove(ptcb);                            /* Prevent OSTimeTick() from readying task     */
 #if ((OS_Q_EN > 0u) && (OS_MAX_QS > 0u)) || (OS_MBOX_EN > 0u)
     ptcb->OSTCBMsg        =  pmsg;                      /* Send message directly to waiting task       */
 #else
@@ -1366,6 +1588,9 @@ static  void  OS_InitMisc (void)
     OSTime                    = 0uL;                       /* Clear the 32-bit system clock            */
 #endif
 
+    OSTickCtr                 = 0uL;                       /* Clear the tick list                      */
+    OSTickList                = (OS_TCB *)0;
+
     OSIntNesting              = 0u;                        /* Clear the interrupt nesting counter      */
     OSLockNesting             = 0u;                        /* Clear the scheduling lock counter        */
 
@@ -1719,7 +1944,17 @@ void  OS_Sched (void)
 
 static  void  OS_SchedNew (void)
 {
-#if OS_LOWEST_PRIO <= 63u                        /* See if we support up to 64 tasks                   */
+#if OS_CPU_PRIO_BITMAP_64 > 0u                   /* Port finds the lowest set bit of a 64-bit row      */
+    INT8U   y;
+
+
+#if OS_RDY_TBL_SIZE == 1u                        /* Up to 64 tasks: a single row, OSRdyGrp not needed  */
+    y             = 0u;
+#else
+    y             = OS_CPU_PrioLowBit(OSRdyGrp);
+#endif
+    OSPrioHighRdy = (INT8U)((y << OS_PRIO_ROW_SHIFT) + OS_CPU_PrioLowBit(OSRdyTbl[y]));
+#elif OS_LOWEST_PRIO <= 63u                      /* See if we support up to 64 tasks                   */
     INT8U   y;
 
 
@@ -1938,7 +2173,10 @@ void  OS_TaskStatStkChk (void)
 * Description: This function is internal to uC/OS-II and is used to initialize a Task Control Block when
 *              a task is created (see OSTaskCreate() and OSTaskCreateExt()).
 *
-* Arguments  : prio          is the priority of the task being created
+* Arguments  : ptcb          is a pointer to a caller-supplied TCB (see OSTaskCreateStatic()), or a NULL
+*                            pointer to take one from the free TCB list
+*
+*              prio          is the priority of the task being created
 *
 *              ptos          is a pointer to the task's top-of-stack assuming that the CPU registers
 *                            have been placed on the stack.  Note that the top-of-stack corresponds to a
@@ -1974,7 +2212,8 @@ void  OS_TaskStatStkChk (void)
 *********************************************************************************************************
 */
 
-INT8U  OS_TCBInit (INT8U    prio,
+INT8U  OS_TCBInit (OS_TCB  *ptcb,
+                   INT8U    prio,
                    OS_STK  *ptos,
                    OS_STK  *pbos,
                    INT16U   id,
@@ -1982,7 +2221,6 @@ INT8U  OS_TCBInit (INT8U    prio,
                    void    *pext,
                    INT16U   opt)
 {
-    OS_TCB    *ptcb;
 #if OS_CRITICAL_METHOD == 3u                               /* Allocate storage for CPU status register */
     OS_CPU_SR  cpu_sr = 0u;
 #endif
@@ -1997,15 +2235,22 @@ INT8U  OS_TCBInit (INT8U    prio,
 
 
     OS_ENTER_CRITICAL();
-    ptcb = OSTCBFreeList;                                  /* Get a free TCB from the free TCB list    */
+    if (ptcb == (OS_TCB *)0) {                             /* No caller-supplied TCB ...               */
+        ptcb = OSTCBFreeList;                              /* ... get a free TCB from the free list    */
+        if (ptcb != (OS_TCB *)0) {
+            OSTCBFreeList        = ptcb->OSTCBNext;        /* Update pointer to free TCB list          */
+        }
+    }
     if (ptcb != (OS_TCB *)0) {
-        OSTCBFreeList            = ptcb->OSTCBNext;        /* Update pointer to free TCB list          */
         OS_EXIT_CRITICAL();
         ptcb->OSTCBStkPtr        = ptos;                   /* Load Stack pointer in TCB                */
         ptcb->OSTCBPrio          = prio;                   /* Load task priority into TCB              */
         ptcb->OSTCBStat          = OS_STAT_RDY;            /* Task is ready to run                     */
         ptcb->OSTCBStatPend      = OS_STAT_PEND_OK;        /* Clear pend status                        */
         ptcb->OSTCBDly           = 0u;                     /* Task is not delayed                      */
+        ptcb->OSTCBDlyExpiry     = 0u;
+        ptcb->OSTCBDlyNext       = (OS_TCB *)0;
+        ptcb->OSTCBDlyPrev       = (OS_TCB *)0;
 
 #if OS_TASK_CREATE_EXT_EN > 0u
         ptcb->OSTCBExtPtr        = pext;                   /* Store pointer to TCB extension           */
@@ -2025,16 +2270,17 @@ INT8U  OS_TCBInit (INT8U    prio,
         ptcb->OSTCBDelReq        = OS_ERR_NONE;
 #endif
 
-#if OS_LOWEST_PRIO <= 63u                                         /* Pre-compute X, Y                  */
-        ptcb->OSTCBY             = (INT8U)(prio >> 3u);
-        ptcb->OSTCBX             = (INT8U)(prio & 0x07u);
-#else                                                             /* Pre-compute X, Y                  */
-        ptcb->OSTCBY             = (INT8U)((INT8U)(prio >> 4u) & 0xFFu);
-        ptcb->OSTCBX             = (INT8U) (prio & 0x0Fu);
+#if OS_TASK_NOTIFY_EN > 0u
+        ptcb->OSTCBNotifyVal     = 0u;                     /* No notification posted yet               */
+        ptcb->OSTCBNotifyPend    = OS_FALSE;
 #endif
+
+                                                                  /* Pre-compute X, Y                  */
+        ptcb->OSTCBY             = (INT8U)(prio >> OS_PRIO_ROW_SHIFT);
+        ptcb->OSTCBX             = (INT8U)(prio &  OS_PRIO_ROW_MSK);
                                                                   /* Pre-compute BitX and BitY         */
-        ptcb->OSTCBBitY          = (OS_PRIO)(1uL << ptcb->OSTCBY);
-        ptcb->OSTCBBitX          = (OS_PRIO)(1uL << ptcb->OSTCBX);
+        ptcb->OSTCBBitY          = (OS_PRIO)((OS_PRIO)1u << ptcb->OSTCBY);
+        ptcb->OSTCBBitX          = (OS_PRIO)((OS_PRIO)1u << ptcb->OSTCBX);
 
 #if (OS_EVENT_EN)
         ptcb->OSTCBEventPtr      = (OS_EVENT  *)0;         /* Task is not pending on an  event         */
@@ -2055,6 +2301,9 @@ INT8U  OS_TCBInit (INT8U    prio,
         ptcb->OSTCBCtxSwCtr      = 0uL;                    /* Initialize profiling variables           */
         ptcb->OSTCBCyclesStart   = 0uL;
         ptcb->OSTCBCyclesTot     = 0uL;
+        ptcb->OSTCBCyclesRun     = 0uL;
+        ptcb->OSTCBCyclesMax     = 0uL;
+        ptcb->OSTCBPreemptCtr    = 0uL;
         ptcb->OSTCBStkBase       = (OS_STK *)0;
         ptcb->OSTCBStkUsed       = 0uL;
 #endif
@@ -50,7 +50,7 @@
 
 
 #ifndef  OS_CPU_EXCEPT_STK_SIZE
-#define  OS_CPU_EXCEPT_STK_SIZE    1024u                         /* Default exception stack size is 128 OS_STK entries.  */
+#define  OS_CPU_EXCEPT_STK_SIZE    4096u                         /* Room for nested IRQ frames (FP/SIMD included).       */
 #endif
 
 
@@ -67,6 +67,8 @@
 *********************************************************************************************************
 */
 
+#define  OS_TASK_OPT_NO_FP                           0x0100u     /* Task never uses FP/SIMD (OSTaskCreateExt() opt)       */
+
 #define  OS_CPU_ARM_ENDIAN_LITTLE                         1u
 #define  OS_CPU_ARM_ENDIAN_BIG                            2u
 
@@ -79,8 +81,12 @@
 #endif
 
 #ifndef  OS_CPU_INT_DIS_MEAS_EN
-#define  OS_CPU_INT_DIS_MEAS_EN    0u                           /* Intrrupt dis time measurement disabled by default  */
-#endif
+#define  OS_CPU_INT_DIS_MEAS_EN    1u                           /* Interrupt dis time measurement compiled in, ...    */
+#endif                                                          /* ... switched on at run time (OS_CPU_IntDisMeasCtl) */
+
+#define  OS_CPU_INT_DIS_MEAS_SITES         8u                   /* Longest critical sections kept, by call site       */
+
+#define  OS_CPU_SR_IRQ_MASK             0x80u                   /* DAIF.I as returned by CPU_SR_Save()                */
 
 /*
 *********************************************************************************************************
@@ -112,6 +118,20 @@ typedef  unsigned long long     OS_STK;                   /* Each stack entry is
 //typedef  CPU_STK     OS_STK;                   /* Each stack entry is 32-bit wide                    */
 typedef  CPU_SR      OS_CPU_SR;                /* Define size of CPU status register (PSR = 32 bits) */
 
+typedef  struct  os_cpu_fp_ctx {               /* FP/SIMD register file of a task (lazy switching)   */
+    CPU_INT64U  Q[64];                         /* q0-q31, 128 bits each                              */
+    CPU_INT64U  FPSR;
+    CPU_INT64U  FPCR;
+} __attribute__((aligned(16))) OS_CPU_FP_CTX;
+
+#define  OS_CPU_TCB_EXT  OS_CPU_FP_CTX  OSTCBFpCtx;     /* FP/SIMD save area lives in the TCB (see OS_TCB)    */
+
+typedef  struct  os_cpu_int_dis_site {         /* Longest interrupts-disabled section seen at a site */
+    void       *PcEnter;                       /* Return address into the OS_ENTER_CRITICAL() caller */
+    void       *PcExit;                        /* ... and into the OS_EXIT_CRITICAL() that ended it  */
+    CPU_INT64U  CntsMax;                       /* Length, CNTVCT_EL0 counts                          */
+} OS_CPU_INT_DIS_SITE;
+
 /*
 *********************************************************************************************************
 *                                               MACROS
@@ -121,6 +141,62 @@ typedef  CPU_SR      OS_CPU_SR;                /* Define size of CPU status regi
 #define  OS_TASK_SW()                           OSCtxSw()
 #define  OS_STK_GROWTH                           1u         /* Stack grows from HIGH to LOW memory on ARM        */
 
+                                                            /* Ready/event bitmaps use 64-bit rows: the lowest   */
+                                                            /* set bit (highest priority) is RBIT + CLZ, so even */
+                                                            /* 255 priorities resolve in two rows, no table.     */
+#define  OS_CPU_PRIO_BITMAP_64                   1u
+#define  OS_CPU_PrioLowBit(bits)               ((INT8U)__builtin_ctzll(bits))  /* 'bits' must be non-zero        */
+
+                                                            /* Run time is counted on CNTVCT_EL0, the counter    */
+                                                            /* the tick and BSP_OS_TimeGetNs() already use; it   */
+                                                            /* needs no enabling and runs at CNTFRQ_EL0.         */
+#define  OS_CPU_CyclesGet()                    ({ INT64U  __cnt;                                          \
+                                                  __asm__ volatile("mrs %0, cntvct_el0" : "=r" (__cnt)); \
+                                                  __cnt; })
+
+/*
+*********************************************************************************************************
+*                                  DOUBLE-WORD COMPARE AND SWAP
+*
+* Description: Atomically replace the 16-byte, 16-byte aligned pair at 'p_pair' with {new0, new1} if it
+*              still holds {old0, old1}.  Acquire and release ordering.
+*
+* Returns    : 1 if the pair was replaced, 0 if it held something else.
+*
+* Note(s)    : 1) ARMv8.0 has no CASP, so this is an LDAXP/STLXP loop.  The compare sits inside the
+*                 asm so that nothing touches memory between the exclusive load and store.  The loop
+*                 only retries when the store loses the monitor (another core, or an interrupt taken
+*                 in between), never because the values differ.
+*********************************************************************************************************
+*/
+
+static  inline  BOOLEAN  OS_CPU_CAS2 (volatile void  *p_pair,
+                                      INT64U          old0,
+                                      INT64U          old1,
+                                      INT64U          new0,
+                                      INT64U          new1)
+{
+    INT64U  cur0;
+    INT64U  cur1;
+    INT32U  fail;
+
+
+    __asm__ volatile("1: ldaxp  %0, %1, [%3]         \n"
+                     "   cmp    %0, %4               \n"
+                     "   ccmp   %1, %5, #0, eq       \n"
+                     "   b.ne   2f                   \n"
+                     "   stlxp  %w2, %6, %7, [%3]    \n"
+                     "   cbnz   %w2, 1b              \n"
+                     "   b      3f                   \n"
+                     "2: clrex                       \n"
+                     "3:                             \n"
+                     : "=&r" (cur0), "=&r" (cur1), "=&r" (fail)
+                     : "r" (p_pair), "r" (old0), "r" (old1), "r" (new0), "r" (new1)
+                     : "cc", "memory");
+
+    return ((BOOLEAN)((cur0 == old0) && (cur1 == old1)));
+}
+
 /*
 *********************************************************************************************************
 *                                                ARM
@@ -147,12 +223,16 @@ typedef  CPU_SR      OS_CPU_SR;                /* Define size of CPU status regi
 
 #if      OS_CRITICAL_METHOD == 3u
 
-#if      OS_CPU_INT_DIS_MEAS_EN > 0u
+#if      OS_CPU_INT_DIS_MEAS_EN > 0u                            /* One load and branch while not measuring            */
 
-#define  OS_ENTER_CRITICAL()  do { cpu_sr = CPU_SR_Save();  \
-                                   OS_CPU_IntDisMeasStart();  } while (0)
-#define  OS_EXIT_CRITICAL()   do { OS_CPU_IntDisMeasStop();    \
-                                   CPU_SR_Restore(cpu_sr); } while (0)
+#define  OS_ENTER_CRITICAL()  do { cpu_sr = CPU_SR_Save();                        \
+                                   if (OS_CPU_IntDisMeasEn != 0u) {               \
+                                       OS_CPU_IntDisMeasStart(cpu_sr);            \
+                                   }                                              } while (0)
+#define  OS_EXIT_CRITICAL()   do { if (OS_CPU_IntDisMeasEn != 0u) {               \
+                                       OS_CPU_IntDisMeasStop(cpu_sr);             \
+                                   }                                              \
+                                   CPU_SR_Restore(cpu_sr);                        } while (0)
 
 #else
 
@@ -172,12 +252,14 @@ typedef  CPU_SR      OS_CPU_SR;                /* Define size of CPU status regi
 
                                                                 /* Variables used to measure interrupt disable time     */
 #if OS_CPU_INT_DIS_MEAS_EN > 0u
-OS_CPU_EXT  INT16U   OS_CPU_IntDisMeasNestingCtr;
-OS_CPU_EXT  INT16U   OS_CPU_IntDisMeasCntsEnter;
-OS_CPU_EXT  INT16U   OS_CPU_IntDisMeasCntsExit;
-OS_CPU_EXT  INT16U   OS_CPU_IntDisMeasCntsMax;
-OS_CPU_EXT  INT16U   OS_CPU_IntDisMeasCntsDelta;
-OS_CPU_EXT  INT16U   OS_CPU_IntDisMeasCntsOvrhd;
+OS_CPU_EXT  volatile BOOLEAN  OS_CPU_IntDisMeasEn;              /* Measuring, see OS_CPU_IntDisMeasCtl()                */
+OS_CPU_EXT  INT64U   OS_CPU_IntDisMeasCntsEnter;                /* CNTVCT at the outermost OS_ENTER_CRITICAL(), 0: none */
+OS_CPU_EXT  void    *OS_CPU_IntDisMeasPcEnter;
+OS_CPU_EXT  INT64U   OS_CPU_IntDisMeasCntsDelta;                /* Last section, overhead removed                       */
+OS_CPU_EXT  INT64U   OS_CPU_IntDisMeasCntsOvrhd;
+OS_CPU_EXT  INT32U   OS_CPU_IntDisMeasCtr;                      /* Sections measured                                    */
+OS_CPU_EXT  OS_CPU_INT_DIS_SITE  OS_CPU_IntDisMeasMax;          /* Longest section overall                              */
+OS_CPU_EXT  OS_CPU_INT_DIS_SITE  OS_CPU_IntDisMeasSiteTbl[OS_CPU_INT_DIS_MEAS_SITES];
 #endif
 
 OS_CPU_EXT  OS_STK   OS_CPU_ExceptStk[OS_CPU_EXCEPT_STK_SIZE];
@@ -186,6 +268,15 @@ OS_CPU_EXT  OS_STK  *OS_CPU_ExceptStkPtr;
 
 OS_CPU_EXT  INT32U   OS_CPU_ARM_DRegCnt;                        /* VFP/NEON register count                              */
 
+OS_CPU_EXT  struct os_tcb  *OS_CPU_FP_Owner;                    /* Task whose state is in the FP/SIMD registers         */
+OS_CPU_EXT  BOOLEAN  OS_CPU_FP_KernelSw;                        /* In OSIntExit()/OSCtxSw() up to the switch hook       */
+
+                                                                /* ISR run time, outermost level (OS_TASK_PROFILE_EN)   */
+OS_CPU_EXT  INT64U   OS_CPU_IntCyclesTot;
+OS_CPU_EXT  INT64U   OS_CPU_IntCyclesMax;
+OS_CPU_EXT  INT32U   OS_CPU_IntCtr;
+OS_CPU_EXT  INT64U   OS_CPU_ProfCyclesStart;                    /* CNTVCT when the first task was started               */
+
 
 /*
 *********************************************************************************************************
@@ -224,12 +315,25 @@ OS_CPU_EXT  INT32U   OS_CPU_ARM_DRegCnt;                        /* VFP/NEON regi
 
 #if OS_CPU_INT_DIS_MEAS_EN > 0u
     void       OS_CPU_IntDisMeasInit              (void);
-    void       OS_CPU_IntDisMeasStart             (void);
-    void       OS_CPU_IntDisMeasStop              (void);
-    INT16U     OS_CPU_IntDisMeasTmrRd             (void);
+    void       OS_CPU_IntDisMeasCtl               (BOOLEAN    en);
+    void       OS_CPU_IntDisMeasStart             (OS_CPU_SR  cpu_sr);
+    void       OS_CPU_IntDisMeasStop              (OS_CPU_SR  cpu_sr);
 #endif
 
     CPU_INT64U  OS_CPU_SPSRGet             (void);
     CPU_INT64U  OS_CPU_SIMDGet             (void);
 
+    void       OS_CPU_FP_En                       (void);
+    void       OS_CPU_FP_Dis                      (void);
+    void       OS_CPU_FP_Save                     (OS_CPU_FP_CTX  *p_ctx);
+    void       OS_CPU_FP_Restore                  (OS_CPU_FP_CTX  *p_ctx);
+    void       OS_CPU_FP_Trap                     (void);
+    void       OS_CPU_FP_ExcExit                  (void);
+    void       OS_CPU_ARM_ExceptFpTrap            (void);
+
+    void       OS_CPU_IntProfEnter                (void);
+    void       OS_CPU_IntProfExit                 (void);
+    struct     os_task_prof;                                    /* OS_TASK_PROF, see uCOS_II.H                          */
+    void       OS_CPU_IntProfGet                  (struct os_task_prof  *p_prof);
+
 #endif
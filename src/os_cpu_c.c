@@ -43,6 +43,7 @@
 
 #define  OS_CPU_GLOBALS
 #include <ucos_ii.h>
+#include <bsp_os.h>
 
 
 /*
@@ -62,6 +63,14 @@
 static  INT16U  OSTmrCtr;
 #endif
 
+#if OS_TASK_PROFILE_EN > 0u
+static  INT64U  OS_CPU_IntCyclesStart;                          /* CNTVCT at entry to the outermost IRQ level           */
+#endif
+
+#if OS_CPU_INT_DIS_MEAS_EN > 0u
+static  INT64U  OS_CPU_IntDisMeasSiteMin;                       /* Shortest section in OS_CPU_IntDisMeasSiteTbl[]       */
+#endif
+
 
 /*
 *********************************************************************************************************
@@ -136,6 +145,17 @@ void  OSInitHookEnd (void)
 #if OS_CPU_HOOKS_EN > 0u
 void  OSTaskCreateHook (OS_TCB *ptcb)
 {
+    OS_CPU_FP_CTX  *p_ctx;
+    INT32U          i;
+
+
+    p_ctx = &ptcb->OSTCBFpCtx;                                 /* Task starts with a clean FP/SIMD state     */
+    for (i = 0u; i < 64u; i++) {
+        p_ctx->Q[i] = 0u;
+    }
+    p_ctx->FPSR = 0u;
+    p_ctx->FPCR = 0u;
+
 #if OS_APP_HOOKS_EN > 0u
     App_TaskCreateHook(ptcb);
 #else
@@ -161,6 +181,10 @@ void  OSTaskCreateHook (OS_TCB *ptcb)
 #if OS_CPU_HOOKS_EN > 0u
 void  OSTaskDelHook (OS_TCB *ptcb)
 {
+    if (OS_CPU_FP_Owner == ptcb) {                          /* Registers of a dead task need no saving    */
+        OS_CPU_FP_Owner = (OS_TCB *)0;
+    }
+
 #if OS_APP_HOOKS_EN > 0u
     App_TaskDelHook(ptcb);
 #else
@@ -189,6 +213,9 @@ void  OSTaskIdleHook (void)
 #if OS_APP_HOOKS_EN > 0u
     App_TaskIdleHook();
 #endif
+#if OS_TICKLESS_EN > 0u
+    BSP_OS_TickSuppress();                                  /* Sleep until the next timeout             */
+#endif
 }
 #endif
 
@@ -445,6 +472,14 @@ OS_STK  *OSTaskStkInit (void (*task)(void  *p_arg),
 *                             +---------------+---------------------+
 *                             | OSPrioHighRdy | OSTCBHighRdy[23..0] |
 *                             +---------------+---------------------+
+*
+*              4) With OS_TASK_PROFILE_EN, the outgoing task is charged for the cycles since it was switched
+*                 in or last returned from an ISR.  It counts as preempted if it is still ready to run.
+*                 The first call, from OSStartHighRdy(), only starts the clock.
+*              5) The switch is recorded in the trace ring (see OS_TRACE.H) as (prio out, prio in).
+*              6) The FP/SIMD unit is opened or closed for the incoming task last, after every other hook:
+*                 an FP/SIMD trap taken earlier in the switch is kernel scratch use (OS_CPU_FP_Trap()) and
+*                 leaves the unit open with no owner.  OS_CPU_FP_KernelSw ends here.
 *********************************************************************************************************
 */
 
@@ -453,13 +488,45 @@ void  OSTaskSwHook (void)
 
 {
 #if OS_CFG_DBG_EN > 0u
-    INT32U  ctx_id;
+    INT32U   ctx_id;
+#endif
+#if OS_TASK_PROFILE_EN > 0u
+    OS_TCB  *ptcb;
+    INT64U   now;
+#endif
+
+
+    OS_TRACE_TASK_SW(OSTCBCur->OSTCBPrio, OSTCBHighRdy->OSTCBPrio);   /* See Note #5                */
+
+#if OS_TASK_PROFILE_EN > 0u
+    now  = OS_CPU_CyclesGet();
+    ptcb = OSTCBCur;
+    if (OSRunning == OS_TRUE) {
+        ptcb->OSTCBCyclesTot += now - ptcb->OSTCBCyclesStart;
+        ptcb->OSTCBCyclesRun += now - ptcb->OSTCBCyclesStart;
+        if (ptcb->OSTCBCyclesRun > ptcb->OSTCBCyclesMax) {
+            ptcb->OSTCBCyclesMax = ptcb->OSTCBCyclesRun;
+        }
+        ptcb->OSTCBCyclesRun = 0u;
+        if ((ptcb->OSTCBStat == OS_STAT_RDY) && (ptcb->OSTCBDly == 0u)) {
+            ptcb->OSTCBPreemptCtr++;                        /* Switched out while still ready             */
+        }
+    } else {
+        OS_CPU_ProfCyclesStart = now;
+    }
+    OSTCBHighRdy->OSTCBCyclesStart = now;
 #endif
 
 #if OS_APP_HOOKS_EN > 0u
     App_TaskSwHook();
 #endif
 
+    if (OSTCBHighRdy == OS_CPU_FP_Owner) {                  /* FP/SIMD regs already hold its state        */
+        OS_CPU_FP_En();
+    } else {                                                /* Trap first FP/SIMD use (lazy switch)       */
+        OS_CPU_FP_Dis();
+    }
+    OS_CPU_FP_KernelSw = OS_FALSE;                          /* See Note #6                                */
 }
 #endif
 
@@ -518,48 +585,341 @@ void  OSTimeTickHook (void)
 
 /*
 *********************************************************************************************************
-*                             INTERRUPT DISABLE TIME MEASUREMENT, START
+*                                    LAZY FP/SIMD CONTEXT SWITCH TRAP
+*
+* Description: This function is called from OS_CPU_ARM_ExceptFpTrap when an FP/SIMD instruction traps
+*              because CPACR_EL1.FPEN is closed.  It hands the FP/SIMD register file to the code that
+*              trapped:
+*
+*              a) From a task: the registers of the previous owner are saved in its OS_CPU_FP_CTX, those
+*                 of the current task are restored and the current task becomes the owner.
+*
+*              b) From an ISR: the registers of the owner are saved and the ISR uses the unit as scratch.
+*                 OS_CPU_FP_ExcExit() closes the unit again on the way out, so the interrupted task
+*                 restores its state on its next FP/SIMD instruction.
+*
+*              c) From the switch path (OS_CPU_FP_KernelSw set): OSIntExit() has already dropped
+*                 OSIntNesting to 0, and OSCtxSw() has already saved the outgoing task's integer frame,
+*                 but neither the scheduler nor the hooks run on behalf of OSTCBCur.  This is handled
+*                 like b): the owner is parked and the unit is scratch.  OSTaskSwHook() or
+*                 OS_CPU_FP_ExcExit() then closes the unit for whichever task runs next.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts are disabled during this call (synchronous exception entry).
+*              2) This function MUST NOT touch FP/SIMD registers itself before the unit is opened, hence
+*                 general-regs-only.
+*              3) A task created with OS_TASK_OPT_NO_FP that executes an FP/SIMD instruction is a fatal
+*                 error: it would corrupt the state of the owner without being able to save its own.
 *********************************************************************************************************
 */
 
-#if OS_CPU_INT_DIS_MEAS_EN > 0u
-void  OS_CPU_IntDisMeasInit (void)
+__attribute__((target("general-regs-only")))
+void  OS_CPU_FP_Trap (void)
 {
-    OS_CPU_IntDisMeasNestingCtr = 0u;
-    OS_CPU_IntDisMeasCntsEnter  = 0u;
-    OS_CPU_IntDisMeasCntsExit   = 0u;
-    OS_CPU_IntDisMeasCntsMax    = 0u;
-    OS_CPU_IntDisMeasCntsDelta  = 0u;
-    OS_CPU_IntDisMeasCntsOvrhd  = 0u;
-    OS_CPU_IntDisMeasStart();                              /* Measure the overhead of the functions    */
-    OS_CPU_IntDisMeasStop();
-    OS_CPU_IntDisMeasCntsOvrhd  = OS_CPU_IntDisMeasCntsDelta;
+    OS_TCB   *ptcb;
+    BOOLEAN   scratch;
+
+
+    OS_CPU_FP_En();
+    ptcb    = OSTCBCur;
+    scratch = (BOOLEAN)((OSIntNesting > 0u) || (OS_CPU_FP_KernelSw == OS_TRUE) || (OSRunning != OS_TRUE));
+    if ((scratch == OS_FALSE) && (OS_CPU_FP_Owner == ptcb)) {  /* Spurious: unit was closed for the owner    */
+        return;
+    }
+    if (OS_CPU_FP_Owner != (OS_TCB *)0) {                   /* Park the owner's registers                 */
+        OS_CPU_FP_Save(&OS_CPU_FP_Owner->OSTCBFpCtx);
+        OS_CPU_FP_Owner = (OS_TCB *)0;
+    }
+    if (scratch == OS_TRUE) {                               /* ISR or switch path: nobody owns the unit   */
+        return;
+    }
+#if OS_TASK_CREATE_EXT_EN > 0u
+    if ((ptcb->OSTCBOpt & OS_TASK_OPT_NO_FP) != 0u) {
+        uart_puts("OS_CPU_FP_Trap: FP/SIMD used by OS_TASK_OPT_NO_FP task, prio ");
+        uart_puthex(ptcb->OSTCBPrio);
+        uart_puts("\n");
+        while (1) {
+            ;
+        }
+    }
+#endif
+    OS_CPU_FP_Restore(&ptcb->OSTCBFpCtx);
+    OS_CPU_FP_Owner = ptcb;
+}
+
+
+/*
+*********************************************************************************************************
+*                                  LAZY FP/SIMD, INTERRUPT EXIT
+*
+* Description: This function is called by OS_CPU_ARM_ExceptIrqHndlr before returning to the interrupted
+*              task (when OSIntExit() did not switch tasks).  It leaves the FP/SIMD unit open only if
+*              the task still owns the registers.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts are disabled during this call.
+*********************************************************************************************************
+*/
+
+__attribute__((target("general-regs-only")))
+void  OS_CPU_FP_ExcExit (void)
+{
+    if (OSIntNesting != 0u) {
+        return;
+    }
+    OS_CPU_FP_KernelSw = OS_FALSE;                          /* OSIntExit() did not switch                 */
+    if (OSTCBCur == OS_CPU_FP_Owner) {
+        OS_CPU_FP_En();
+    } else {
+        OS_CPU_FP_Dis();
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                     ISR RUN TIME, ENTER AND EXIT
+*
+* Description: OS_CPU_ARM_ExceptIrqHndlr calls OS_CPU_IntProfEnter() on entry to the outermost IRQ level
+*              and OS_CPU_IntProfExit() just before OSIntExit().  The cycles in between are charged to
+*              the ISR account instead of the interrupted task.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts are disabled during these calls.
+*              2) Nested IRQs are part of the outermost ISR's time.
+*              3) OSIntExit() itself, and a switch it makes, are charged to the interrupted task; from
+*                 there on OSTaskSwHook() does the accounting.
+*********************************************************************************************************
+*/
+
+__attribute__((target("general-regs-only")))
+void  OS_CPU_IntProfEnter (void)
+{
+#if OS_TASK_PROFILE_EN > 0u
+    OS_TCB  *ptcb;
+    INT64U   now;
+
+
+    now                   = OS_CPU_CyclesGet();
+    ptcb                  = OSTCBCur;
+    ptcb->OSTCBCyclesTot += now - ptcb->OSTCBCyclesStart;   /* Close the interrupted task's slice         */
+    ptcb->OSTCBCyclesRun += now - ptcb->OSTCBCyclesStart;
+    OS_CPU_IntCyclesStart = now;
+#endif
 }
 
 
-void  OS_CPU_IntDisMeasStart (void)
+__attribute__((target("general-regs-only")))
+void  OS_CPU_IntProfExit (void)
 {
-    OS_CPU_IntDisMeasNestingCtr++;
-    if (OS_CPU_IntDisMeasNestingCtr == 1u) {               /* Only measure at the first nested level   */
-        OS_CPU_IntDisMeasCntsEnter = OS_CPU_IntDisMeasTmrRd();
+#if OS_TASK_PROFILE_EN > 0u
+    INT64U  now;
+    INT64U  cycles;
+
+
+    now                 = OS_CPU_CyclesGet();
+    cycles              = now - OS_CPU_IntCyclesStart;
+    OS_CPU_IntCyclesTot += cycles;
+    if (cycles > OS_CPU_IntCyclesMax) {
+        OS_CPU_IntCyclesMax = cycles;
     }
+    OS_CPU_IntCtr++;
+    OSTCBCur->OSTCBCyclesStart = now;                       /* Interrupted task resumes its slice         */
+#endif
 }
 
 
-void  OS_CPU_IntDisMeasStop (void)
+/*
+*********************************************************************************************************
+*                                         GET ISR RUN TIME
+*
+* Description: This function returns the ISR accounting in the same form as OSTaskProfGet().
+*
+* Arguments  : p_prof   is a pointer to the structure that receives the counts.  OSCtxSwCtr is the number
+*                       of (outermost) IRQs taken, OSCyclesMax the longest one; OSPreemptCtr is unused.
+*
+* Note(s)    : none.
+*********************************************************************************************************
+*/
+
+#if OS_TASK_PROFILE_EN > 0u
+void  OS_CPU_IntProfGet (OS_TASK_PROF  *p_prof)
 {
-    OS_CPU_IntDisMeasNestingCtr--;                                      /* Decrement nesting ctr       */
-    if (OS_CPU_IntDisMeasNestingCtr == 0u) {
-        OS_CPU_IntDisMeasCntsExit  = OS_CPU_IntDisMeasTmrRd();
-        OS_CPU_IntDisMeasCntsDelta = OS_CPU_IntDisMeasCntsExit - OS_CPU_IntDisMeasCntsEnter;
-        if (OS_CPU_IntDisMeasCntsDelta > OS_CPU_IntDisMeasCntsOvrhd) {  /* Ensure overhead < delta     */
-            OS_CPU_IntDisMeasCntsDelta -= OS_CPU_IntDisMeasCntsOvrhd;
-        } else {
-            OS_CPU_IntDisMeasCntsDelta  = OS_CPU_IntDisMeasCntsOvrhd;
+#if OS_CRITICAL_METHOD == 3u
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+    OS_ENTER_CRITICAL();
+    p_prof->OSCtxSwCtr   = OS_CPU_IntCtr;
+    p_prof->OSPreemptCtr = 0u;
+    p_prof->OSCyclesTot  = OS_CPU_IntCyclesTot;
+    p_prof->OSCyclesMax  = OS_CPU_IntCyclesMax;
+    OS_EXIT_CRITICAL();
+}
+#endif
+
+
+/*
+*********************************************************************************************************
+*                                  INTERRUPT DISABLE TIME MEASUREMENT
+*
+* Description: OS_ENTER_CRITICAL() and OS_EXIT_CRITICAL() call these functions while OS_CPU_IntDisMeasEn
+*              is set.  They time every section that takes the CPU from IRQs enabled to IRQs disabled and
+*              back, on CNTVCT_EL0, and remember where the longest ones started and ended.
+*
+*              OS_CPU_IntDisMeasInit()    clears the results and measures the overhead of a Start/Stop
+*                                         pair, which is then subtracted from every section.
+*              OS_CPU_IntDisMeasCtl()     switches measuring on (clearing the results) or off.
+*
+* Arguments  : cpu_sr   is the value CPU_SR_Save() returned in OS_ENTER_CRITICAL(), i.e. the IRQ mask state
+*                       the section started from and that OS_EXIT_CRITICAL() goes back to.
+*
+* Note(s)    : 1) Nesting needs no counter: only a Start from an IRQs-enabled state opens a section and
+*                 only a Stop that re-enables IRQs closes one.  The IRQ entry masks IRQs without going
+*                 through OS_ENTER_CRITICAL(), so OSIntExit() and the ISR prologue are not counted here;
+*                 their cost shows in the ISR run time (OS_CPU_IntProfEnter()/Exit()).
+*
+*              2) A section may span a context switch: OS_Sched() opens it in one task and the task
+*                 switched in closes it from its own OS_Sched().  A task that had been preempted by an
+*                 IRQ resumes through ERET instead, so that one section is dropped; the next Start
+*                 overwrites it.
+*
+*              3) Call sites are return addresses into the functions that expanded the macros.  Resolve
+*                 them with 'addr2line -f -e bin/kernel.elf <pc>'.  Start and Stop are noinline: inlined
+*                 by -flto into a caller, __builtin_return_address(0) would name the caller's caller, and
+*                 the overhead measured by OS_CPU_IntDisMeasInit() would not match real sections.
+*
+*              4) OS_CPU_IntDisMeasSiteTbl[] keeps the longest section of each of the worst
+*                 OS_CPU_INT_DIS_MEAS_SITES entry sites.  It is only searched when a section beats its
+*                 shortest entry, which is rare once the table has filled.
+*********************************************************************************************************
+*/
+
+#if OS_CPU_INT_DIS_MEAS_EN > 0u
+static  void  OS_CPU_IntDisMeasSiteUpd (void    *pc_enter,
+                                        void    *pc_exit,
+                                        INT64U   cnts)
+{
+    OS_CPU_INT_DIS_SITE  *psite;
+    INT64U                cnts_min;
+    INT8U                 i;
+
+
+    psite = (OS_CPU_INT_DIS_SITE *)0;
+    for (i = 0u; i < OS_CPU_INT_DIS_MEAS_SITES; i++) {      /* Known site?                                */
+        if (OS_CPU_IntDisMeasSiteTbl[i].PcEnter == pc_enter) {
+            psite = &OS_CPU_IntDisMeasSiteTbl[i];
+            break;
         }
-        if (OS_CPU_IntDisMeasCntsDelta > OS_CPU_IntDisMeasCntsMax) {    /* Track MAXIMUM               */
-            OS_CPU_IntDisMeasCntsMax = OS_CPU_IntDisMeasCntsDelta;
+    }
+    if (psite == (OS_CPU_INT_DIS_SITE *)0) {                /* No: evict the shortest entry               */
+        psite = &OS_CPU_IntDisMeasSiteTbl[0];
+        for (i = 1u; i < OS_CPU_INT_DIS_MEAS_SITES; i++) {
+            if (OS_CPU_IntDisMeasSiteTbl[i].CntsMax < psite->CntsMax) {
+                psite = &OS_CPU_IntDisMeasSiteTbl[i];
+            }
         }
+        psite->PcEnter = pc_enter;
+        psite->CntsMax = 0u;
+    }
+    if (cnts > psite->CntsMax) {
+        psite->PcExit  = pc_exit;
+        psite->CntsMax = cnts;
+    }
+
+    cnts_min = OS_CPU_IntDisMeasSiteTbl[0].CntsMax;
+    for (i = 1u; i < OS_CPU_INT_DIS_MEAS_SITES; i++) {
+        if (OS_CPU_IntDisMeasSiteTbl[i].CntsMax < cnts_min) {
+            cnts_min = OS_CPU_IntDisMeasSiteTbl[i].CntsMax;
+        }
+    }
+    OS_CPU_IntDisMeasSiteMin = cnts_min;
+}
+
+
+void  OS_CPU_IntDisMeasInit (void)
+{
+    INT8U  i;
+
+
+    OS_CPU_IntDisMeasCntsOvrhd   = 0u;
+    OS_CPU_IntDisMeasStart(0u);                             /* Measure the overhead of the functions      */
+    OS_CPU_IntDisMeasStop(0u);
+    OS_CPU_IntDisMeasCntsOvrhd   = OS_CPU_IntDisMeasCntsDelta;
+
+    OS_CPU_IntDisMeasCntsEnter   = 0u;
+    OS_CPU_IntDisMeasCntsDelta   = 0u;
+    OS_CPU_IntDisMeasCtr         = 0u;
+    OS_CPU_IntDisMeasMax.PcEnter = (void *)0;
+    OS_CPU_IntDisMeasMax.PcExit  = (void *)0;
+    OS_CPU_IntDisMeasMax.CntsMax = 0u;
+    for (i = 0u; i < OS_CPU_INT_DIS_MEAS_SITES; i++) {
+        OS_CPU_IntDisMeasSiteTbl[i].PcEnter = (void *)0;
+        OS_CPU_IntDisMeasSiteTbl[i].PcExit  = (void *)0;
+        OS_CPU_IntDisMeasSiteTbl[i].CntsMax = 0u;
+    }
+    OS_CPU_IntDisMeasSiteMin     = 0u;
+}
+
+
+void  OS_CPU_IntDisMeasCtl (BOOLEAN  en)
+{
+    OS_CPU_SR  cpu_sr;
+
+
+    cpu_sr = CPU_SR_Save();                                 /* Not OS_ENTER_CRITICAL(), it would measure  */
+    OS_CPU_IntDisMeasEn = OS_FALSE;
+    if (en != OS_FALSE) {
+        OS_CPU_IntDisMeasInit();
+    }
+    OS_CPU_IntDisMeasEn = en;
+    CPU_SR_Restore(cpu_sr);
+}
+
+
+__attribute__((noinline))
+void  OS_CPU_IntDisMeasStart (OS_CPU_SR  cpu_sr)
+{
+    if ((cpu_sr & OS_CPU_SR_IRQ_MASK) == 0u) {              /* Outermost: IRQs were enabled (Note #1)     */
+        OS_CPU_IntDisMeasPcEnter   = __builtin_return_address(0);
+        OS_CPU_IntDisMeasCntsEnter = OS_CPU_CyclesGet();
+    }
+}
+
+
+__attribute__((noinline))
+void  OS_CPU_IntDisMeasStop (OS_CPU_SR  cpu_sr)
+{
+    INT64U   cnts;
+    void    *pc_exit;
+
+
+    if (((cpu_sr & OS_CPU_SR_IRQ_MASK) != 0u) ||            /* IRQs stay disabled after this exit         */
+        (OS_CPU_IntDisMeasCntsEnter == 0u)) {               /* No Start seen (see Note #2)                */
+        return;
+    }
+    cnts                       = OS_CPU_CyclesGet() - OS_CPU_IntDisMeasCntsEnter;
+    OS_CPU_IntDisMeasCntsEnter = 0u;
+    if (cnts > OS_CPU_IntDisMeasCntsOvrhd) {                /* Ensure overhead < delta                    */
+        cnts -= OS_CPU_IntDisMeasCntsOvrhd;
+    } else {
+        cnts  = 0u;
+    }
+    OS_CPU_IntDisMeasCntsDelta = cnts;
+    OS_CPU_IntDisMeasCtr++;
+
+    pc_exit = __builtin_return_address(0);
+    if (cnts > OS_CPU_IntDisMeasMax.CntsMax) {              /* Track MAXIMUM                              */
+        OS_CPU_IntDisMeasMax.PcEnter = OS_CPU_IntDisMeasPcEnter;
+        OS_CPU_IntDisMeasMax.PcExit  = pc_exit;
+        OS_CPU_IntDisMeasMax.CntsMax = cnts;
+    }
+    if (cnts > OS_CPU_IntDisMeasSiteMin) {                  /* See Note #4                                */
+        OS_CPU_IntDisMeasSiteUpd(OS_CPU_IntDisMeasPcEnter, pc_exit, cnts);
     }
 }
 #endif
@@ -1047,7 +1047,7 @@ static  void  OS_FlagBlock (OS_FLAG_GRP  *pgrp,
 
     OSTCBCur->OSTCBStat      |= OS_STAT_FLAG;
     OSTCBCur->OSTCBStatPend   = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly        = timeout;              /* Store timeout in task's TCB                   */
+    OS_TickListInsert(OSTCBCur, timeout);             /* Store timeout in tick list                    */
 #if OS_TASK_DEL_EN > 0u
     OSTCBCur->OSTCBFlagNode   = pnode;                /* TCB to link to node                           */
 #endif
@@ -1162,7 +1162,7 @@ static  BOOLEAN  OS_FlagTaskRdy (OS_FLAG_NODE *pnode,
 
 
     ptcb                 = (OS_TCB *)pnode->OSFlagNodeTCB; /* Point to TCB of waiting task             */
-    ptcb->OSTCBDly       = 0u;
+    OS_TickListRemove(ptcb);
     ptcb->OSTCBFlagsRdy  = flags_rdy;
     ptcb->OSTCBStat     &= (INT8U)~(INT8U)OS_STAT_FLAG;
     ptcb->OSTCBStatPend  = pend_stat;
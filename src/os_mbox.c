@@ -331,7 +331,7 @@ void  *OSMboxPend (OS_EVENT  *pevent,
     }
     OSTCBCur->OSTCBStat     |= OS_STAT_MBOX;          /* Message not available, task will pend         */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;               /* Load timeout in TCB                           */
+    OS_TickListInsert(OSTCBCur, timeout);              /* Load timeout in tick list                     */
     OS_EventTaskWait(pevent);                         /* Suspend task until event or timeout occurs    */
     OS_EXIT_CRITICAL();
     OS_Sched();                                       /* Find next highest priority task ready to run  */
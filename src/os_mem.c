@@ -460,3 +460,264 @@ void  OS_MemInit (void)
 #endif
 }
 #endif                                                    /* OS_MEM_EN                                 */
+
+#if (OS_MEM_EN > 0u) && (OS_MEM_LF_EN > 0u)
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                     LOCK-FREE MEMORY PARTITIONS
+*
+* Note(s) : (1) An OS_MEM_LF partition keeps its free blocks on a stack linked through the first word of
+*               each block, like OS_MEM, but never disables interrupts: the top of the stack and a tag
+*               are replaced together with OS_CPU_CAS2().  Every push and pop bumps the tag, so a swap
+*               based on an old snapshot fails even when the same block is back on top (the ABA problem)
+*               and the caller retries.
+*
+*           (2) The functions may be called from tasks, from ISRs and from any core.  They never block
+*               and never mask interrupts, so they add nothing to interrupt latency; a retry only costs
+*               time when another context changed the stack in between.
+*
+*           (3) The snapshot of {top, tag} is taken with two plain loads and may be torn, in which case
+*               the swap fails.  Following the links of a snapshot that has gone stale may read a block
+*               some other context now owns; every link is checked to lie inside the partition before it
+*               is followed, and the swap rejects the result.
+*
+*           (4) The control block is supplied by the caller, so these partitions do not count against
+*               OS_MAX_MEM_PART.  Unlike OSMemPut(), OSMemLFPut() cannot detect a block being returned
+*               twice.
+*********************************************************************************************************
+*/
+
+static  BOOLEAN  OS_MemLFOwns (OS_MEM_LF  *pmem,
+                               void       *pblk)
+{
+    INT8U  *pstart;
+
+
+    pstart = (INT8U *)pmem->OSMemLFAddr;
+    return ((BOOLEAN)(((INT8U *)pblk >= pstart) &&
+                      ((INT8U *)pblk <  pstart + (INT64U)pmem->OSMemLFNBlks * pmem->OSMemLFBlkSize)));
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                 CREATE A LOCK-FREE MEMORY PARTITION
+*
+* Description : Create a fixed-sized memory partition whose blocks are obtained and released without
+*               disabling interrupts.
+*
+* Arguments   : pmem     is a pointer to the caller-allocated partition control block.
+*
+*               addr     is the starting address of the memory partition
+*
+*               nblks    is the number of memory blocks to create from the partition.
+*
+*               blksize  is the size (in bytes) of each block in the memory partition.
+*
+* Returns     : OS_ERR_NONE              if the memory partition has been created correctly.
+*               OS_ERR_MEM_INVALID_PMEM  if you passed a NULL pointer for 'pmem'
+*               OS_ERR_MEM_INVALID_ADDR  if 'addr' is NULL or not aligned on a pointer boundary
+*               OS_ERR_MEM_INVALID_BLKS  user specified an invalid number of blocks (must be >= 2)
+*               OS_ERR_MEM_INVALID_SIZE  user specified an invalid block size
+*                                          - must be greater than the size of a pointer
+*                                          - must be able to hold an integral number of pointers
+*
+* Note(s)     : 1) The partition must not be in use while it is being created.
+*********************************************************************************************************
+*/
+
+INT8U  OSMemLFCreate (OS_MEM_LF  *pmem,
+                      void       *addr,
+                      INT32U      nblks,
+                      INT32U      blksize)
+{
+    INT8U    *pblk;
+    INT32U    i;
+
+
+#ifdef OS_SAFETY_CRITICAL_IEC61508
+    if (OSSafetyCriticalStartFlag == OS_TRUE) {
+        OS_SAFETY_CRITICAL_EXCEPTION();
+        return (OS_ERR_ILLEGAL_CREATE_RUN_TIME);
+    }
+#endif
+
+#if OS_ARG_CHK_EN > 0u
+    if (pmem == (OS_MEM_LF *)0) {
+        return (OS_ERR_MEM_INVALID_PMEM);
+    }
+    if ((addr == (void *)0) ||
+        (((INT64U)addr & (sizeof(void *) - 1u)) != 0u)) {
+        return (OS_ERR_MEM_INVALID_ADDR);
+    }
+    if (nblks < 2u) {
+        return (OS_ERR_MEM_INVALID_BLKS);
+    }
+    if ((blksize < sizeof(void *)) ||
+        ((blksize & (sizeof(void *) - 1u)) != 0u)) {
+        return (OS_ERR_MEM_INVALID_SIZE);
+    }
+#endif
+    pblk = (INT8U *)addr;                             /* Chain the blocks, first block on top          */
+    for (i = 0u; i < (nblks - 1u); i++) {
+        *(void **)pblk = (void *)(pblk + blksize);
+        pblk          += blksize;
+    }
+    *(void **)pblk        = (void *)0;
+
+    pmem->OSMemLFAddr     = addr;
+    pmem->OSMemLFBlkSize  = blksize;
+    pmem->OSMemLFNBlks    = nblks;
+    pmem->OSMemLFNFree    = nblks;
+    pmem->OSMemLFTag      = 0u;
+    __atomic_store_n(&pmem->OSMemLFFreeList, addr, __ATOMIC_RELEASE);
+    return (OS_ERR_NONE);
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                              GET MEMORY BLOCKS FROM A LOCK-FREE PARTITION
+*
+* Description : OSMemLFGetBatch() takes up to 'nbr' blocks off the partition with a single swap.
+*               OSMemLFGet() takes one.
+*
+* Arguments   : pmem     is a pointer to the partition control block
+*
+*               pblks    is an array that receives the blocks.
+*
+*               nbr      is the number of blocks wanted.
+*
+* Returns     : OSMemLFGetBatch() returns the number of blocks stored in 'pblks', 0 if the partition is
+*               empty.  OSMemLFGet() returns a block, or NULL if the partition is empty.
+*
+* Note(s)     : 1) May be called from an ISR.  See the notes at the top of the lock-free section.
+*********************************************************************************************************
+*/
+
+INT32U  OSMemLFGetBatch (OS_MEM_LF   *pmem,
+                         void       **pblks,
+                         INT32U       nbr)
+{
+    void    *ptop;
+    void    *pnext;
+    INT64U   tag;
+    INT32U   n;
+
+
+#if OS_ARG_CHK_EN > 0u
+    if ((pmem == (OS_MEM_LF *)0) || (pblks == (void **)0)) {
+        return (0u);
+    }
+#endif
+    if (nbr == 0u) {
+        return (0u);
+    }
+
+    do {
+        tag   = __atomic_load_n(&pmem->OSMemLFTag,      __ATOMIC_ACQUIRE);
+        ptop  = __atomic_load_n(&pmem->OSMemLFFreeList, __ATOMIC_ACQUIRE);
+        pnext = ptop;
+        for (n = 0u; (n < nbr) && (pnext != (void *)0); n++) {
+            if (OS_MemLFOwns(pmem, pnext) == 0u) {    /* Stale snapshot, see Note #3                   */
+                break;
+            }
+            pblks[n] = pnext;
+            pnext    = __atomic_load_n((void **)pnext, __ATOMIC_RELAXED);
+        }
+        if (ptop == (void *)0) {                      /* Partition empty                               */
+            return (0u);
+        }
+    } while ((n == 0u) ||
+             (OS_CPU_CAS2(&pmem->OSMemLFFreeList, (INT64U)ptop, tag, (INT64U)pnext, tag + 1u) == 0u));
+
+    (void)__atomic_fetch_sub(&pmem->OSMemLFNFree, n, __ATOMIC_RELAXED);
+    return (n);
+}
+
+
+void  *OSMemLFGet (OS_MEM_LF  *pmem)
+{
+    void  *pblk;
+
+
+    if (OSMemLFGetBatch(pmem, &pblk, 1u) == 0u) {
+        return ((void *)0);
+    }
+    return (pblk);
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                             RETURN MEMORY BLOCKS TO A LOCK-FREE PARTITION
+*
+* Description : OSMemLFPutBatch() links 'nbr' blocks together and pushes them with a single swap.
+*               OSMemLFPut() returns one block.
+*
+* Arguments   : pmem     is a pointer to the partition control block
+*
+*               pblks    is an array of the blocks being released.
+*
+*               nbr      is the number of blocks in 'pblks'.
+*
+*               pblk     is a pointer to the memory block being released.
+*
+* Returns     : OS_ERR_NONE              if the blocks were returned to the partition
+*               OS_ERR_MEM_INVALID_PMEM  if you passed a NULL pointer for 'pmem'
+*               OS_ERR_MEM_INVALID_PBLK  if a block is NULL or does not belong to the partition
+*
+* Note(s)     : 1) May be called from an ISR.  See the notes at the top of the lock-free section.
+*
+*               2) Once the call returns the blocks belong to the partition.  If a block check fails no
+*                  block is returned.
+*********************************************************************************************************
+*/
+
+INT8U  OSMemLFPutBatch (OS_MEM_LF   *pmem,
+                        void       **pblks,
+                        INT32U       nbr)
+{
+    void    *ptop;
+    INT64U   tag;
+    INT32U   i;
+
+
+#if OS_ARG_CHK_EN > 0u
+    if (pmem == (OS_MEM_LF *)0) {
+        return (OS_ERR_MEM_INVALID_PMEM);
+    }
+    if ((pblks == (void **)0) && (nbr > 0u)) {
+        return (OS_ERR_MEM_INVALID_PBLK);
+    }
+    for (i = 0u; i < nbr; i++) {
+        if ((pblks[i] == (void *)0) || (OS_MemLFOwns(pmem, pblks[i]) == 0u)) {
+            return (OS_ERR_MEM_INVALID_PBLK);
+        }
+    }
+#endif
+    if (nbr == 0u) {
+        return (OS_ERR_NONE);
+    }
+
+    for (i = 0u; i < (nbr - 1u); i++) {               /* Chain the batch, still private to the caller  */
+        *(void **)pblks[i] = pblks[i + 1u];
+    }
+    do {
+        tag  = __atomic_load_n(&pmem->OSMemLFTag,      __ATOMIC_ACQUIRE);
+        ptop = __atomic_load_n(&pmem->OSMemLFFreeList, __ATOMIC_ACQUIRE);
+        *(void **)pblks[nbr - 1u] = ptop;             /* Published by the release in OS_CPU_CAS2()     */
+    } while (OS_CPU_CAS2(&pmem->OSMemLFFreeList, (INT64U)ptop, tag, (INT64U)pblks[0], tag + 1u) == 0u);
+
+    (void)__atomic_fetch_add(&pmem->OSMemLFNFree, nbr, __ATOMIC_RELAXED);
+    return (OS_ERR_NONE);
+}
+
+
+INT8U  OSMemLFPut (OS_MEM_LF  *pmem,
+                   void       *pblk)
+{
+    return (OSMemLFPutBatch(pmem, &pblk, 1u));
+}
+#endif                                                    /* OS_MEM_LF_EN                              */
@@ -517,15 +517,10 @@ void  OSMutexPend (OS_EVENT  *pevent,
                     rdy = OS_FALSE;                        /* No                                       */
                 }
                 ptcb->OSTCBPrio = pcp;                     /* Change owner task prio to PCP            */
-#if OS_LOWEST_PRIO <= 63u
-                ptcb->OSTCBY    = (INT8U)( ptcb->OSTCBPrio >> 3u);
-                ptcb->OSTCBX    = (INT8U)( ptcb->OSTCBPrio & 0x07u);
-#else
-                ptcb->OSTCBY    = (INT8U)((INT8U)(ptcb->OSTCBPrio >> 4u) & 0xFFu);
-                ptcb->OSTCBX    = (INT8U)( ptcb->OSTCBPrio & 0x0Fu);
-#endif
-                ptcb->OSTCBBitY = (OS_PRIO)(1uL << ptcb->OSTCBY);
-                ptcb->OSTCBBitX = (OS_PRIO)(1uL << ptcb->OSTCBX);
+                ptcb->OSTCBY    = (INT8U)(ptcb->OSTCBPrio >> OS_PRIO_ROW_SHIFT);
+                ptcb->OSTCBX    = (INT8U)(ptcb->OSTCBPrio &  OS_PRIO_ROW_MSK);
+                ptcb->OSTCBBitY = (OS_PRIO)((OS_PRIO)1u << ptcb->OSTCBY);
+                ptcb->OSTCBBitX = (OS_PRIO)((OS_PRIO)1u << ptcb->OSTCBX);
 
                 if (rdy == OS_TRUE) {                      /* If task was ready at owner's priority ...*/
                     OSRdyGrp               |= ptcb->OSTCBBitY; /* ... make it ready at new priority.   */
@@ -543,7 +538,7 @@ void  OSMutexPend (OS_EVENT  *pevent,
     }
     OSTCBCur->OSTCBStat     |= OS_STAT_MUTEX;         /* Mutex not available, pend current task        */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;               /* Store timeout in current task's TCB           */
+    OS_TickListInsert(OSTCBCur, timeout);              /* Store timeout in tick list                    */
     OS_EventTaskWait(pevent);                         /* Suspend task until event or timeout occurs    */
     OS_EXIT_CRITICAL();
     OS_Sched();                                       /* Find next highest priority task ready         */
@@ -745,15 +740,10 @@ static  void  OSMutex_RdyAtPrio (OS_TCB  *ptcb,
     }
     ptcb->OSTCBPrio         = prio;
     OSPrioCur               = prio;                        /* The current task is now at this priority */
-#if OS_LOWEST_PRIO <= 63u
-    ptcb->OSTCBY            = (INT8U)((INT8U)(prio >> 3u) & 0x07u);
-    ptcb->OSTCBX            = (INT8U)(prio & 0x07u);
-#else
-    ptcb->OSTCBY            = (INT8U)((INT8U)(prio >> 4u) & 0x0Fu);
-    ptcb->OSTCBX            = (INT8U) (prio & 0x0Fu);
-#endif
-    ptcb->OSTCBBitY         = (OS_PRIO)(1uL << ptcb->OSTCBY);
-    ptcb->OSTCBBitX         = (OS_PRIO)(1uL << ptcb->OSTCBX);
+    ptcb->OSTCBY            = (INT8U)(prio >> OS_PRIO_ROW_SHIFT);
+    ptcb->OSTCBX            = (INT8U)(prio &  OS_PRIO_ROW_MSK);
+    ptcb->OSTCBBitY         = (OS_PRIO)((OS_PRIO)1u << ptcb->OSTCBY);
+    ptcb->OSTCBBitX         = (OS_PRIO)((OS_PRIO)1u << ptcb->OSTCBX);
     OSRdyGrp               |= ptcb->OSTCBBitY;             /* Make task ready at original priority     */
     OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
     OSTCBPrioTbl[prio]      = ptcb;
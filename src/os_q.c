@@ -30,6 +30,38 @@
 #if (OS_Q_EN > 0u) && (OS_MAX_QS > 0u)
 /*
 *********************************************************************************************************
+*                                             LOCAL MACROS
+*
+* Note(s): 1) A task blocked in OSQPendBatch() waits for the queue to fill up to OSQThreshold entries, so
+*             a post must not hand its message to that task directly; the message is queued instead and
+*             OS_QBatchRdy() readies the task once the threshold is reached.
+*********************************************************************************************************
+*/
+
+#if OS_Q_BATCH_EN > 0u
+#define  OS_Q_HANDOFF(pevent, pq)    (((pevent)->OSEventGrp != 0u) && ((pq)->OSQThreshold == 0u))
+#else
+#define  OS_Q_HANDOFF(pevent, pq)     ((pevent)->OSEventGrp != 0u)
+#endif
+
+/*
+*********************************************************************************************************
+*                                      LOCAL FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+#if OS_Q_BATCH_EN > 0u
+static  BOOLEAN  OS_QBatchRdy (OS_EVENT  *pevent,
+                               OS_Q      *pq);
+
+static  INT16U   OS_QGetN     (OS_Q      *pq,
+                               void     **pmsgs,
+                               INT16U     size);
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
 *                                      ACCEPT MESSAGE FROM QUEUE
 *
 * Description: This function checks the queue to see if a message is available.  Unlike OSQPend(),
@@ -164,6 +196,9 @@ OS_EVENT  *OSQCreate (void    **start,
             pq->OSQOut             = start;
             pq->OSQSize            = size;
             pq->OSQEntries         = 0u;
+#if OS_Q_BATCH_EN > 0u
+            pq->OSQThreshold       = 0u;                  /*      No batch consumer waiting            */
+#endif
             pevent->OSEventType    = OS_EVENT_TYPE_Q;
             pevent->OSEventCnt     = 0u;
             pevent->OSEventPtr     = pq;
@@ -183,6 +218,72 @@ OS_EVENT  *OSQCreate (void    **start,
 /*$PAGE*/
 /*
 *********************************************************************************************************
+*                              CREATE A MESSAGE QUEUE FROM STATIC STORAGE
+*
+* Description: This function creates a message queue in an event control block and a queue control block
+*              supplied by the caller instead of taking them from OSEventTbl[] and OSQTbl[].
+*
+* Arguments  : pevent        is a pointer to the caller's event control block.
+*
+*              pq            is a pointer to the caller's queue control block.
+*
+*              start         is a pointer to the base address of the message queue storage area (see
+*                            OSQCreate()).
+*
+*              size          is the number of elements in the storage area
+*
+* Returns    : != (OS_EVENT *)0  is 'pevent', ready to be used with the other OSQ???() services
+*              == (OS_EVENT *)0  if an argument is a NULL pointer or the function was called from an ISR
+*
+* Note(s)    : 1) 'pevent', 'pq' and the storage area must stay valid until the queue is deleted.  OSQDel()
+*                 leaves caller-supplied control blocks with the caller.
+*********************************************************************************************************
+*/
+
+#if OS_STATIC_CREATE_EN > 0u
+OS_EVENT  *OSQCreateStatic (OS_EVENT  *pevent,
+                            OS_Q      *pq,
+                            void     **start,
+                            INT16U     size)
+{
+#ifdef OS_SAFETY_CRITICAL_IEC61508
+    if (OSSafetyCriticalStartFlag == OS_TRUE) {
+        OS_SAFETY_CRITICAL_EXCEPTION();
+        return ((OS_EVENT *)0);
+    }
+#endif
+
+#if OS_ARG_CHK_EN > 0u
+    if ((pevent == (OS_EVENT *)0) || (pq == (OS_Q *)0)) {  /* Validate control blocks                 */
+        return ((OS_EVENT *)0);
+    }
+#endif
+    if (OSIntNesting > 0u) {                     /* See if called from ISR ...                         */
+        return ((OS_EVENT *)0);                  /* ... can't CREATE from an ISR                       */
+    }
+    pq->OSQPtr             = (OS_Q *)0;
+    pq->OSQStart           = start;              /* Initialize the queue                               */
+    pq->OSQEnd             = &start[size];
+    pq->OSQIn              = start;
+    pq->OSQOut             = start;
+    pq->OSQSize            = size;
+    pq->OSQEntries         = 0u;
+#if OS_Q_BATCH_EN > 0u
+    pq->OSQThreshold       = 0u;                 /* No batch consumer waiting                          */
+#endif
+    pevent->OSEventType    = OS_EVENT_TYPE_Q;
+    pevent->OSEventCnt     = 0u;
+    pevent->OSEventPtr     = pq;
+#if OS_EVENT_NAME_EN > 0u
+    pevent->OSEventName    = (INT8U *)(void *)"?";
+#endif
+    OS_EventWaitListInit(pevent);                /* Initialize the wait list                           */
+    return (pevent);
+}
+#endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
 *                                       DELETE A MESSAGE QUEUE
 *
 * Description: This function deletes a message queue and readies all tasks pending on the queue.
@@ -272,12 +373,16 @@ OS_EVENT  *OSQDel (OS_EVENT  *pevent,
                  pevent->OSEventName    = (INT8U *)(void *)"?";
 #endif
                  pq                     = (OS_Q *)pevent->OSEventPtr;  /* Return OS_Q to free list     */
-                 pq->OSQPtr             = OSQFreeList;
-                 OSQFreeList            = pq;
+                 if (OS_Q_POOLED(pq)) {
+                     pq->OSQPtr         = OSQFreeList;
+                     OSQFreeList        = pq;
+                 }
                  pevent->OSEventType    = OS_EVENT_TYPE_UNUSED;
-                 pevent->OSEventPtr     = OSEventFreeList; /* Return Event Control Block to free list  */
                  pevent->OSEventCnt     = 0u;
-                 OSEventFreeList        = pevent;          /* Get next free event control block        */
+                 if (OS_EVENT_POOLED(pevent)) {             /* Static ECBs stay with their owner        */
+                     pevent->OSEventPtr = OSEventFreeList;  /* Return Event Control Block to free list  */
+                     OSEventFreeList    = pevent;           /* Get next free event control block        */
+                 }
                  OS_EXIT_CRITICAL();
                  *perr                  = OS_ERR_NONE;
                  pevent_return          = (OS_EVENT *)0;   /* Queue has been deleted                   */
@@ -296,12 +401,16 @@ OS_EVENT  *OSQDel (OS_EVENT  *pevent,
              pevent->OSEventName    = (INT8U *)(void *)"?";
 #endif
              pq                     = (OS_Q *)pevent->OSEventPtr;   /* Return OS_Q to free list        */
-             pq->OSQPtr             = OSQFreeList;
-             OSQFreeList            = pq;
+             if (OS_Q_POOLED(pq)) {
+                 pq->OSQPtr         = OSQFreeList;
+                 OSQFreeList        = pq;
+             }
              pevent->OSEventType    = OS_EVENT_TYPE_UNUSED;
-             pevent->OSEventPtr     = OSEventFreeList;     /* Return Event Control Block to free list  */
              pevent->OSEventCnt     = 0u;
-             OSEventFreeList        = pevent;              /* Get next free event control block        */
+             if (OS_EVENT_POOLED(pevent)) {                 /* Static ECBs stay with their owner        */
+                 pevent->OSEventPtr = OSEventFreeList;      /* Return Event Control Block to free list  */
+                 OSEventFreeList    = pevent;               /* Get next free event control block        */
+             }
              OS_EXIT_CRITICAL();
              if (tasks_waiting == OS_TRUE) {               /* Reschedule only if task(s) were waiting  */
                  OS_Sched();                               /* Find highest priority task ready to run  */
@@ -456,7 +565,7 @@ void  *OSQPend (OS_EVENT  *pevent,
     }
     OSTCBCur->OSTCBStat     |= OS_STAT_Q;        /* Task will have to pend for a message to be posted  */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;          /* Load timeout into TCB                              */
+    OS_TickListInsert(OSTCBCur, timeout);         /* Load timeout into tick list                        */
     OS_EventTaskWait(pevent);                    /* Suspend task until event or timeout occurs         */
     OS_EXIT_CRITICAL();
     OS_Sched();                                  /* Find next highest priority task ready to run       */
@@ -579,6 +688,150 @@ INT8U  OSQPendAbort (OS_EVENT  *pevent,
 }
 #endif
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                               PEND ON A QUEUE FOR A BATCH OF MESSAGES
+*
+* Description: This function waits until at least 'min' messages are queued and then removes up to
+*              'size' of them in one critical section.  A pipeline stage that handles bursts (e.g.
+*              packet descriptors) thus costs one wakeup and one scheduler pass per burst instead of one
+*              per message.
+*
+* Arguments  : pevent        is a pointer to the event control block associated with the desired queue
+*
+*              pmsgs         is a pointer to an array that receives the messages, oldest first.
+*
+*              size          is the number of entries in 'pmsgs' (>= 1).
+*
+*              min           is the wake-up threshold: the task stays blocked until the queue holds at
+*                            least this many messages.  It is clamped to 1..'size' and to the size of
+*                            the queue.
+*
+*              timeout       is an optional timeout period (in clock ticks).  If non-zero, your task will
+*                            wait up to the amount of time specified by this argument and then take
+*                            whatever is queued, even fewer than 'min' messages.  If you specify 0, your
+*                            task will wait forever.
+*
+*              perr          is a pointer to where an error message will be deposited.  Possible error
+*                            messages are:
+*
+*                            OS_ERR_NONE         The call was successful, see the return value.
+*                            OS_ERR_TIMEOUT      No message was received within the specified 'timeout'.
+*                            OS_ERR_PEND_ABORT   The wait on the queue was aborted.
+*                            OS_ERR_EVENT_TYPE   You didn't pass a pointer to a queue
+*                            OS_ERR_PEVENT_NULL  If 'pevent' is a NULL pointer
+*                            OS_ERR_PDATA_NULL   If 'pmsgs' is a NULL pointer or 'size' is 0
+*                            OS_ERR_PEND_ISR     If you called this function from an ISR
+*                            OS_ERR_PEND_LOCKED  If you called this function with the scheduler is locked
+*
+* Returns    : The number of messages copied to 'pmsgs'.
+*
+* Note(s)    : 1) Only ONE task may pend on a queue with OSQPendBatch(), and it must not share the queue
+*                 with tasks calling OSQPend().  Any post function may feed the queue.
+*********************************************************************************************************
+*/
+
+#if OS_Q_BATCH_EN > 0u
+INT16U  OSQPendBatch (OS_EVENT  *pevent,
+                      void     **pmsgs,
+                      INT16U     size,
+                      INT16U     min,
+                      INT32U     timeout,
+                      INT8U     *perr)
+{
+    OS_Q      *pq;
+    INT16U     nbr;
+#if OS_CRITICAL_METHOD == 3u                     /* Allocate storage for CPU status register           */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+#ifdef OS_SAFETY_CRITICAL
+    if (perr == (INT8U *)0) {
+        OS_SAFETY_CRITICAL_EXCEPTION();
+        return (0u);
+    }
+#endif
+
+#if OS_ARG_CHK_EN > 0u
+    if (pevent == (OS_EVENT *)0) {               /* Validate 'pevent'                                  */
+        *perr = OS_ERR_PEVENT_NULL;
+        return (0u);
+    }
+    if ((pmsgs == (void **)0) || (size == 0u)) { /* Validate destination array                         */
+        *perr = OS_ERR_PDATA_NULL;
+        return (0u);
+    }
+#endif
+    if (pevent->OSEventType != OS_EVENT_TYPE_Q) {/* Validate event block type                          */
+        *perr = OS_ERR_EVENT_TYPE;
+        return (0u);
+    }
+    if (OSIntNesting > 0u) {                     /* See if called from ISR ...                         */
+        *perr = OS_ERR_PEND_ISR;                 /* ... can't PEND from an ISR                         */
+        return (0u);
+    }
+    if (OSLockNesting > 0u) {                    /* See if called with scheduler locked ...            */
+        *perr = OS_ERR_PEND_LOCKED;              /* ... can't PEND when locked                         */
+        return (0u);
+    }
+    OS_ENTER_CRITICAL();
+    pq = (OS_Q *)pevent->OSEventPtr;             /* Point at queue control block                       */
+    if (min > size) {                            /* Clamp the threshold to what can ever be reached    */
+        min = size;
+    }
+    if (min > pq->OSQSize) {
+        min = pq->OSQSize;
+    }
+    if (min == 0u) {
+        min = 1u;
+    }
+    if (pq->OSQEntries >= min) {                 /* Enough messages already queued                     */
+        nbr = OS_QGetN(pq, pmsgs, size);
+        OS_EXIT_CRITICAL();
+        *perr = OS_ERR_NONE;
+        return (nbr);
+    }
+    pq->OSQThreshold         = min;              /* Posts queue their message and wake us at 'min'     */
+    OSTCBCur->OSTCBStat     |= OS_STAT_Q;
+    OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+    OS_TickListInsert(OSTCBCur, timeout);         /* Load timeout into tick list                        */
+    OS_EventTaskWait(pevent);                    /* Suspend task until threshold or timeout            */
+    OS_EXIT_CRITICAL();
+    OS_Sched();                                  /* Find next highest priority task ready to run       */
+    OS_ENTER_CRITICAL();
+    pq->OSQThreshold = 0u;
+    switch (OSTCBCur->OSTCBStatPend) {           /* See if we timed-out or aborted                     */
+        case OS_STAT_PEND_OK:
+             nbr   = OS_QGetN(pq, pmsgs, size);
+            *perr  = OS_ERR_NONE;
+             break;
+
+        case OS_STAT_PEND_ABORT:
+             nbr   = 0u;
+            *perr  = OS_ERR_PEND_ABORT;          /* Indicate that we aborted                           */
+             break;
+
+        case OS_STAT_PEND_TO:
+        default:
+             OS_EventTaskRemove(OSTCBCur, pevent);
+             nbr   = OS_QGetN(pq, pmsgs, size);  /* Flush a partial batch on timeout                   */
+            *perr  = (nbr > 0u) ? OS_ERR_NONE : OS_ERR_TIMEOUT;
+             break;
+    }
+    OSTCBCur->OSTCBStat          =  OS_STAT_RDY;      /* Set   task  status to ready                   */
+    OSTCBCur->OSTCBStatPend      =  OS_STAT_PEND_OK;  /* Clear pend  status                            */
+    OSTCBCur->OSTCBEventPtr      = (OS_EVENT  *)0;    /* Clear event pointers                          */
+#if (OS_EVENT_MULTI_EN > 0u)
+    OSTCBCur->OSTCBEventMultiPtr = (OS_EVENT **)0;
+#endif
+    OS_EXIT_CRITICAL();
+    return (nbr);
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -619,14 +872,14 @@ INT8U  OSQPost (OS_EVENT  *pevent,
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
-    if (pevent->OSEventGrp != 0u) {                    /* See if any task pending on queue             */
+    pq = (OS_Q *)pevent->OSEventPtr;                   /* Point to queue control block                 */
+    if (OS_Q_HANDOFF(pevent, pq)) {                    /* See if any task pending on queue             */
                                                        /* Ready highest priority task waiting on event */
         (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_Q, OS_STAT_PEND_OK);
         OS_EXIT_CRITICAL();
         OS_Sched();                                    /* Find highest priority task ready to run      */
         return (OS_ERR_NONE);
     }
-    pq = (OS_Q *)pevent->OSEventPtr;                   /* Point to queue control block                 */
     if (pq->OSQEntries >= pq->OSQSize) {               /* Make sure queue is not full                  */
         OS_EXIT_CRITICAL();
         return (OS_ERR_Q_FULL);
@@ -636,10 +889,115 @@ INT8U  OSQPost (OS_EVENT  *pevent,
     if (pq->OSQIn == pq->OSQEnd) {                     /* Wrap IN ptr if we are at end of queue        */
         pq->OSQIn = pq->OSQStart;
     }
+#if OS_Q_BATCH_EN > 0u
+    if (OS_QBatchRdy(pevent, pq) == OS_TRUE) {         /* Wake a batch consumer once it has enough     */
+        OS_EXIT_CRITICAL();
+        OS_Sched();
+        return (OS_ERR_NONE);
+    }
+#endif
     OS_EXIT_CRITICAL();
     return (OS_ERR_NONE);
 }
 #endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                  POST A BATCH OF MESSAGES TO A QUEUE
+*
+* Description: This function sends several messages to a queue in one critical section, with at most one
+*              scheduler pass at the end.
+*
+* Arguments  : pevent        is a pointer to the event control block associated with the desired queue
+*
+*              pmsgs         is a pointer to the messages to send, oldest first.
+*
+*              nbr           is the number of messages in 'pmsgs'.
+*
+*              perr          is a pointer to where an error message will be deposited.  Possible error
+*                            messages are:
+*
+*                            OS_ERR_NONE         All the messages were sent.
+*                            OS_ERR_Q_FULL       The queue filled up; see the return value for how many
+*                                                messages were sent.
+*                            OS_ERR_EVENT_TYPE   If you didn't pass a pointer to a queue.
+*                            OS_ERR_PEVENT_NULL  If 'pevent' is a NULL pointer
+*                            OS_ERR_PDATA_NULL   If 'pmsgs' is a NULL pointer
+*
+* Returns    : The number of messages sent (a prefix of 'pmsgs').
+*
+* Note(s)    : 1) This function may be called from an ISR.
+*              2) Tasks blocked in OSQPend() each receive one message directly, highest priority first;
+*                 the rest is queued.  A task blocked in OSQPendBatch() is readied once the queue holds
+*                 its threshold.
+*********************************************************************************************************
+*/
+
+#if OS_Q_BATCH_EN > 0u
+INT16U  OSQPostBatch (OS_EVENT  *pevent,
+                      void     **pmsgs,
+                      INT16U     nbr,
+                      INT8U     *perr)
+{
+    OS_Q      *pq;
+    INT16U     i;
+    BOOLEAN    sched;
+#if OS_CRITICAL_METHOD == 3u                           /* Allocate storage for CPU status register     */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+#ifdef OS_SAFETY_CRITICAL
+    if (perr == (INT8U *)0) {
+        OS_SAFETY_CRITICAL_EXCEPTION();
+        return (0u);
+    }
+#endif
+
+#if OS_ARG_CHK_EN > 0u
+    if (pevent == (OS_EVENT *)0) {                     /* Validate 'pevent'                            */
+        *perr = OS_ERR_PEVENT_NULL;
+        return (0u);
+    }
+    if (pmsgs == (void **)0) {                         /* Validate source array                        */
+        *perr = OS_ERR_PDATA_NULL;
+        return (0u);
+    }
+#endif
+    if (pevent->OSEventType != OS_EVENT_TYPE_Q) {      /* Validate event block type                    */
+        *perr = OS_ERR_EVENT_TYPE;
+        return (0u);
+    }
+    i     = 0u;
+    sched = OS_FALSE;
+    OS_ENTER_CRITICAL();
+    pq = (OS_Q *)pevent->OSEventPtr;                   /* Point to queue control block                 */
+    while ((i < nbr) && OS_Q_HANDOFF(pevent, pq)) {    /* Hand messages to tasks waiting in OSQPend()  */
+        (void)OS_EventTaskRdy(pevent, pmsgs[i], OS_STAT_Q, OS_STAT_PEND_OK);
+        i++;
+        sched = OS_TRUE;
+    }
+    while ((i < nbr) && (pq->OSQEntries < pq->OSQSize)) {
+        *pq->OSQIn++ = pmsgs[i];                       /* Insert message into queue                    */
+        if (pq->OSQIn == pq->OSQEnd) {                 /* Wrap IN ptr if we are at end of queue        */
+            pq->OSQIn = pq->OSQStart;
+        }
+        pq->OSQEntries++;
+        i++;
+    }
+    if (OS_QBatchRdy(pevent, pq) == OS_TRUE) {         /* Wake a batch consumer once it has enough     */
+        sched = OS_TRUE;
+    }
+    OS_EXIT_CRITICAL();
+    if (sched == OS_TRUE) {
+        OS_Sched();                                    /* One scheduler pass for the whole batch       */
+    }
+    *perr = (i == nbr) ? OS_ERR_NONE : OS_ERR_Q_FULL;
+    return (i);
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -682,14 +1040,14 @@ INT8U  OSQPostFront (OS_EVENT  *pevent,
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
-    if (pevent->OSEventGrp != 0u) {                   /* See if any task pending on queue              */
+    pq = (OS_Q *)pevent->OSEventPtr;                  /* Point to queue control block                  */
+    if (OS_Q_HANDOFF(pevent, pq)) {                   /* See if any task pending on queue              */
                                                       /* Ready highest priority task waiting on event  */
         (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_Q, OS_STAT_PEND_OK);
         OS_EXIT_CRITICAL();
         OS_Sched();                                   /* Find highest priority task ready to run       */
         return (OS_ERR_NONE);
     }
-    pq = (OS_Q *)pevent->OSEventPtr;                  /* Point to queue control block                  */
     if (pq->OSQEntries >= pq->OSQSize) {              /* Make sure queue is not full                   */
         OS_EXIT_CRITICAL();
         return (OS_ERR_Q_FULL);
@@ -700,6 +1058,13 @@ INT8U  OSQPostFront (OS_EVENT  *pevent,
     pq->OSQOut--;
     *pq->OSQOut = pmsg;                               /* Insert message into queue                     */
     pq->OSQEntries++;                                 /* Update the nbr of entries in the queue        */
+#if OS_Q_BATCH_EN > 0u
+    if (OS_QBatchRdy(pevent, pq) == OS_TRUE) {        /* Wake a batch consumer once it has enough      */
+        OS_EXIT_CRITICAL();
+        OS_Sched();
+        return (OS_ERR_NONE);
+    }
+#endif
     OS_EXIT_CRITICAL();
     return (OS_ERR_NONE);
 }
@@ -755,7 +1120,8 @@ INT8U  OSQPostOpt (OS_EVENT  *pevent,
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
-    if (pevent->OSEventGrp != 0x00u) {                /* See if any task pending on queue              */
+    pq = (OS_Q *)pevent->OSEventPtr;                  /* Point to queue control block                  */
+    if (OS_Q_HANDOFF(pevent, pq)) {                   /* See if any task pending on queue              */
         if ((opt & OS_POST_OPT_BROADCAST) != 0x00u) { /* Do we need to post msg to ALL waiting tasks ? */
             while (pevent->OSEventGrp != 0u) {        /* Yes, Post to ALL tasks waiting on queue       */
                 (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_Q, OS_STAT_PEND_OK);
@@ -769,7 +1135,6 @@ INT8U  OSQPostOpt (OS_EVENT  *pevent,
         }
         return (OS_ERR_NONE);
     }
-    pq = (OS_Q *)pevent->OSEventPtr;                  /* Point to queue control block                  */
     if (pq->OSQEntries >= pq->OSQSize) {              /* Make sure queue is not full                   */
         OS_EXIT_CRITICAL();
         return (OS_ERR_Q_FULL);
@@ -787,6 +1152,15 @@ INT8U  OSQPostOpt (OS_EVENT  *pevent,
         }
     }
     pq->OSQEntries++;                                 /* Update the nbr of entries in the queue        */
+#if OS_Q_BATCH_EN > 0u
+    if (OS_QBatchRdy(pevent, pq) == OS_TRUE) {        /* Wake a batch consumer once it has enough      */
+        OS_EXIT_CRITICAL();
+        if ((opt & OS_POST_OPT_NO_SCHED) == 0u) {
+            OS_Sched();
+        }
+        return (OS_ERR_NONE);
+    }
+#endif
     OS_EXIT_CRITICAL();
     return (OS_ERR_NONE);
 }
@@ -855,6 +1229,83 @@ INT8U  OSQQuery (OS_EVENT  *pevent,
 }
 #endif                                                 /* OS_Q_QUERY_EN                                */
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                     READY A WAITING BATCH CONSUMER
+*
+* Description: This function readies the task blocked in OSQPendBatch() once the queue holds at least the
+*              number of messages that task asked for.
+*
+* Arguments  : pevent        is a pointer to the event control block associated with the queue.
+*
+*              pq            is a pointer to the queue control block.
+*
+* Returns    : OS_TRUE       if the task was readied and the caller should run the scheduler.
+*              OS_FALSE      otherwise.
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) Interrupts are assumed to be disabled when this function is called.
+*********************************************************************************************************
+*/
+
+#if OS_Q_BATCH_EN > 0u
+static  BOOLEAN  OS_QBatchRdy (OS_EVENT  *pevent,
+                               OS_Q      *pq)
+{
+    if (pq->OSQThreshold == 0u) {                      /* No batch consumer waiting                    */
+        return (OS_FALSE);
+    }
+    if (pq->OSQEntries < pq->OSQThreshold) {           /* Not enough messages yet                      */
+        return (OS_FALSE);
+    }
+    pq->OSQThreshold = 0u;                             /* Later posts just queue until the task runs   */
+    (void)OS_EventTaskRdy(pevent, (void *)0, OS_STAT_Q, OS_STAT_PEND_OK);
+    return (OS_TRUE);
+}
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                   REMOVE SEVERAL MESSAGES FROM A QUEUE
+*
+* Description: This function moves up to 'size' messages, oldest first, from the queue to 'pmsgs'.
+*
+* Arguments  : pq            is a pointer to the queue control block.
+*
+*              pmsgs         is a pointer to the destination array.
+*
+*              size          is the number of entries in 'pmsgs'.
+*
+* Returns    : The number of messages moved.
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) Interrupts are assumed to be disabled when this function is called.
+*********************************************************************************************************
+*/
+
+#if OS_Q_BATCH_EN > 0u
+static  INT16U  OS_QGetN (OS_Q      *pq,
+                          void     **pmsgs,
+                          INT16U     size)
+{
+    INT16U  nbr;
+    INT16U  i;
+
+
+    nbr = (pq->OSQEntries < size) ? pq->OSQEntries : size;
+    for (i = 0u; i < nbr; i++) {
+        pmsgs[i] = *pq->OSQOut++;                      /* Extract oldest message from the queue        */
+        if (pq->OSQOut == pq->OSQEnd) {                /* Wrap OUT pointer if at the end of the queue  */
+            pq->OSQOut = pq->OSQStart;
+        }
+    }
+    pq->OSQEntries -= nbr;
+    return (nbr);
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
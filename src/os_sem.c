@@ -130,6 +130,58 @@ OS_EVENT  *OSSemCreate (INT16U cnt)
     return (pevent);
 }
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                CREATE A SEMAPHORE FROM STATIC STORAGE
+*
+* Description: This function creates a semaphore in an event control block supplied by the caller
+*              instead of taking one from OSEventTbl[].
+*
+* Arguments  : pevent        is a pointer to the caller's event control block.  It usually lives in the
+*                            driver or module that owns the semaphore and must stay valid until the
+*                            semaphore is deleted.
+*
+*              cnt           is the initial value for the semaphore (see OSSemCreate()).
+*
+* Returns    : != (void *)0  is 'pevent', ready to be used with the other OSSem???() services
+*              == (void *)0  if 'pevent' is a NULL pointer or the function was called from an ISR
+*
+* Note(s)    : 1) OSSemDel() leaves a caller-supplied ECB with the caller; it is never put on the ECB
+*                 free list.
+*********************************************************************************************************
+*/
+
+#if OS_STATIC_CREATE_EN > 0u
+OS_EVENT  *OSSemCreateStatic (OS_EVENT  *pevent,
+                              INT16U     cnt)
+{
+#ifdef OS_SAFETY_CRITICAL_IEC61508
+    if (OSSafetyCriticalStartFlag == OS_TRUE) {
+        OS_SAFETY_CRITICAL_EXCEPTION();
+        return ((OS_EVENT *)0);
+    }
+#endif
+
+#if OS_ARG_CHK_EN > 0u
+    if (pevent == (OS_EVENT *)0) {                         /* Validate 'pevent'                        */
+        return ((OS_EVENT *)0);
+    }
+#endif
+    if (OSIntNesting > 0u) {                               /* See if called from ISR ...               */
+        return ((OS_EVENT *)0);                            /* ... can't CREATE from an ISR             */
+    }
+    pevent->OSEventType    = OS_EVENT_TYPE_SEM;
+    pevent->OSEventCnt     = cnt;                          /* Set semaphore value                      */
+    pevent->OSEventPtr     = (void *)0;
+#if OS_EVENT_NAME_EN > 0u
+    pevent->OSEventName    = (INT8U *)(void *)"?";
+#endif
+    OS_EventWaitListInit(pevent);                          /* Initialize to 'nobody waiting' on sem.   */
+    return (pevent);
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -217,9 +269,11 @@ OS_EVENT  *OSSemDel (OS_EVENT  *pevent,
                  pevent->OSEventName    = (INT8U *)(void *)"?";
 #endif
                  pevent->OSEventType    = OS_EVENT_TYPE_UNUSED;
-                 pevent->OSEventPtr     = OSEventFreeList; /* Return Event Control Block to free list  */
                  pevent->OSEventCnt     = 0u;
-                 OSEventFreeList        = pevent;          /* Get next free event control block        */
+                 if (OS_EVENT_POOLED(pevent)) {             /* Static ECBs stay with their owner        */
+                     pevent->OSEventPtr = OSEventFreeList;  /* Return Event Control Block to free list  */
+                     OSEventFreeList    = pevent;           /* Get next free event control block        */
+                 }
                  OS_EXIT_CRITICAL();
                  *perr                  = OS_ERR_NONE;
                  pevent_return          = (OS_EVENT *)0;   /* Semaphore has been deleted               */
@@ -238,9 +292,11 @@ OS_EVENT  *OSSemDel (OS_EVENT  *pevent,
              pevent->OSEventName    = (INT8U *)(void *)"?";
 #endif
              pevent->OSEventType    = OS_EVENT_TYPE_UNUSED;
-             pevent->OSEventPtr     = OSEventFreeList;     /* Return Event Control Block to free list  */
              pevent->OSEventCnt     = 0u;
-             OSEventFreeList        = pevent;              /* Get next free event control block        */
+             if (OS_EVENT_POOLED(pevent)) {                 /* Static ECBs stay with their owner        */
+                 pevent->OSEventPtr = OSEventFreeList;      /* Return Event Control Block to free list  */
+                 OSEventFreeList    = pevent;               /* Get next free event control block        */
+             }
              OS_EXIT_CRITICAL();
              if (tasks_waiting == OS_TRUE) {               /* Reschedule only if task(s) were waiting  */
                  OS_Sched();                               /* Find highest priority task ready to run  */
@@ -337,9 +393,10 @@ void  OSSemPend (OS_EVENT  *pevent,
                                                       /* Otherwise, must wait until event occurs       */
     OSTCBCur->OSTCBStat     |= OS_STAT_SEM;           /* Resource not available, pend on semaphore     */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;               /* Store pend timeout in TCB                     */
+    OS_TickListInsert(OSTCBCur, timeout);              /* Store pend timeout in tick list               */
     OS_EventTaskWait(pevent);                         /* Suspend task until event or timeout occurs    */
     OS_EXIT_CRITICAL();
+    OS_TRACE_SEM_PEND(pevent, OSTCBCur->OSTCBPrio);
     OS_Sched();                                       /* Find next highest priority task ready         */
     OS_ENTER_CRITICAL();
     switch (OSTCBCur->OSTCBStatPend) {                /* See if we timed-out or aborted                */
@@ -364,6 +421,7 @@ void  OSSemPend (OS_EVENT  *pevent,
     OSTCBCur->OSTCBEventMultiPtr = (OS_EVENT **)0;
 #endif
     OS_EXIT_CRITICAL();
+    OS_TRACE_SEM_PEND_DONE(pevent, *perr);
 }
 
 /*$PAGE*/
@@ -497,12 +555,14 @@ INT8U  OSSemPost (OS_EVENT *pevent)
                                                       /* Ready HPT waiting on event                    */
         (void)OS_EventTaskRdy(pevent, (void *)0, OS_STAT_SEM, OS_STAT_PEND_OK);
         OS_EXIT_CRITICAL();
+        OS_TRACE_SEM_POST(pevent, 1u);
         OS_Sched();                                   /* Find HPT ready to run                         */
         return (OS_ERR_NONE);
     }
     if (pevent->OSEventCnt < 65535u) {                /* Make sure semaphore will not overflow         */
         pevent->OSEventCnt++;                         /* Increment semaphore count to register event   */
         OS_EXIT_CRITICAL();
+        OS_TRACE_SEM_POST(pevent, 0u);
         return (OS_ERR_NONE);
     }
     OS_EXIT_CRITICAL();                               /* Semaphore value has reached its maximum       */
@@ -100,15 +100,10 @@ INT8U  OSTaskChangePrio (INT8U  oldprio,
         OS_EXIT_CRITICAL();                                 /* No, can't change its priority!          */
         return (OS_ERR_TASK_NOT_EXIST);
     }
-#if OS_LOWEST_PRIO <= 63u
-    y_new                 = (INT8U)(newprio >> 3u);         /* Yes, compute new TCB fields             */
-    x_new                 = (INT8U)(newprio & 0x07u);
-#else
-    y_new                 = (INT8U)((INT8U)(newprio >> 4u) & 0x0Fu);
-    x_new                 = (INT8U)(newprio & 0x0Fu);
-#endif
-    bity_new              = (OS_PRIO)(1uL << y_new);
-    bitx_new              = (OS_PRIO)(1uL << x_new);
+    y_new                 = (INT8U)(newprio >> OS_PRIO_ROW_SHIFT);  /* Yes, compute new TCB fields     */
+    x_new                 = (INT8U)(newprio &  OS_PRIO_ROW_MSK);
+    bity_new              = (OS_PRIO)((OS_PRIO)1u << y_new);
+    bitx_new              = (OS_PRIO)((OS_PRIO)1u << x_new);
 
     OSTCBPrioTbl[oldprio] = (OS_TCB *)0;                    /* Remove TCB from old priority            */
     OSTCBPrioTbl[newprio] =  ptcb;                          /* Place pointer to TCB @ new priority     */
@@ -243,7 +238,98 @@ INT8U  OSTaskCreate (void   (*task)(void *p_arg),
                                              /* ... the same thing until task is created.              */
         OS_EXIT_CRITICAL();
         psp = OSTaskStkInit(task, p_arg, ptos, 0u);             /* Initialize the task's stack         */
-        err = OS_TCBInit(prio, psp, (OS_STK *)0, 0u, 0u, (void *)0, 0u);
+        err = OS_TCBInit((OS_TCB *)0, prio, psp, (OS_STK *)0, 0u, 0u, (void *)0, 0u);
+        if (err == OS_ERR_NONE) {
+            if (OSRunning == OS_TRUE) {      /* Find highest priority task if multitasking has started */
+                OS_Sched();
+            }
+        } else {
+            OS_ENTER_CRITICAL();
+            OSTCBPrioTbl[prio] = (OS_TCB *)0;/* Make this priority available to others                 */
+            OS_EXIT_CRITICAL();
+        }
+        return (err);
+    }
+    OS_EXIT_CRITICAL();
+    return (OS_ERR_PRIO_EXIST);
+}
+#endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                  CREATE A TASK WITH A STATIC TCB
+*
+* Description: This function is identical to OSTaskCreate() except that the task control block is
+*              supplied by the caller instead of being taken from OSTCBTbl[].  The TCB is typically
+*              embedded in the structure of the driver or module that owns the task, so tasks created
+*              this way do not count against OS_MAX_TASKS.
+*
+* Arguments  : ptcb     is a pointer to the caller's TCB.  It is cleared here and must stay valid until
+*                       the task is deleted.
+*
+*              task     is a pointer to the task's code
+*
+*              p_arg    is a pointer to an optional data area passed to the task (see OSTaskCreate())
+*
+*              ptos     is a pointer to the task's top of stack (see OSTaskCreate())
+*
+*              prio     is the task's priority.  A unique priority MUST be assigned to each task.
+*
+* Returns    : OS_ERR_NONE                      if the function was successful.
+*              OS_ERR_PDATA_NULL                if 'ptcb' is a NULL pointer.
+*              OS_ERR_PRIO_EXIST                if the task priority already exist.
+*              OS_ERR_PRIO_INVALID              if the priority you specify is higher that the maximum
+*                                               allowed (i.e. >= OS_LOWEST_PRIO)
+*              OS_ERR_TASK_CREATE_ISR           if you tried to create a task from an ISR.
+*              OS_ERR_ILLEGAL_CREATE_RUN_TIME   if you tried to create a task after safety critical
+*                                               operation started.
+*
+* Note(s)    : 1) OSTaskDel() leaves a caller-supplied TCB with the caller; it is never put on the free
+*                 TCB list.
+*********************************************************************************************************
+*/
+
+#if (OS_TASK_CREATE_EN > 0u) && (OS_STATIC_CREATE_EN > 0u)
+INT8U  OSTaskCreateStatic (OS_TCB  *ptcb,
+                           void   (*task)(void *p_arg),
+                           void    *p_arg,
+                           OS_STK  *ptos,
+                           INT8U    prio)
+{
+    OS_STK     *psp;
+    INT8U       err;
+#if OS_CRITICAL_METHOD == 3u                 /* Allocate storage for CPU status register               */
+    OS_CPU_SR   cpu_sr = 0u;
+#endif
+
+
+
+#ifdef OS_SAFETY_CRITICAL_IEC61508
+    if (OSSafetyCriticalStartFlag == OS_TRUE) {
+        OS_SAFETY_CRITICAL_EXCEPTION();
+        return (OS_ERR_ILLEGAL_CREATE_RUN_TIME);
+    }
+#endif
+
+#if OS_ARG_CHK_EN > 0u
+    if (ptcb == (OS_TCB *)0) {               /* Validate 'ptcb'                                        */
+        return (OS_ERR_PDATA_NULL);
+    }
+    if (prio > OS_LOWEST_PRIO) {             /* Make sure priority is within allowable range           */
+        return (OS_ERR_PRIO_INVALID);
+    }
+#endif
+    OS_ENTER_CRITICAL();
+    if (OSIntNesting > 0u) {                 /* Make sure we don't create the task from within an ISR  */
+        OS_EXIT_CRITICAL();
+        return (OS_ERR_TASK_CREATE_ISR);
+    }
+    if (OSTCBPrioTbl[prio] == (OS_TCB *)0) { /* Make sure task doesn't already exist at this priority  */
+        OSTCBPrioTbl[prio] = OS_TCB_RESERVED;/* Reserve the priority                                   */
+        OS_EXIT_CRITICAL();
+        OS_MemClr((INT8U *)ptcb, sizeof(OS_TCB));               /* Caller storage may not be zeroed    */
+        psp = OSTaskStkInit(task, p_arg, ptos, 0u);             /* Initialize the task's stack         */
+        err = OS_TCBInit(ptcb, prio, psp, (OS_STK *)0, 0u, 0u, (void *)0, 0u);
         if (err == OS_ERR_NONE) {
             if (OSRunning == OS_TRUE) {      /* Find highest priority task if multitasking has started */
                 OS_Sched();
@@ -378,7 +464,7 @@ INT8U  OSTaskCreateExt (void   (*task)(void *p_arg),
 #endif
 
         psp = OSTaskStkInit(task, p_arg, ptos, opt);           /* Initialize the task's stack          */
-        err = OS_TCBInit(prio, psp, pbos, id, stk_size, pext, opt);
+        err = OS_TCBInit((OS_TCB *)0, prio, psp, pbos, id, stk_size, pext, opt);
         if (err == OS_ERR_NONE) {
             if (OSRunning == OS_TRUE) {                        /* Find HPT if multitasking has started */
                 OS_Sched();
@@ -496,7 +582,7 @@ INT8U  OSTaskDel (INT8U prio)
     }
 #endif
 
-    ptcb->OSTCBDly      = 0u;                           /* Prevent OSTimeTick() from updating          */
+    OS_TickListRemove(ptcb);                            /* Prevent OSTimeTick() from updating          */
     ptcb->OSTCBStat     = OS_STAT_RDY;                  /* Prevent task from being resumed             */
     ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
     if (OSLockNesting < 255u) {                         /* Make sure we don't context switch           */
@@ -525,8 +611,10 @@ INT8U  OSTaskDel (INT8U prio)
         ptcb->OSTCBPrev->OSTCBNext = ptcb->OSTCBNext;
         ptcb->OSTCBNext->OSTCBPrev = ptcb->OSTCBPrev;
     }
-    ptcb->OSTCBNext     = OSTCBFreeList;                /* Return TCB to free TCB list                 */
-    OSTCBFreeList       = ptcb;
+    if (OS_TCB_POOLED(ptcb)) {                          /* Static TCBs stay with their owner           */
+        ptcb->OSTCBNext = OSTCBFreeList;                /* Return TCB to free TCB list                 */
+        OSTCBFreeList   = ptcb;
+    }
 #if OS_TASK_NAME_EN > 0u
     ptcb->OSTCBTaskName = (INT8U *)(void *)"?";
 #endif
@@ -789,6 +877,266 @@ void  OSTaskNameSet (INT8U   prio,
 }
 #endif
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                   PEND ON DIRECT TASK NOTIFICATION
+*
+* Description: This function waits for a notification posted to the calling task with OSTaskNotifyPost().
+*              Unlike OSSemPend() no event control block is involved: the notification word lives in the
+*              task's own OS_TCB, so a post only has to update that word and make one task ready.
+*
+* Arguments  : timeout   is an optional timeout period (in clock ticks).  If non-zero, your task will wait
+*                        for a notification up to the amount of time specified by this argument.  If you
+*                        specify 0, however, your task will wait forever.
+*
+*              clr_mask  are the bits of the notification word to clear once it has been read.  Pass ~0u
+*                        to consume everything (e.g. a count built with OS_NOTIFY_OPT_INC), or 0u to leave
+*                        the word untouched.
+*
+*              perr      is a pointer to where an error message will be deposited.  Possible error
+*                        messages are:
+*
+*                        OS_ERR_NONE         A notification was received.
+*                        OS_ERR_TIMEOUT      No notification was posted within the specified 'timeout',
+*                                            or the wait was cancelled with OSTimeDlyResume().
+*                        OS_ERR_PEND_ABORT   The wait was aborted.
+*                        OS_ERR_PEND_ISR     If you called this function from an ISR.
+*                        OS_ERR_PEND_LOCKED  If you called this function when the scheduler is locked.
+*
+* Returns    : The value of the notification word before 'clr_mask' was applied, or 0 on error.
+*
+* Note(s)    : 1) Only one notification is remembered while the task is not waiting: posts made in the
+*                 meantime are merged into the notification word according to their option.
+*********************************************************************************************************
+*/
+
+#if OS_TASK_NOTIFY_EN > 0u
+INT32U  OSTaskNotifyPend (INT32U   timeout,
+                          INT32U   clr_mask,
+                          INT8U   *perr)
+{
+    INT32U     val;
+    INT8U      y;
+#if OS_CRITICAL_METHOD == 3u                          /* Allocate storage for CPU status register      */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+#ifdef OS_SAFETY_CRITICAL
+    if (perr == (INT8U *)0) {
+        OS_SAFETY_CRITICAL_EXCEPTION();
+        return (0u);
+    }
+#endif
+
+    if (OSIntNesting > 0u) {                          /* See if called from ISR ...                    */
+        *perr = OS_ERR_PEND_ISR;                      /* ... can't PEND from an ISR                    */
+        return (0u);
+    }
+    if (OSLockNesting > 0u) {                         /* See if called with scheduler locked ...       */
+        *perr = OS_ERR_PEND_LOCKED;                   /* ... can't PEND when locked                    */
+        return (0u);
+    }
+    OS_ENTER_CRITICAL();
+    if (OSTCBCur->OSTCBNotifyPend == OS_FALSE) {      /* Nothing posted yet, must wait                 */
+        OSTCBCur->OSTCBStat     |= OS_STAT_NOTIFY;
+        OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
+        OS_TickListInsert(OSTCBCur, timeout);         /* Store pend timeout in tick list               */
+        y            =  OSTCBCur->OSTCBY;             /* Task no longer ready                          */
+        OSRdyTbl[y] &= (OS_PRIO)~OSTCBCur->OSTCBBitX;
+        if (OSRdyTbl[y] == 0u) {
+            OSRdyGrp &= (OS_PRIO)~OSTCBCur->OSTCBBitY;
+        }
+        OS_EXIT_CRITICAL();
+        OS_Sched();                                   /* Find next highest priority task ready         */
+        OS_ENTER_CRITICAL();
+        switch (OSTCBCur->OSTCBStatPend) {            /* See if we timed-out or aborted                */
+            case OS_STAT_PEND_OK:
+                 break;
+
+            case OS_STAT_PEND_ABORT:
+                 OSTCBCur->OSTCBStat     = OS_STAT_RDY;
+                 OSTCBCur->OSTCBStatPend = OS_STAT_PEND_OK;
+                 OS_EXIT_CRITICAL();
+                 *perr = OS_ERR_PEND_ABORT;           /* Indicate that we aborted                      */
+                 return (0u);
+
+            case OS_STAT_PEND_TO:
+            default:
+                 OSTCBCur->OSTCBStat     = OS_STAT_RDY;
+                 OSTCBCur->OSTCBStatPend = OS_STAT_PEND_OK;
+                 OS_EXIT_CRITICAL();
+                 *perr = OS_ERR_TIMEOUT;              /* Indicate that we didn't get notified in time  */
+                 return (0u);
+        }
+    }
+    val                        = OSTCBCur->OSTCBNotifyVal;
+    OSTCBCur->OSTCBNotifyVal  &= ~clr_mask;           /* Consume the requested bits                    */
+    OSTCBCur->OSTCBNotifyPend  = OS_FALSE;
+    OS_EXIT_CRITICAL();
+    *perr = OS_ERR_NONE;
+    return (val);
+}
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                    POST DIRECT TASK NOTIFICATION
+*
+* Description: This function updates the notification word of a task and, if that task is waiting in
+*              OSTaskNotifyPend(), makes it ready to run.  It is intended as a cheaper alternative to
+*              OSSemPost()/OSMboxPost() when an ISR or a task always wakes the same task.
+*
+* Arguments  : prio      is the priority of the task to notify.
+*
+*              val       is the value used to update the notification word, see 'opt'.
+*
+*              opt       determines how 'val' is applied:
+*
+*                        OS_NOTIFY_OPT_SET_BITS     OR 'val' into the word (event flags)
+*                        OS_NOTIFY_OPT_INC          Add 'val' to the word (counting semaphore)
+*                        OS_NOTIFY_OPT_OVERWRITE    Replace the word with 'val' (mailbox)
+*
+* Returns    : OS_ERR_NONE                if the notification was posted
+*              OS_ERR_PRIO_INVALID        if the priority you specify is higher that the maximum allowed
+*                                         (i.e. >= OS_LOWEST_PRIO)
+*              OS_ERR_TASK_NOT_EXIST      if the task does not exist or is assigned to a Mutex PIP
+*              OS_ERR_INVALID_OPT         if you specified an invalid option
+*
+* Note(s)    : 1) This function may be called from an ISR.
+*********************************************************************************************************
+*/
+
+#if OS_TASK_NOTIFY_EN > 0u
+INT8U  OSTaskNotifyPost (INT8U   prio,
+                         INT32U  val,
+                         INT8U   opt)
+{
+    OS_TCB    *ptcb;
+#if OS_CRITICAL_METHOD == 3u                                  /* Storage for CPU status register       */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+#if OS_ARG_CHK_EN > 0u
+    if (prio >= OS_LOWEST_PRIO) {                             /* Make sure task priority is valid      */
+        return (OS_ERR_PRIO_INVALID);
+    }
+#endif
+    OS_ENTER_CRITICAL();
+    ptcb = OSTCBPrioTbl[prio];
+    if (ptcb == (OS_TCB *)0) {                                /* Task to notify must exist             */
+        OS_EXIT_CRITICAL();
+        return (OS_ERR_TASK_NOT_EXIST);
+    }
+    if (ptcb == OS_TCB_RESERVED) {                            /* See if assigned to Mutex              */
+        OS_EXIT_CRITICAL();
+        return (OS_ERR_TASK_NOT_EXIST);
+    }
+    switch (opt) {
+        case OS_NOTIFY_OPT_SET_BITS:
+             ptcb->OSTCBNotifyVal |= val;
+             break;
+
+        case OS_NOTIFY_OPT_INC:
+             ptcb->OSTCBNotifyVal += val;
+             break;
+
+        case OS_NOTIFY_OPT_OVERWRITE:
+             ptcb->OSTCBNotifyVal  = val;
+             break;
+
+        default:
+             OS_EXIT_CRITICAL();
+             return (OS_ERR_INVALID_OPT);
+    }
+    ptcb->OSTCBNotifyPend = OS_TRUE;
+    if ((ptcb->OSTCBStat & OS_STAT_NOTIFY) != OS_STAT_RDY) {  /* See if task is waiting for it         */
+        OS_TickListRemove(ptcb);                              /* Cancel the pend timeout               */
+        ptcb->OSTCBStat     &= (INT8U)~(INT8U)OS_STAT_NOTIFY;
+        ptcb->OSTCBStatPend  = OS_STAT_PEND_OK;
+        if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY) {
+            OSRdyGrp               |= ptcb->OSTCBBitY;        /* Make task ready to run                */
+            OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+            OS_EXIT_CRITICAL();
+            OS_Sched();                                       /* Find new highest priority task        */
+            return (OS_ERR_NONE);
+        }
+    }
+    OS_EXIT_CRITICAL();
+    return (OS_ERR_NONE);
+}
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                         GET TASK RUN TIME
+*
+* Description: This function returns the run time accounting of a task, as kept by OSTaskSwHook() and the
+*              IRQ handler of the port.
+*
+* Arguments  : prio          is the task priority, or OS_PRIO_SELF for the calling task.
+*
+*              p_prof        is a pointer to a data structure of type OS_TASK_PROF that receives the counts.
+*
+* Returns    : OS_ERR_NONE            upon success
+*              OS_ERR_PRIO_INVALID    if the priority you specify is higher that the maximum allowed
+*                                     (i.e. > OS_LOWEST_PRIO) or, you have not specified OS_PRIO_SELF.
+*              OS_ERR_TASK_NOT_EXIST  if the desired task has not been created or is assigned to a Mutex PIP
+*              OS_ERR_PDATA_NULL      if 'p_prof' is a NULL pointer
+*
+* Note(s)    : 1) Cycles are OS_CPU_CyclesGet() counts.  Time spent in ISRs is not charged to the task it
+*                 interrupted; the port keeps it apart (see OS_CPU_IntProfGet()).
+*
+*              2) OSCyclesTot only includes completed runs; the slice of the calling task that is in progress
+*                 is added when it is switched out or interrupted.
+*********************************************************************************************************
+*/
+
+#if OS_TASK_PROFILE_EN > 0u
+INT8U  OSTaskProfGet (INT8U          prio,
+                      OS_TASK_PROF  *p_prof)
+{
+    OS_TCB    *ptcb;
+#if OS_CRITICAL_METHOD == 3u                           /* Allocate storage for CPU status register     */
+    OS_CPU_SR  cpu_sr = 0u;
+#endif
+
+
+
+#if OS_ARG_CHK_EN > 0u
+    if (prio > OS_LOWEST_PRIO) {                       /* Make sure task priority is valid             */
+        if (prio != OS_PRIO_SELF) {
+            return (OS_ERR_PRIO_INVALID);
+        }
+    }
+    if (p_prof == (OS_TASK_PROF *)0) {                 /* Validate 'p_prof'                            */
+        return (OS_ERR_PDATA_NULL);
+    }
+#endif
+    OS_ENTER_CRITICAL();
+    if (prio == OS_PRIO_SELF) {                        /* See if query for SELF                        */
+        prio = OSTCBCur->OSTCBPrio;
+    }
+    ptcb = OSTCBPrioTbl[prio];
+    if ((ptcb == (OS_TCB *)0) || (ptcb == OS_TCB_RESERVED)) {  /* Make sure task exist                 */
+        OS_EXIT_CRITICAL();
+        return (OS_ERR_TASK_NOT_EXIST);
+    }
+    p_prof->OSCtxSwCtr   = ptcb->OSTCBCtxSwCtr;
+    p_prof->OSPreemptCtr = ptcb->OSTCBPreemptCtr;
+    p_prof->OSCyclesTot  = ptcb->OSTCBCyclesTot;
+    p_prof->OSCyclesMax  = ptcb->OSTCBCyclesMax;
+    OS_EXIT_CRITICAL();
+    return (OS_ERR_NONE);
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
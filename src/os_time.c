@@ -65,7 +65,7 @@ void  OSTimeDly (INT32U ticks)
         if (OSRdyTbl[y] == 0u) {
             OSRdyGrp &= (OS_PRIO)~OSTCBCur->OSTCBBitY;
         }
-        OSTCBCur->OSTCBDly = ticks;              /* Load ticks in TCB                                  */
+        OS_TickListInsert(OSTCBCur, ticks);      /* Load ticks in tick list                            */
         OS_EXIT_CRITICAL();
         OS_Sched();                              /* Find next task to run!                             */
     }
@@ -188,7 +188,7 @@ INT8U  OSTimeDlyResume (INT8U prio)
         return (OS_ERR_TIME_NOT_DLY);                          /* Indicate that task was not delayed   */
     }
 
-    ptcb->OSTCBDly = 0u;                                       /* Clear the time delay                 */
+    OS_TickListRemove(ptcb);                                   /* Clear the time delay                 */
     if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
         ptcb->OSTCBStat     &= ~OS_STAT_PEND_ANY;              /* Yes, Clear status flag               */
         ptcb->OSTCBStatPend  =  OS_STAT_PEND_TO;               /* Indicate PEND timeout                */
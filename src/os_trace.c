@@ -0,0 +1,148 @@
+/*
+*********************************************************************************************************
+*                                                uC/OS-II
+*                                          The Real-Time Kernel
+*                                          EVENT TRACE RECORDER
+*
+* File    : OS_TRACE.C
+* Version : V2.92.11
+*
+* Note(s) : (1) See OS_TRACE.H for the record format and the recording rules.
+*********************************************************************************************************
+*/
+
+#define  MICRIUM_SOURCE
+
+#ifndef  OS_MASTER_FILE
+#include <ucos_ii.h>
+#endif
+
+#if OS_TRACE_EN > 0u
+
+#if (OS_TRACE_BUF_SIZE & (OS_TRACE_BUF_SIZE - 1u)) != 0u
+#error  "OS_CFG.H, OS_TRACE_BUF_SIZE must be a power of 2"
+#endif
+
+OS_TRACE_RING   OSTraceRing[OS_TRACE_CORE_MAX] __attribute__((aligned(64)));
+volatile INT8U  OSTraceOn = 1u;                         /* Record from reset on                            */
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      START / STOP RECORDING
+*
+* Description: OSTraceStart() empties every ring and (re)enables recording.  OSTraceStop() disables
+*              recording; the rings keep their contents until the next OSTraceStart().
+*
+* Arguments  : none
+*
+* Returns    : none
+*
+* Note(s)    : 1) An event being recorded on another core while OSTraceStart() runs may survive the reset
+*                 as the first record of that ring.
+*********************************************************************************************************
+*/
+
+void  OSTraceStart (void)
+{
+    INT8U  core;
+
+
+    OSTraceOn = 0u;
+    for (core = 0u; core < OS_TRACE_CORE_MAX; core++) {
+        __atomic_store_n(&OSTraceRing[core].OSTraceCtr, 0u, __ATOMIC_RELAXED);
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    OSTraceOn = 1u;
+}
+
+
+void  OSTraceStop (void)
+{
+    OSTraceOn = 0u;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                          DUMP THE TRACE RINGS
+*
+* Description: This function prints the trace rings as text, oldest record first, then restarts
+*              recording with empty rings.  The output is line oriented so that it can be cut out of a
+*              console log:
+*
+*                  [TRACE] BEGIN <counter frequency, Hz> <number of rings>
+*                  [TRACE] TASK <prio> <name>                      one per task, for the converter
+*                  [TRACE] CORE <core> <events recorded> <events lost to wrapping>
+*                  [TRACE] R <core> <timestamp, hex> <id> <arg0> <arg1, hex>
+*                  [TRACE] END
+*
+* Arguments  : none
+*
+* Returns    : none
+*
+* Note(s)    : 1) Call from task level.  Recording is stopped while the rings are printed, so the dump
+*                 itself does not show up in the trace.
+*
+*              2) tools/trace2json.py converts the lines to Chrome trace JSON.
+*********************************************************************************************************
+*/
+
+void  OSTraceDump (void)
+{
+    OS_TCB        *ptcb;
+    OS_TRACE_REC  *prec;
+    const char    *pname;
+    INT64U         freq;
+    INT32U         ctr;
+    INT32U         nbr;
+    INT32U         ix;
+    INT8U          core;
+#if OS_CRITICAL_METHOD == 3u                            /* Allocate storage for CPU status register        */
+    OS_CPU_SR      cpu_sr = 0u;
+#endif
+
+
+    OSTraceStop();
+
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r" (freq));
+    printf("[TRACE] BEGIN %llu %u\n", (unsigned long long)freq, (unsigned)OS_TRACE_CORE_MAX);
+
+    OSSchedLock();
+    for (ptcb = OSTCBList; ptcb != (OS_TCB *)0; ptcb = ptcb->OSTCBNext) {
+        OS_ENTER_CRITICAL();
+        ix = ptcb->OSTCBPrio;
+#if OS_TASK_NAME_EN > 0u
+        pname = (const char *)ptcb->OSTCBTaskName;
+#else
+        pname = "?";
+#endif
+        OS_EXIT_CRITICAL();
+        printf("[TRACE] TASK %u %s\n", (unsigned)ix, pname);
+    }
+    OSSchedUnlock();
+
+    for (core = 0u; core < OS_TRACE_CORE_MAX; core++) {
+        ctr = OSTraceRing[core].OSTraceCtr;
+        if (ctr == 0u) {
+            continue;
+        }
+        nbr = (ctr < OS_TRACE_BUF_SIZE) ? ctr : OS_TRACE_BUF_SIZE;
+        printf("[TRACE] CORE %u %u %u\n", (unsigned)core, (unsigned)ctr, (unsigned)(ctr - nbr));
+        for (ix = ctr - nbr; ix != ctr; ix++) {
+            prec = &OSTraceRing[core].OSTraceBuf[ix & (OS_TRACE_BUF_SIZE - 1u)];
+            printf("[TRACE] R %u %llx %u %u %x\n",
+                   (unsigned)core,
+                   (unsigned long long)prec->OSTraceTs,
+                   (unsigned)prec->OSTraceId,
+                   (unsigned)prec->OSTraceArg0,
+                   (unsigned)prec->OSTraceArg1);
+        }
+    }
+
+    printf("[TRACE] END\n");
+
+    OSTraceStart();
+}
+#endif
@@ -0,0 +1,179 @@
+/*
+*********************************************************************************************************
+*                                              uC/OS-II
+*                                        The Real-Time Kernel
+*
+*                                        EVENT TRACE RECORDER
+*
+* File    : OS_TRACE.H
+* Version : V2.92.11
+*********************************************************************************************************
+* Note(s) : (1) Every traced event appends one 16-byte OS_TRACE_REC to the ring of the core it ran on:
+*               the CNTVCT_EL0 timestamp, an event ID and two arguments.  Each core owns one ring and
+*               claims slots with a single atomic add, so recording takes no lock and never masks
+*               interrupts; a nested ISR simply claims the next slot.
+*
+*           (2) The rings are flight recorders: they wrap and keep the newest OS_TRACE_BUF_SIZE events.
+*               OSTraceDump() stops recording, prints the rings over the UART as text and starts
+*               recording again.  tools/trace2json.py turns a captured console log into Chrome trace
+*               (Perfetto) JSON.
+*
+*           (3) With OS_TRACE_EN set to 0 every OS_TRACE_xxx() macro expands to nothing, so the hooks
+*               cost no code and no data.
+*
+*           (4) This header only needs OS_CPU.H and OS_CFG.H, so code that runs outside the kernel (the
+*               secondary cores in bsp_cpu.c) can include it on its own.
+*********************************************************************************************************
+*/
+
+#ifndef   OS_TRACE_H
+#define   OS_TRACE_H
+
+#include  <os_cpu.h>
+#include  <os_cfg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+*********************************************************************************************************
+*                                             EVENT IDs
+*
+* Note(s) : (1) Keep in sync with tools/trace2json.py.
+*********************************************************************************************************
+*/
+
+#define  OS_TRACE_ID_TASK_SW            1u              /* Arg0: prio switched out, Arg1: prio switched in */
+#define  OS_TRACE_ID_ISR_ENTER          2u              /* Arg0: interrupt ID                              */
+#define  OS_TRACE_ID_ISR_EXIT           3u              /* Arg0: interrupt ID                              */
+#define  OS_TRACE_ID_SEM_POST           4u              /* Arg0: task readied (1) or count++ (0), Arg1: ECB*/
+#define  OS_TRACE_ID_SEM_PEND           5u              /* Arg0: calling prio, Arg1: ECB; task blocks      */
+#define  OS_TRACE_ID_SEM_PEND_DONE      6u              /* Arg0: error code,   Arg1: ECB; task resumed     */
+#define  OS_TRACE_ID_NET_RX_POST        7u              /* Arg0: queue pair,   Arg1: descriptors posted    */
+#define  OS_TRACE_ID_NET_RX_BEGIN       8u              /* Arg0: queue pair,   Arg1: descriptors in burst  */
+#define  OS_TRACE_ID_NET_RX_END         9u              /* Arg0: queue pair,   Arg1: descriptors in burst  */
+#define  OS_TRACE_ID_NET_TX            10u              /* Arg0: queue pair,   Arg1: frame length          */
+
+#define  OS_TRACE_CORE_MAX              4u              /* Rings, indexed by MPIDR_EL1.Aff0 (BSP_CPU_MAX)  */
+
+#if OS_TRACE_EN > 0u
+
+/*
+*********************************************************************************************************
+*                                             DATA TYPES
+*********************************************************************************************************
+*/
+
+typedef struct os_trace_rec {                           /* 16 bytes, four per cache line                   */
+    INT64U   OSTraceTs;                                 /* CNTVCT_EL0 when the event was recorded          */
+    INT16U   OSTraceId;                                 /* OS_TRACE_ID_xxx                                 */
+    INT16U   OSTraceArg0;
+    INT32U   OSTraceArg1;
+} OS_TRACE_REC;
+
+typedef struct os_trace_ring {
+    INT32U         OSTraceCtr;                          /* Events recorded since start, free running       */
+    INT8U          OSTracePad[60];                      /* Records start on their own cache line           */
+    OS_TRACE_REC   OSTraceBuf[OS_TRACE_BUF_SIZE];
+} OS_TRACE_RING;
+
+
+/*
+*********************************************************************************************************
+*                                          GLOBAL VARIABLES
+*********************************************************************************************************
+*/
+
+extern  OS_TRACE_RING   OSTraceRing[OS_TRACE_CORE_MAX];
+extern  volatile INT8U  OSTraceOn;                      /* Recording enabled                               */
+
+
+/*
+*********************************************************************************************************
+*                                         FUNCTION PROTOTYPES
+*********************************************************************************************************
+*/
+
+void  OSTraceStart (void);
+void  OSTraceStop  (void);
+void  OSTraceDump  (void);
+
+
+/*
+*********************************************************************************************************
+*                                           RECORD AN EVENT
+*
+* Description: Append one record to the ring of the calling core.
+*
+* Arguments  : id       is the event ID (see OS_TRACE_ID_xxx).
+*
+*              arg0     is the first, 16-bit argument.
+*
+*              arg1     is the second, 32-bit argument.
+*
+* Returns    : none
+*
+* Note(s)    : 1) A handful of instructions: two system register reads, one LDXR/STXR add and a 16-byte
+*                 store.  Only general purpose registers are used, so it may be called from the IRQ
+*                 entry and from OSTaskSwHook() while FP/SIMD is trapped.
+*
+*              2) The counter is claimed before the record is written.  A dump racing with a writer may
+*                 therefore print one stale record; OSTraceDump() stops recording first to avoid that.
+*********************************************************************************************************
+*/
+
+static  inline  void  OS_TraceRec (INT16U  id,
+                                   INT16U  arg0,
+                                   INT32U  arg1)
+{
+    INT64U          mpidr;
+    INT32U          ix;
+    OS_TRACE_RING  *pring;
+    OS_TRACE_REC   *prec;
+
+
+    if (OSTraceOn == 0u) {
+        return;
+    }
+    __asm__ volatile("mrs %0, mpidr_el1" : "=r" (mpidr));
+    pring                = &OSTraceRing[mpidr & (OS_TRACE_CORE_MAX - 1u)];
+    ix                   = __atomic_fetch_add(&pring->OSTraceCtr, 1u, __ATOMIC_RELAXED);
+    prec                 = &pring->OSTraceBuf[ix & (OS_TRACE_BUF_SIZE - 1u)];
+    prec->OSTraceTs      = OS_CPU_CyclesGet();
+    prec->OSTraceId      = id;
+    prec->OSTraceArg0    = arg0;
+    prec->OSTraceArg1    = arg1;
+}
+
+#define  OS_TRACE_TASK_SW(prio_out, prio_in)     OS_TraceRec(OS_TRACE_ID_TASK_SW,       (INT16U)(prio_out), (INT32U)(prio_in))
+#define  OS_TRACE_ISR_ENTER(int_id)              OS_TraceRec(OS_TRACE_ID_ISR_ENTER,     (INT16U)(int_id),   0u)
+#define  OS_TRACE_ISR_EXIT(int_id)               OS_TraceRec(OS_TRACE_ID_ISR_EXIT,      (INT16U)(int_id),   0u)
+#define  OS_TRACE_SEM_POST(pevent, rdy)          OS_TraceRec(OS_TRACE_ID_SEM_POST,      (INT16U)(rdy),      (INT32U)(INT64U)(pevent))
+#define  OS_TRACE_SEM_PEND(pevent, prio)         OS_TraceRec(OS_TRACE_ID_SEM_PEND,      (INT16U)(prio),     (INT32U)(INT64U)(pevent))
+#define  OS_TRACE_SEM_PEND_DONE(pevent, err)     OS_TraceRec(OS_TRACE_ID_SEM_PEND_DONE, (INT16U)(err),      (INT32U)(INT64U)(pevent))
+#define  OS_TRACE_NET_RX_POST(qp, nbr)           OS_TraceRec(OS_TRACE_ID_NET_RX_POST,   (INT16U)(qp),       (INT32U)(nbr))
+#define  OS_TRACE_NET_RX_BEGIN(qp, nbr)          OS_TraceRec(OS_TRACE_ID_NET_RX_BEGIN,  (INT16U)(qp),       (INT32U)(nbr))
+#define  OS_TRACE_NET_RX_END(qp, nbr)            OS_TraceRec(OS_TRACE_ID_NET_RX_END,    (INT16U)(qp),       (INT32U)(nbr))
+#define  OS_TRACE_NET_TX(qp, len)                OS_TraceRec(OS_TRACE_ID_NET_TX,        (INT16U)(qp),       (INT32U)(len))
+
+#else                                                   /* See Note #3.                                    */
+
+#define  OS_TRACE_TASK_SW(prio_out, prio_in)
+#define  OS_TRACE_ISR_ENTER(int_id)
+#define  OS_TRACE_ISR_EXIT(int_id)
+#define  OS_TRACE_SEM_POST(pevent, rdy)
+#define  OS_TRACE_SEM_PEND(pevent, prio)
+#define  OS_TRACE_SEM_PEND_DONE(pevent, err)
+#define  OS_TRACE_NET_RX_POST(qp, nbr)
+#define  OS_TRACE_NET_RX_BEGIN(qp, nbr)
+#define  OS_TRACE_NET_RX_END(qp, nbr)
+#define  OS_TRACE_NET_TX(qp, len)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Packet buffer pool
+ *
+ * The depot is a lock-free kernel partition (OSMemLFxxx() in os_mem.c): a
+ * batch moves in or out with one compare-and-swap, so no core ever waits for
+ * another. The caches are plain stacks: the buffer freed last is the one
+ * handed out next, which is usually still warm in this core's cache.
+ */
+
+#include "pktbuf.h"
+#include "includes.h"
+#include <bsp_cpu.h>
+
+struct pktbuf_cache {
+    u32 count;
+    u32 gets;
+    u32 puts;
+    u32 refills;
+    u32 flushes;
+    u32 fails;
+    void *buf[PKTBUF_CACHE_SIZE];
+} __attribute__((aligned(64)));
+
+static u8 *pktbuf_base;
+static u32 pktbuf_count;
+static u32 pktbuf_depot_low;            /* Fewest free buffers seen in the depot */
+static OS_MEM_LF pktbuf_depot;
+static struct pktbuf_cache pktbuf_caches[PKTBUF_CORES];
+
+static inline struct pktbuf_cache *pktbuf_cache_get(void)
+{
+    return &pktbuf_caches[BSP_CPU_IdGet() & (PKTBUF_CORES - 1u)];
+}
+
+/* Move up to PKTBUF_BATCH buffers from the depot into an empty cache */
+static void pktbuf_refill(struct pktbuf_cache *c)
+{
+    u32 left;
+
+    c->count += OSMemLFGetBatch(&pktbuf_depot, &c->buf[c->count], PKTBUF_BATCH);
+    c->refills++;
+
+    /* Racy across cores, which only matters to the statistic */
+    left = __atomic_load_n(&pktbuf_depot.OSMemLFNFree, __ATOMIC_RELAXED);
+    if (left < pktbuf_depot_low) {
+        pktbuf_depot_low = left;
+    }
+}
+
+/* Return the PKTBUF_BATCH coldest buffers of a full cache to the depot */
+static void pktbuf_flush(struct pktbuf_cache *c)
+{
+    (void)OSMemLFPutBatch(&pktbuf_depot, c->buf, PKTBUF_BATCH);
+
+    c->count -= PKTBUF_BATCH;
+    memmove(&c->buf[0], &c->buf[PKTBUF_BATCH], c->count * sizeof(c->buf[0]));
+    c->flushes++;
+}
+
+/**
+ * pktbuf_init() - Carve the pool
+ * @count: Number of buffers
+ *
+ * Allocates count * PKTBUF_SIZE bytes from the heap in one block and puts
+ * every buffer in the depot. Later calls do nothing.
+ *
+ * Return: 0 on success, -1 if the heap cannot hold the pool.
+ */
+int pktbuf_init(u32 count)
+{
+    u8 *base;
+    INT8U err;
+
+    if (pktbuf_base) {
+        return 0;
+    }
+
+    base = memalign(PKTBUF_ALIGN, (size_t)count * PKTBUF_SIZE);
+    if (!base) {
+        printf("[PKTBUF] Cannot allocate %u buffers\n", count);
+        return -1;
+    }
+
+    err = OSMemLFCreate(&pktbuf_depot, base, count, PKTBUF_SIZE);
+    if (err != OS_ERR_NONE) {
+        printf("[PKTBUF] Depot creation failed (err=%d)\n", err);
+        free(base);
+        return -1;
+    }
+    pktbuf_depot_low = count;
+    pktbuf_count = count;
+    pktbuf_base = base;
+
+    printf("[PKTBUF] %u buffers of %u bytes (%u headroom) at %p\n",
+           count, PKTBUF_SIZE, PKTBUF_HEADROOM, (void *)pktbuf_base);
+
+    return 0;
+}
+
+/**
+ * pktbuf_get() - Take a buffer from the calling core's cache
+ *
+ * Safe from tasks and ISRs on any core.
+ *
+ * Return: the start of the buffer (see pktbuf_data()), or NULL if the pool
+ * is empty.
+ */
+void *pktbuf_get(void)
+{
+    struct pktbuf_cache *c;
+    void *buf = NULL;
+    OS_CPU_SR cpu_sr = 0u;
+
+    OS_ENTER_CRITICAL();
+    c = pktbuf_cache_get();
+    if (c->count == 0u) {
+        pktbuf_refill(c);
+    }
+    if (c->count != 0u) {
+        buf = c->buf[--c->count];
+        c->gets++;
+    } else {
+        c->fails++;
+    }
+    OS_EXIT_CRITICAL();
+
+    return buf;
+}
+
+/**
+ * pktbuf_put() - Give a buffer back to the calling core's cache
+ * @ptr: Any address inside the buffer, such as the frame pointer; NULL and
+ *       addresses outside the pool are ignored
+ */
+void pktbuf_put(void *ptr)
+{
+    struct pktbuf_cache *c;
+    size_t off;
+    OS_CPU_SR cpu_sr = 0u;
+
+    off = (size_t)((u8 *)ptr - pktbuf_base);
+    if (!ptr || (u8 *)ptr < pktbuf_base || off >= (size_t)pktbuf_count * PKTBUF_SIZE) {
+        return;
+    }
+
+    OS_ENTER_CRITICAL();
+    c = pktbuf_cache_get();
+    if (c->count == PKTBUF_CACHE_SIZE) {
+        pktbuf_flush(c);
+    }
+    c->buf[c->count++] = pktbuf_base + off - (off % PKTBUF_SIZE);
+    c->puts++;
+    OS_EXIT_CRITICAL();
+}
+
+/**
+ * pktbuf_stats_get() - Snapshot the pool counters
+ * @st: Result
+ *
+ * The per-core numbers are read without stopping the other cores, so a busy
+ * pool may show an in_use count that is off by a batch.
+ */
+void pktbuf_stats_get(struct pktbuf_stats *st)
+{
+    const struct pktbuf_cache *c;
+    u32 i;
+
+    memset(st, 0, sizeof(*st));
+    st->total = pktbuf_count;
+    st->depot_free = __atomic_load_n(&pktbuf_depot.OSMemLFNFree, __ATOMIC_RELAXED);
+    st->depot_low = pktbuf_depot_low;
+
+    for (i = 0u; i < PKTBUF_CORES; i++) {
+        c = &pktbuf_caches[i];
+        st->cached += c->count;
+        st->gets += c->gets;
+        st->puts += c->puts;
+        st->refills += c->refills;
+        st->flushes += c->flushes;
+        st->fails += c->fails;
+    }
+
+    st->in_use = st->total - st->depot_free - st->cached;
+}
+
+/**
+ * pktbuf_report() - Print the pool counters on the console
+ */
+void pktbuf_report(void)
+{
+    struct pktbuf_stats st;
+
+    pktbuf_stats_get(&st);
+    printf("[PKTBUF] %u buffers: %u in use, %u in core caches, depot %u (low water %u)\n",
+           st.total, st.in_use, st.cached, st.depot_free, st.depot_low);
+    printf("[PKTBUF] get %u put %u, refills %u flushes %u, empty %u\n",
+           st.gets, st.puts, st.refills, st.flushes, st.fails);
+}
@@ -0,0 +1,72 @@
+/*
+ * Packet buffer pool
+ *
+ * Fixed-size frame buffers carved from one contiguous, cache-line aligned
+ * region of the heap. Each buffer reserves PKTBUF_HEADROOM bytes in front of
+ * the frame for the virtio-net header and any header a forwarding path wants
+ * to prepend, so a frame can go from one NIC's RX ring to another NIC's TX
+ * ring without being copied.
+ *
+ * Every core has a private cache of free buffers in front of a shared depot.
+ * get/put only touch the calling core's cache with its interrupts masked; the
+ * depot, a lock-free partition, is visited once per PKTBUF_BATCH buffers, when
+ * a cache runs empty or full. Any core may free a buffer another core
+ * allocated.
+ */
+
+#ifndef _PKTBUF_H_
+#define _PKTBUF_H_
+
+#include <asm/types.h>
+
+#define PKTBUF_HEADROOM         64u     /* One cache line in front of the frame */
+#define PKTBUF_DATA_SIZE        1536u   /* PKTSIZE_ALIGN */
+#define PKTBUF_SIZE             (PKTBUF_HEADROOM + PKTBUF_DATA_SIZE)
+#define PKTBUF_ALIGN            64u
+
+#define PKTBUF_CORES            4u      /* BSP_CPU_MAX */
+#define PKTBUF_CACHE_SIZE       32u     /* Free buffers a core keeps to itself */
+#define PKTBUF_BATCH            16u     /* Buffers moved per depot visit */
+
+_Static_assert((PKTBUF_SIZE % PKTBUF_ALIGN) == 0u, "packet buffers must stay cache-line aligned");
+_Static_assert(PKTBUF_BATCH <= PKTBUF_CACHE_SIZE, "PKTBUF_BATCH larger than a core cache");
+
+/**
+ * struct pktbuf_stats - Pool counters, summed over the cores
+ * @total: Buffers in the pool
+ * @in_use: Buffers handed out and not yet returned
+ * @depot_free: Buffers in the depot
+ * @depot_low: Fewest buffers the depot has held since pktbuf_init()
+ * @cached: Buffers sitting in the per-core caches
+ * @gets: Successful pktbuf_get() calls
+ * @puts: pktbuf_put() calls
+ * @refills: Cache refills from the depot
+ * @flushes: Cache flushes to the depot
+ * @fails: pktbuf_get() calls that found the pool empty
+ */
+struct pktbuf_stats {
+    u32 total;
+    u32 in_use;
+    u32 depot_free;
+    u32 depot_low;
+    u32 cached;
+    u32 gets;
+    u32 puts;
+    u32 refills;
+    u32 flushes;
+    u32 fails;
+};
+
+int pktbuf_init(u32 count);
+void *pktbuf_get(void);
+void pktbuf_put(void *ptr);
+void pktbuf_stats_get(struct pktbuf_stats *st);
+void pktbuf_report(void);
+
+/* Start of the frame in a buffer returned by pktbuf_get() */
+static inline u8 *pktbuf_data(void *buf)
+{
+    return (u8 *)buf + PKTBUF_HEADROOM;
+}
+
+#endif /* _PKTBUF_H_ */
@@ -1,5 +1,6 @@
 #include "pl011.h"
 #include "includes.h"
+#include <bsp_int.h>
 
 volatile pl011_t* const UART0 = (pl011_t*)UART0_BASE;
 
@@ -8,21 +9,52 @@ inline void uart_putc(char c){
 	UART0->DR = c;
 }
 
-char  UART_Handler(){
-
-	int count=0;
-	uart_puts("UART_Handler: ");
-	while(UART0->FR & RXFE){
-		count++;
-		if(count>10000)
-			break;
-	};
-	if(count>10000)
-		return 0;
-
-	uart_putc(UART0->DR);
-	uart_puts("\n");
-	return UART0->DR;
+/*
+ * RX has one owner, the interrupt: UART_Handler() drains the FIFO into
+ * uart_rx_buf and wakes the task registered with uart_rx_notify(), and
+ * uart_trygetc() only reads the ring. Single producer, single consumer.
+ */
+#define UART_RX_BUF_SIZE	64u	/* Power of two */
+
+static volatile uint8_t uart_rx_buf[UART_RX_BUF_SIZE];
+static uint32_t uart_rx_head;	/* Written by UART_Handler() */
+static uint32_t uart_rx_tail;	/* Written by uart_trygetc() */
+static uint8_t uart_rx_prio = OS_PRIO_SELF;	/* Task to wake, OS_PRIO_SELF = none */
+
+/* Next received byte, or -1 if none is buffered */
+int uart_trygetc(void){
+	uint32_t tail = uart_rx_tail;
+	int c;
+
+	if(tail == __atomic_load_n(&uart_rx_head, __ATOMIC_ACQUIRE))
+		return -1;
+	c = uart_rx_buf[tail & (UART_RX_BUF_SIZE - 1u)];
+	__atomic_store_n(&uart_rx_tail, tail + 1u, __ATOMIC_RELEASE);
+	return c;
+}
+
+/* Post a notification to task 'prio' whenever bytes arrive */
+void uart_rx_notify(uint8_t prio){
+	uart_rx_prio = prio;
+}
+
+static void UART_Handler(CPU_INT32U int_id){
+	uint32_t head = uart_rx_head;
+
+	(void)int_id;
+
+	while(!(UART0->FR & RXFE)){
+		uint8_t c = (uint8_t)(UART0->DR & 0xFF);
+
+		if((head - __atomic_load_n(&uart_rx_tail, __ATOMIC_ACQUIRE)) < UART_RX_BUF_SIZE)	/* Drop on overflow */
+			uart_rx_buf[head++ & (UART_RX_BUF_SIZE - 1u)] = c;
+	}
+	__atomic_store_n(&uart_rx_head, head, __ATOMIC_RELEASE);
+
+#if OS_TASK_NOTIFY_EN > 0u
+	if(uart_rx_prio != OS_PRIO_SELF)
+		(void)OSTaskNotifyPost(uart_rx_prio, 1u, OS_NOTIFY_OPT_SET_BITS);
+#endif
 }
 
 //ruby added
@@ -32,7 +64,7 @@ void BSP_OS_UARTInit()
 	//UART0INTR is in interrupt 5
 	//5+32=37
     BSP_IntVectSet (33u,
-                    0u,
+                    BSP_INT_PRIO_DFLT,
                     0u,
                     UART_Handler);
 
@@ -33,4 +33,6 @@ enum {
 
 void uart_putc(char c);
 char uart_getc();
+int uart_trygetc(void);
+void uart_rx_notify(uint8_t prio);
 #endif
@@ -5,6 +5,7 @@
 #include <limits.h>
 
 #include "portable_libc.h"
+#include "heap.h"
 #include "pl011.h"
 #include "uart.h"
 
@@ -15,7 +16,6 @@
  * used throughout this project.
  */
 
-extern void *_sbrk(ptrdiff_t size);
 struct _reent;
 
 /* -------------------------------------------------------------------------- */
@@ -240,32 +240,149 @@ char *strncat(char *dest, const char *src, size_t n)
 }
 
 /* -------------------------------------------------------------------------- */
-/* Minimal heap primitives                                                    */
+/* Heap                                                                       */
 /* -------------------------------------------------------------------------- */
 
-typedef struct alloc_header {
-    size_t size;
-} alloc_header_t;
+/*
+ * The TLSF heap in heap.c owns the whole .heap region of linker.ld and is set
+ * up on first use. Every operation is O(1) and runs with IRQs masked and a
+ * spinlock held, so malloc()/free() may be called from tasks, ISRs and the
+ * secondary cores alike. realloc() copies outside the lock.
+ */
+
+extern char _heap_start[];
+extern char _heap_end[];
+
+static struct heap sys_heap;
+static bool sys_heap_ready;
+static bool sys_heap_busy;
+
+static uint64_t sys_heap_lock(void)
+{
+    uint64_t daif;
+
+    __asm__ volatile("mrs %0, daif\n\tmsr daifset, #2" : "=r"(daif) : : "memory");
+    while (__atomic_test_and_set(&sys_heap_busy, __ATOMIC_ACQUIRE)) {
+    }
+
+    if (!sys_heap_ready) {
+        heap_init(&sys_heap, _heap_start, (size_t)(_heap_end - _heap_start));
+        sys_heap_ready = true;
+    }
+
+    return daif;
+}
+
+static void sys_heap_unlock(uint64_t daif)
+{
+    __atomic_clear(&sys_heap_busy, __ATOMIC_RELEASE);
+    __asm__ volatile("msr daif, %0" : : "r"(daif) : "memory");
+}
 
 void *malloc(size_t size)
 {
-    if (size == 0) {
+    uint64_t daif = sys_heap_lock();
+    void *p = heap_alloc(&sys_heap, size);
+
+    sys_heap_unlock(daif);
+    return p;
+}
+
+void free(void *ptr)
+{
+    uint64_t daif;
+
+    if (ptr == NULL) {
+        return;
+    }
+    daif = sys_heap_lock();
+    heap_free(&sys_heap, ptr);
+    sys_heap_unlock(daif);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    uint64_t daif = sys_heap_lock();
+    void *p = heap_memalign(&sys_heap, alignment, size);
+
+    sys_heap_unlock(daif);
+    return p;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    void *p;
+
+    if (size != 0u && nmemb > SIZE_MAX / size) {
         return NULL;
     }
+    p = malloc(nmemb * size);
+    if (p != NULL) {
+        memset(p, 0, nmemb * size);
+    }
+    return p;
+}
 
-    size_t total = size + sizeof(alloc_header_t);
-    alloc_header_t *hdr = (alloc_header_t *)_sbrk((ptrdiff_t)total);
-    if (hdr == (alloc_header_t *)-1) {
+void *realloc(void *ptr, size_t size)
+{
+    uint64_t daif;
+    size_t old;
+    void *p;
+    int moved;
+
+    if (ptr == NULL) {
+        return malloc(size);
+    }
+    if (size == 0u) {
+        free(ptr);
         return NULL;
     }
-    hdr->size = size;
-    return (void *)(hdr + 1);
+
+    daif = sys_heap_lock();
+    moved = heap_resize(&sys_heap, ptr, size);
+    sys_heap_unlock(daif);
+    if (moved == 0) {
+        return ptr;
+    }
+
+    p = malloc(size);
+    if (p != NULL) {
+        old = heap_usable_size(ptr);
+        memcpy(p, ptr, old < size ? old : size);
+        free(ptr);
+    }
+    return p;
 }
 
-void free(void *ptr)
+size_t malloc_usable_size(void *ptr)
+{
+    return heap_usable_size(ptr);
+}
+
+void malloc_stats_get(struct heap_stats *st)
+{
+    uint64_t daif = sys_heap_lock();
+
+    heap_stats(&sys_heap, st);
+    sys_heap_unlock(daif);
+}
+
+void malloc_stats(void)
 {
-    (void)ptr;
-    /* Simple bump allocator: free() is intentionally a no-op. */
+    struct heap_stats st;
+
+    malloc_stats_get(&st);
+    printf("[HEAP] %lu KiB, used %lu KiB in %lu blocks, peak %lu KiB, failed %lu\n",
+           (unsigned long)(st.size >> 10), (unsigned long)(st.used >> 10),
+           (unsigned long)st.used_blocks, (unsigned long)(st.peak_used >> 10), st.fails);
+    printf("[HEAP] free %lu KiB in %lu blocks, largest %lu KiB, fragmentation %u.%u%%\n",
+           (unsigned long)(st.free >> 10), (unsigned long)st.free_blocks,
+           (unsigned long)(st.largest_free >> 10), st.frag_permille / 10u, st.frag_permille % 10u);
 }
 
 /* -------------------------------------------------------------------------- */
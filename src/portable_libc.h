@@ -20,8 +20,17 @@ size_t strlen(const char *s);
 char *strcpy(char *dest, const char *src);
 char *strncat(char *dest, const char *src, size_t n);
 
+struct heap_stats;
+
 void *malloc(size_t size);
 void free(void *ptr);
+void *calloc(size_t nmemb, size_t size);
+void *realloc(void *ptr, size_t size);
+void *memalign(size_t alignment, size_t size);
+void *aligned_alloc(size_t alignment, size_t size);
+size_t malloc_usable_size(void *ptr);
+void malloc_stats_get(struct heap_stats *st);
+void malloc_stats(void);
 void exit(int status);
 
 int *__errno_location(void);
@@ -80,13 +80,21 @@ extern "C" {
 #define  OS_TASK_STAT_PRIO  (OS_LOWEST_PRIO - 1u)       /* Statistic task priority                     */
 #define  OS_TASK_IDLE_PRIO  (OS_LOWEST_PRIO)            /* IDLE      task priority                     */
 
-#if OS_LOWEST_PRIO <= 63u
-#define  OS_EVENT_TBL_SIZE ((OS_LOWEST_PRIO) / 8u + 1u) /* Size of event table                         */
-#define  OS_RDY_TBL_SIZE   ((OS_LOWEST_PRIO) / 8u + 1u) /* Size of ready table                         */
+#ifndef  OS_CPU_PRIO_BITMAP_64
+#define  OS_CPU_PRIO_BITMAP_64          0u              /* Port resolves 64-bit bitmap rows (os_cpu.h) */
+#endif
+
+#if   OS_CPU_PRIO_BITMAP_64 > 0u                        /* Priorities per ready/event table row ...    */
+#define  OS_PRIO_ROW_SHIFT              6u              /* ... 64, found with OS_CPU_PrioLowBit()      */
+#elif OS_LOWEST_PRIO <= 63u
+#define  OS_PRIO_ROW_SHIFT              3u              /* ...  8, found with OSUnMapTbl[]             */
 #else
-#define  OS_EVENT_TBL_SIZE ((OS_LOWEST_PRIO) / 16u + 1u)/* Size of event table                         */
-#define  OS_RDY_TBL_SIZE   ((OS_LOWEST_PRIO) / 16u + 1u)/* Size of ready table                         */
+#define  OS_PRIO_ROW_SHIFT              4u              /* ... 16, found with OSUnMapTbl[]             */
 #endif
+#define  OS_PRIO_ROW_MSK   ((1u << OS_PRIO_ROW_SHIFT) - 1u)
+
+#define  OS_EVENT_TBL_SIZE ((OS_LOWEST_PRIO >> OS_PRIO_ROW_SHIFT) + 1u) /* Size of event table         */
+#define  OS_RDY_TBL_SIZE   ((OS_LOWEST_PRIO >> OS_PRIO_ROW_SHIFT) + 1u) /* Size of ready table         */
 
 #define  OS_TASK_IDLE_ID            65535u              /* ID numbers for Idle, Stat and Timer tasks   */
 #define  OS_TASK_STAT_ID            65534u
@@ -96,6 +104,16 @@ extern "C" {
 
 #define  OS_TCB_RESERVED        ((OS_TCB *)1)
 
+#if OS_STATIC_CREATE_EN > 0u                            /* Control block came from the kernel's tables */
+#define  OS_EVENT_POOLED(pevent) (((pevent) >= &OSEventTbl[0]) && ((pevent) < &OSEventTbl[OS_MAX_EVENTS]))
+#define  OS_Q_POOLED(pq)         (((pq)     >= &OSQTbl[0])     && ((pq)     < &OSQTbl[OS_MAX_QS]))
+#define  OS_TCB_POOLED(ptcb)     (((ptcb)   >= &OSTCBTbl[0])   && ((ptcb)   < &OSTCBTbl[OS_MAX_TASKS + OS_N_SYS_TASKS]))
+#else
+#define  OS_EVENT_POOLED(pevent) (1)
+#define  OS_Q_POOLED(pq)         (1)
+#define  OS_TCB_POOLED(ptcb)     (1)
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -109,9 +127,10 @@ extern "C" {
 #define  OS_STAT_SUSPEND             0x08u  /* Task is suspended                                       */
 #define  OS_STAT_MUTEX               0x10u  /* Pending on mutual exclusion semaphore                   */
 #define  OS_STAT_FLAG                0x20u  /* Pending on event flag group                             */
+#define  OS_STAT_NOTIFY              0x40u  /* Pending on direct task notification                     */
 #define  OS_STAT_MULTI               0x80u  /* Pending on multiple events                              */
 
-#define  OS_STAT_PEND_ANY         (OS_STAT_SEM | OS_STAT_MBOX | OS_STAT_Q | OS_STAT_MUTEX | OS_STAT_FLAG)
+#define  OS_STAT_PEND_ANY         (OS_STAT_SEM | OS_STAT_MBOX | OS_STAT_Q | OS_STAT_MUTEX | OS_STAT_FLAG | OS_STAT_NOTIFY)
 
 /*
 *********************************************************************************************************
@@ -216,6 +235,15 @@ extern "C" {
 #define  OS_TASK_OPT_SAVE_FP       0x0004u  /* Save the contents of any floating-point registers       */
 #define  OS_TASK_OPT_NO_TLS        0x0008u  /* Specify that task doesn't needs TLS                     */
 
+/*
+*********************************************************************************************************
+*                                TASK NOTIFY OPTIONS (see OSTaskNotifyPost())
+*********************************************************************************************************
+*/
+#define  OS_NOTIFY_OPT_SET_BITS         0u  /* OR 'val' into the notification word                     */
+#define  OS_NOTIFY_OPT_INC              1u  /* Add 'val' to the notification word (counting semaphore) */
+#define  OS_NOTIFY_OPT_OVERWRITE        2u  /* Replace the notification word with 'val' (mailbox)      */
+
 /*
 *********************************************************************************************************
 *                          TIMER OPTIONS (see OSTmrStart() and OSTmrStop())
@@ -367,7 +395,9 @@ typedef  INT8U                       OS_TLS_ID;
 *********************************************************************************************************
 */
 
-#if OS_LOWEST_PRIO <= 63u
+#if   OS_CPU_PRIO_BITMAP_64 > 0u
+typedef  INT64U   OS_PRIO;
+#elif OS_LOWEST_PRIO <= 63u
 typedef  INT8U    OS_PRIO;
 #else
 typedef  INT16U   OS_PRIO;
@@ -478,6 +508,19 @@ typedef struct os_mem_data {
 } OS_MEM_DATA;
 #endif
 
+
+#if (OS_MEM_EN > 0u) && (OS_MEM_LF_EN > 0u)
+typedef struct os_mem_lf {                  /* LOCK-FREE MEMORY PARTITION (see OS_MEM.C)               */
+    void   *OSMemLFFreeList;                /* Top of the stack of free blocks    \ One 16-byte pair,  */
+    INT64U  OSMemLFTag;                     /* Bumped by every push and pop      / see OS_CPU_CAS2()   */
+    INT8U   OSMemLFPad[48];                 /* Counters on their own cache line                        */
+    void   *OSMemLFAddr;                    /* Pointer to beginning of memory partition                */
+    INT32U  OSMemLFBlkSize;                 /* Size (in bytes) of each block of memory                 */
+    INT32U  OSMemLFNBlks;                   /* Total number of blocks in this partition                */
+    INT32U  OSMemLFNFree;                   /* Free blocks; follows the stack, may lag it briefly      */
+} __attribute__((aligned(64))) OS_MEM_LF;
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -510,6 +553,9 @@ typedef struct os_q {                       /* QUEUE CONTROL BLOCK
     void         **OSQOut;                  /* Ptr to where next message will be extracted from the Q  */
     INT16U         OSQSize;                 /* Size of queue (maximum number of entries)               */
     INT16U         OSQEntries;              /* Current number of entries in the queue                  */
+#if OS_Q_BATCH_EN > 0u
+    INT16U         OSQThreshold;            /* Entries awaited by OSQPendBatch(), 0 if none waiting    */
+#endif
 } OS_Q;
 
 
@@ -549,6 +595,21 @@ typedef struct os_stk_data {
 } OS_STK_DATA;
 #endif
 
+/*
+*********************************************************************************************************
+*                                          TASK PROFILE DATA
+*********************************************************************************************************
+*/
+
+#if OS_TASK_PROFILE_EN > 0u
+typedef struct os_task_prof {
+    INT32U  OSCtxSwCtr;                     /* Number of times the task was switched in               */
+    INT32U  OSPreemptCtr;                   /* Number of times it was switched out while still ready   */
+    INT64U  OSCyclesTot;                    /* Run time, ISRs excluded (OS_CPU_CyclesGet() counts)     */
+    INT64U  OSCyclesMax;                    /* Longest run between switch-in and switch-out            */
+} OS_TASK_PROF;
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -596,6 +657,9 @@ typedef struct os_tcb {
 #endif
 
     INT32U           OSTCBDly;              /* Nbr ticks to delay task or, timeout waiting for event   */
+    INT32U           OSTCBDlyExpiry;        /* Value of OSTickCtr at which the delay expires           */
+    struct os_tcb   *OSTCBDlyNext;          /* Pointer to next     TCB in the tick list                */
+    struct os_tcb   *OSTCBDlyPrev;          /* Pointer to previous TCB in the tick list                */
     INT8U            OSTCBStat;             /* Task      status                                        */
     INT8U            OSTCBStatPend;         /* Task PEND status                                        */
     INT8U            OSTCBPrio;             /* Task priority (0 == highest)                            */
@@ -611,8 +675,11 @@ typedef struct os_tcb {
 
 #if OS_TASK_PROFILE_EN > 0u
     INT32U           OSTCBCtxSwCtr;         /* Number of time the task was switched in                 */
-    INT32U           OSTCBCyclesTot;        /* Total number of clock cycles the task has been running  */
-    INT32U           OSTCBCyclesStart;      /* Snapshot of cycle counter at start of task resumption   */
+    INT64U           OSTCBCyclesTot;        /* Total number of clock cycles the task has been running  */
+    INT64U           OSTCBCyclesStart;      /* Snapshot of cycle counter at start of task resumption   */
+    INT64U           OSTCBCyclesRun;        /* Cycles run since the task was last switched in          */
+    INT64U           OSTCBCyclesMax;        /* Longest run between switch-in and switch-out            */
+    INT32U           OSTCBPreemptCtr;       /* Number of times switched out while still ready          */
     OS_STK          *OSTCBStkBase;          /* Pointer to the beginning of the task stack              */
     INT32U           OSTCBStkUsed;          /* Number of bytes used from the stack                     */
 #endif
@@ -624,6 +691,15 @@ typedef struct os_tcb {
 #if OS_TASK_REG_TBL_SIZE > 0u
     INT32U           OSTCBRegTbl[OS_TASK_REG_TBL_SIZE];
 #endif
+
+#if OS_TASK_NOTIFY_EN > 0u
+    INT32U           OSTCBNotifyVal;        /* Notification word updated by OSTaskNotifyPost()         */
+    BOOLEAN          OSTCBNotifyPend;       /* A notification was posted and not yet consumed          */
+#endif
+
+#ifdef OS_CPU_TCB_EXT
+    OS_CPU_TCB_EXT                          /* Port specific per-task state (see OS_CPU.H)             */
+#endif
 } OS_TCB;
 
 /*$PAGE*/
@@ -758,6 +834,9 @@ OS_EXT  INT8U             OSTaskRegNextAvailID;     /* Next available Task regis
 OS_EXT  volatile  INT32U  OSTime;                   /* Current value of system time (in ticks)         */
 #endif
 
+OS_EXT  INT32U            OSTickCtr;                /* Ticks processed by the tick list                */
+OS_EXT  OS_TCB           *OSTickList;               /* Delayed tasks, sorted by expiry (earliest first)*/
+
 #if OS_TMR_EN > 0u
 OS_EXT  INT16U            OSTmrFree;                /* Number of free entries in the timer pool        */
 OS_EXT  INT16U            OSTmrUsed;                /* Number of timers used                           */
@@ -773,7 +852,9 @@ OS_EXT  OS_STK            OSTmrTaskStk[OS_TASK_TMR_STK_SIZE];
 OS_EXT  OS_TMR_WHEEL      OSTmrWheelTbl[OS_TMR_CFG_WHEEL_SIZE];
 #endif
 
+#if OS_CPU_PRIO_BITMAP_64 == 0u
 extern  INT8U   const     OSUnMapTbl[256];          /* Priority->Index    lookup table                 */
+#endif
 
 /*$PAGE*/
 /*
@@ -980,6 +1061,26 @@ INT8U         OSMemQuery              (OS_MEM          *pmem,
 
 #endif
 
+#if (OS_MEM_EN > 0u) && (OS_MEM_LF_EN > 0u)
+INT8U         OSMemLFCreate           (OS_MEM_LF       *pmem,
+                                       void            *addr,
+                                       INT32U           nblks,
+                                       INT32U           blksize);
+
+void         *OSMemLFGet              (OS_MEM_LF       *pmem);
+
+INT32U        OSMemLFGetBatch         (OS_MEM_LF       *pmem,
+                                       void           **pblks,
+                                       INT32U           nbr);
+
+INT8U         OSMemLFPut              (OS_MEM_LF       *pmem,
+                                       void            *pblk);
+
+INT8U         OSMemLFPutBatch         (OS_MEM_LF       *pmem,
+                                       void           **pblks,
+                                       INT32U           nbr);
+#endif
+
 /*
 *********************************************************************************************************
 *                                MUTUAL EXCLUSION SEMAPHORE MANAGEMENT
@@ -1032,6 +1133,13 @@ void         *OSQAccept               (OS_EVENT        *pevent,
 OS_EVENT     *OSQCreate               (void           **start,
                                        INT16U           size);
 
+#if OS_STATIC_CREATE_EN > 0u
+OS_EVENT     *OSQCreateStatic         (OS_EVENT        *pevent,
+                                       OS_Q            *pq,
+                                       void           **start,
+                                       INT16U           size);
+#endif
+
 #if OS_Q_DEL_EN > 0u
 OS_EVENT     *OSQDel                  (OS_EVENT        *pevent,
                                        INT8U            opt,
@@ -1052,11 +1160,27 @@ INT8U         OSQPendAbort            (OS_EVENT        *pevent,
                                        INT8U           *perr);
 #endif
 
+#if OS_Q_BATCH_EN > 0u
+INT16U        OSQPendBatch            (OS_EVENT        *pevent,
+                                       void           **pmsgs,
+                                       INT16U           size,
+                                       INT16U           min,
+                                       INT32U           timeout,
+                                       INT8U           *perr);
+#endif
+
 #if OS_Q_POST_EN > 0u
 INT8U         OSQPost                 (OS_EVENT        *pevent,
                                        void            *pmsg);
 #endif
 
+#if OS_Q_BATCH_EN > 0u
+INT16U        OSQPostBatch            (OS_EVENT        *pevent,
+                                       void           **pmsgs,
+                                       INT16U           nbr,
+                                       INT8U           *perr);
+#endif
+
 #if OS_Q_POST_FRONT_EN > 0u
 INT8U         OSQPostFront            (OS_EVENT        *pevent,
                                        void            *pmsg);
@@ -1089,6 +1213,11 @@ INT16U        OSSemAccept             (OS_EVENT        *pevent);
 
 OS_EVENT     *OSSemCreate             (INT16U           cnt);
 
+#if OS_STATIC_CREATE_EN > 0u
+OS_EVENT     *OSSemCreateStatic       (OS_EVENT        *pevent,
+                                       INT16U           cnt);
+#endif
+
 #if OS_SEM_DEL_EN > 0u
 OS_EVENT     *OSSemDel                (OS_EVENT        *pevent,
                                        INT8U            opt,
@@ -1138,6 +1267,14 @@ INT8U         OSTaskCreate            (void           (*task)(void *p_arg),
                                        INT8U            prio);
 #endif
 
+#if (OS_TASK_CREATE_EN > 0u) && (OS_STATIC_CREATE_EN > 0u)
+INT8U         OSTaskCreateStatic      (OS_TCB          *ptcb,
+                                       void           (*task)(void *p_arg),
+                                       void            *p_arg,
+                                       OS_STK          *ptos,
+                                       INT8U            prio);
+#endif
+
 #if OS_TASK_CREATE_EXT_EN > 0u
 INT8U         OSTaskCreateExt         (void           (*task)(void *p_arg),
                                        void            *p_arg,
@@ -1165,6 +1302,21 @@ void          OSTaskNameSet           (INT8U            prio,
                                        INT8U           *perr);
 #endif
 
+#if OS_TASK_PROFILE_EN > 0u
+INT8U         OSTaskProfGet           (INT8U            prio,
+                                       OS_TASK_PROF    *p_prof);
+#endif
+
+#if OS_TASK_NOTIFY_EN > 0u
+INT32U        OSTaskNotifyPend        (INT32U           timeout,
+                                       INT32U           clr_mask,
+                                       INT8U           *perr);
+
+INT8U         OSTaskNotifyPost        (INT8U            prio,
+                                       INT32U           val,
+                                       INT8U            opt);
+#endif
+
 #if OS_TASK_SUSPEND_EN > 0u
 INT8U         OSTaskResume            (INT8U            prio);
 INT8U         OSTaskSuspend           (INT8U            prio);
@@ -1222,6 +1374,11 @@ void          OSTimeSet               (INT32U           ticks);
 
 void          OSTimeTick              (void);
 
+#if OS_TICKLESS_EN > 0u
+INT32U        OSTimeNextExpiry        (void);
+void          OSTimeTickN             (INT32U           ticks);
+#endif
+
 /*
 *********************************************************************************************************
 *                                          TIMER MANAGEMENT
@@ -1321,6 +1478,11 @@ void          OS_EventTaskRemoveMulti (OS_TCB          *ptcb,
 void          OS_EventWaitListInit    (OS_EVENT        *pevent);
 #endif
 
+void          OS_TickListInsert       (OS_TCB          *ptcb,
+                                       INT32U           ticks);
+
+void          OS_TickListRemove       (OS_TCB          *ptcb);
+
 #if (OS_FLAG_EN > 0u) && (OS_MAX_FLAGS > 0u)
 void          OS_FlagInit             (void);
 void          OS_FlagUnlink           (OS_FLAG_NODE    *pnode);
@@ -1365,7 +1527,8 @@ void          OS_TaskStkClr           (OS_STK          *pbos,
 void          OS_TaskStatStkChk       (void);
 #endif
 
-INT8U         OS_TCBInit              (INT8U            prio,
+INT8U         OS_TCBInit              (OS_TCB          *ptcb,
+                                       INT8U            prio,
                                        OS_STK          *ptos,
                                        OS_STK          *pbos,
                                        INT16U           id,
@@ -1570,6 +1733,10 @@ void          OSCtxSw                 (void);
     #ifndef OS_MEM_QUERY_EN
     #error  "OS_CFG.H, Missing OS_MEM_QUERY_EN: Include code for OSMemQuery()"
     #endif
+
+    #ifndef OS_MEM_LF_EN
+    #error  "OS_CFG.H, Missing OS_MEM_LF_EN: Include code for lock-free partitions, OSMemLFxxx()"
+    #endif
 #endif
 
 /*
@@ -1615,6 +1782,10 @@ void          OSCtxSw                 (void);
     #error  "OS_CFG.H, Missing OS_Q_ACCEPT_EN: Include code for OSQAccept()"
     #endif
 
+    #ifndef OS_Q_BATCH_EN
+    #error  "OS_CFG.H, Missing OS_Q_BATCH_EN: Include code for OSQPostBatch() and OSQPendBatch()"
+    #endif
+
     #ifndef OS_Q_DEL_EN
     #error  "OS_CFG.H, Missing OS_Q_DEL_EN: Include code for OSQDel()"
     #endif
@@ -1737,6 +1908,10 @@ void          OSCtxSw                 (void);
 #error  "OS_CFG.H, Missing OS_TASK_NAME_EN: Enable task names"
 #endif
 
+#ifndef OS_TASK_NOTIFY_EN
+#error  "OS_CFG.H, Missing OS_TASK_NOTIFY_EN: Include code for OSTaskNotifyPost() and OSTaskNotifyPend()"
+#endif
+
 #ifndef OS_TASK_SUSPEND_EN
 #error  "OS_CFG.H, Missing OS_TASK_SUSPEND_EN: Include code for OSTaskSuspend() and OSTaskResume()"
 #endif
@@ -1872,6 +2047,11 @@ void          OSCtxSw                 (void);
 #endif
 
 
+#ifndef OS_STATIC_CREATE_EN
+#error  "OS_CFG.H, Missing OS_STATIC_CREATE_EN: Include code for OS???CreateStatic()"
+#endif
+
+
 #ifndef OS_EVENT_MULTI_EN
 #error  "OS_CFG.H, Missing OS_EVENT_MULTI_EN: Include code for OSEventPendMulti()"
 #endif
@@ -1896,6 +2076,26 @@ void          OSCtxSw                 (void);
 #error  "OS_CFG.H, Missing OS_TIME_TICK_HOOK_EN: Allows you to include the code for OSTimeTickHook() or not"
 #endif
 
+
+#ifndef OS_TICKLESS_EN
+#error  "OS_CFG.H, Missing OS_TICKLESS_EN: Allows the port to suppress the tick while the CPU is idle"
+#endif
+
+
+#ifndef OS_TRACE_EN
+#error  "OS_CFG.H, Missing OS_TRACE_EN: Include the event trace recorder (os_trace.h)"
+#else
+    #if     OS_TRACE_EN > 0u
+        #ifndef OS_TRACE_BUF_SIZE
+        #error  "OS_CFG.H, Missing OS_TRACE_BUF_SIZE: Trace records per core"
+        #else
+            #if     OS_TRACE_BUF_SIZE < 16u
+            #error  "OS_CFG.H, OS_TRACE_BUF_SIZE must be >= 16"
+            #endif
+        #endif
+    #endif
+#endif
+
 /*
 *********************************************************************************************************
 *                                         SAFETY CRITICAL USE
@@ -1976,6 +2176,14 @@ void          OSCtxSw                 (void);
 
 #endif  /* ------------------------ SAFETY_CRITICAL_RELEASE ------------------------ */
 
+/*
+*********************************************************************************************************
+*                                          EVENT TRACE RECORDER
+*********************************************************************************************************
+*/
+
+#include <os_trace.h>
+
 #ifdef __cplusplus
 }
 #endif
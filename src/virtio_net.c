@@ -14,29 +14,47 @@
 #include <stdbool.h>
 #include "virtio_net.h"
 #include "includes.h"
+#include "amp.h"
+#include "pktbuf.h"
+#include <bsp_cpu.h>
 
 #define VIRTIO_NET_MAX_DEVICES 2
 
+#define VIRTIO_NET_RX_TASK_STK_SIZE 8192u
+
+/* Enough packet buffers to fill every RX and TX ring of every device, plus
+ * what the per-core caches may hold back */
+#define VIRTIO_NET_PKTBUF_COUNT \
+    (VIRTIO_NET_MAX_DEVICES * VIRTIO_NET_MAX_QUEUE_PAIRS * VIRTIO_NET_QUEUE_SIZE * 2u + \
+     PKTBUF_CORES * PKTBUF_CACHE_SIZE)
+
 static struct virtio_net_dev *virtio_net_device_list[VIRTIO_NET_MAX_DEVICES];
 static size_t virtio_net_device_count;
 struct virtio_net_dev *virtio_net_device = NULL;
 
-#define VIRTIO_QUEUE_ALIGN 4096u
+/* Kernel objects of each RX queue pair. They are created from this static
+ * storage, so adding devices or queue pairs does not eat into the kernel
+ * pools sized by APP_CFG_OBJ_TBL. */
+struct virtio_net_rx_objs {
+    OS_TCB tcb;
+    OS_EVENT q_ecb;
+    OS_Q q;
+    OS_STK stk[VIRTIO_NET_RX_TASK_STK_SIZE / sizeof(OS_STK)];
+};
 
-static void *virtio_alloc_queue_mem(size_t size)
-{
-    void *base;
-    uintptr_t aligned;
+static struct virtio_net_rx_objs virtio_net_rx_objs[VIRTIO_NET_MAX_DEVICES][VIRTIO_NET_MAX_QUEUE_PAIRS];
 
-    base = malloc(size + VIRTIO_QUEUE_ALIGN - 1u);
-    if (!base) {
-        return NULL;
-    }
+/* VIRTIO_F_VERSION_1 only needs 16-byte descriptor tables; aligning every
+ * part of a ring to a cache line keeps driver-written and device-written
+ * memory apart */
+#define VIRTIO_QUEUE_ALIGN VIRTIO_NET_CACHE_LINE
 
-    aligned = (uintptr_t)base;
-    aligned = (aligned + (VIRTIO_QUEUE_ALIGN - 1u)) & ~(uintptr_t)(VIRTIO_QUEUE_ALIGN - 1u);
+#define VIRTIO_QUEUE_ROUNDUP(x) (((x) + VIRTIO_QUEUE_ALIGN - 1u) & ~(size_t)(VIRTIO_QUEUE_ALIGN - 1u))
 
-    return (void *)aligned;
+static void *virtio_alloc_queue_mem(size_t size)
+{
+    /* The heap gives the bytes in front of the aligned block back */
+    return memalign(VIRTIO_QUEUE_ALIGN, VIRTIO_QUEUE_ROUNDUP(size));
 }
 
 /* Helper function to align addresses */
@@ -138,6 +156,8 @@ static int virtio_net_init_queue(struct virtio_net_dev *dev, int queue_num,
 {
     u32 queue_size;
     u64 desc_addr, avail_addr, used_addr;
+    size_t avail_off, used_off, ring_size;
+    u8 *ring;
     int i;
 
     /* Select queue */
@@ -159,19 +179,22 @@ static int virtio_net_init_queue(struct virtio_net_dev *dev, int queue_num,
 
     printf(DRIVERNAME ": Queue %d size: %d\n", queue_num, queue_size);
 
-    /* Allocate queue structures */
-    *desc = (struct vring_desc *)virtio_alloc_queue_mem(sizeof(struct vring_desc) * queue_size);
-    *avail = (struct vring_avail *)virtio_alloc_queue_mem(sizeof(struct vring_avail) + sizeof(u16) * queue_size);
-    *used = (struct vring_used *)virtio_alloc_queue_mem(sizeof(struct vring_used) + sizeof(struct vring_used_elem) * queue_size);
+    /* One block per queue: descriptor table and avail ring (driver-written),
+     * then the used ring (device-written), each starting on a cache line */
+    avail_off = VIRTIO_QUEUE_ROUNDUP(sizeof(struct vring_desc) * queue_size);
+    used_off = avail_off + VIRTIO_QUEUE_ROUNDUP(sizeof(struct vring_avail) + sizeof(u16) * queue_size);
+    ring_size = used_off + sizeof(struct vring_used) + sizeof(struct vring_used_elem) * queue_size;
 
-    if (!*desc || !*avail || !*used) {
+    ring = (u8 *)virtio_alloc_queue_mem(ring_size);
+    if (!ring) {
         printf(DRIVERNAME ": Failed to allocate queue structures\n");
         return -1;
     }
 
-    memset(*desc, 0, sizeof(struct vring_desc) * queue_size);
-    memset(*avail, 0, sizeof(struct vring_avail) + sizeof(u16) * queue_size);
-    memset(*used, 0, sizeof(struct vring_used) + sizeof(struct vring_used_elem) * queue_size);
+    memset(ring, 0, VIRTIO_QUEUE_ROUNDUP(ring_size));
+    *desc = (struct vring_desc *)ring;
+    *avail = (struct vring_avail *)(ring + avail_off);
+    *used = (struct vring_used *)(ring + used_off);
 
     /* Set queue addresses */
     desc_addr = virt_to_phys(*desc);
@@ -192,69 +215,32 @@ static int virtio_net_init_queue(struct virtio_net_dev *dev, int queue_num,
     return 0;
 }
 
-/* Enqueue RX packet descriptor (called from ISR) */
-static inline int virtio_net_rx_enqueue(struct virtio_net_queue_pair *qp, u16 buffer_id, u16 len)
-{
-    u16 next_head = (qp->rx_pkt_queue_head + 1) % VIRTIO_NET_RX_PKT_QUEUE_SIZE;
-
-    /* Check if queue is full */
-    if (next_head == qp->rx_pkt_queue_tail) {
-        return -1;  /* Queue full */
-    }
-
-    /* Enqueue packet descriptor (no packet copy!) */
-    qp->rx_pkt_queue[qp->rx_pkt_queue_head].buffer_id = buffer_id;
-    qp->rx_pkt_queue[qp->rx_pkt_queue_head].len = len;
-
-    /* Memory barrier before updating head */
-    __asm__ volatile("dmb sy" ::: "memory");
-
-    qp->rx_pkt_queue_head = next_head;
-
-    return 0;
-}
-
 /* RX processing task - runs at task level, not in ISR context */
 static void virtio_net_rx_task(void *arg)
 {
     struct virtio_net_queue_pair *qp = (struct virtio_net_queue_pair *)arg;
+    void *desc[VIRTIO_NET_RX_BATCH];
     INT8U err;
-    u16 tail;
-    u16 head;
+    u16 nbr;
+    u16 k;
     u16 buffer_id;
     u16 pktlen;
     u8 *pkt;
-    int processed;
 
     while (1) {
-        /* Wait for packets (blocking on semaphore) */
-        OSSemPend(qp->rx_sem, 0, &err);
+        /* Wait for a burst of descriptors: one wakeup per ISR, not per packet */
+        nbr = OSQPendBatch(qp->rx_q, desc, VIRTIO_NET_RX_BATCH, 1u, 0u, &err);
         if (err != OS_ERR_NONE) {
             continue;
         }
 
-        processed = 0;
-
-        /* Process all enqueued packets */
-        while (1) {
-            tail = qp->rx_pkt_queue_tail;
-
-            /* Memory barrier before reading head */
-            __asm__ volatile("dmb sy" ::: "memory");
-
-            head = qp->rx_pkt_queue_head;
-
-            /* Check if queue is empty */
-            if (tail == head) {
-                break;
-            }
-
-            /* Dequeue packet descriptor */
-            buffer_id = qp->rx_pkt_queue[tail].buffer_id;
-            pktlen = qp->rx_pkt_queue[tail].len;
+        OS_TRACE_NET_RX_BEGIN(qp->queue_pair_index, nbr);
+        for (k = 0; k < nbr; k++) {
+            buffer_id = VIRTIO_NET_RX_DESC_ID(desc[k]);
+            pktlen = VIRTIO_NET_RX_DESC_LEN(desc[k]);
 
-            /* Get packet pointer (skip virtio_net_hdr) */
-            pkt = qp->rx_buffers[buffer_id] + sizeof(struct virtio_net_hdr);
+            /* The frame follows the virtio_net_hdr in the buffer's headroom */
+            pkt = pktbuf_data(qp->rx_buffers[buffer_id]);
 
             /* Process packet directly from RX buffer (no copy!) */
             net_process_received_packet(pkt, pktlen);
@@ -262,17 +248,14 @@ static void virtio_net_rx_task(void *arg)
             /* Recycle buffer - make it available to device again */
             qp->rx_avail->ring[qp->rx_avail->idx % VIRTIO_NET_QUEUE_SIZE] = buffer_id;
             qp->rx_avail->idx++;
-            processed++;
-
-            /* Update tail pointer */
-            qp->rx_pkt_queue_tail = (tail + 1) % VIRTIO_NET_RX_PKT_QUEUE_SIZE;
         }
 
         /* Notify device of recycled buffers (batch notification) */
-        if (processed > 0) {
+        if (nbr > 0) {
             int rx_queue_num = qp->queue_pair_index * 2;
             virtio_mmio_write(qp->dev, VIRTIO_MMIO_QUEUE_NOTIFY, rx_queue_num);
         }
+        OS_TRACE_NET_RX_END(qp->queue_pair_index, nbr);
     }
 }
 
@@ -287,7 +270,11 @@ int BSP_OS_VirtioNetHandler(unsigned int cpu_id)
         u16 last_used;
         struct vring_used_elem *elem;
         u32 pktlen;
-        int enqueued = 0;
+        void *batch[VIRTIO_NET_RX_BATCH];
+        u16 batch_used[VIRTIO_NET_RX_BATCH];
+        u16 nbr;
+        u16 posted;
+        INT8U err;
 
         if (!dev) {
             continue;
@@ -306,42 +293,38 @@ int BSP_OS_VirtioNetHandler(unsigned int cpu_id)
             /* Process all queue pairs */
             for (size_t j = 0; j < dev->num_queue_pairs; j++) {
                 struct virtio_net_queue_pair *qp = &dev->queue_pairs[j];
-                enqueued = 0;
-
-                /* Lazy cleanup of TX completions (amortized cost) */
-                qp->tx_last_used = qp->tx_used->idx;
 
-                /* Fast path: Enqueue RX packets without processing */
+                /* Fast path: hand RX descriptors to the RX task in bursts */
                 last_used = qp->rx_last_used;
                 while (last_used != qp->rx_used->idx) {
-                    elem = &qp->rx_used->ring[last_used % VIRTIO_NET_QUEUE_SIZE];
-
-                    if (elem->len < sizeof(struct virtio_net_hdr)) {
+                    nbr = 0;
+                    while (last_used != qp->rx_used->idx && nbr < VIRTIO_NET_RX_BATCH) {
+                        elem = &qp->rx_used->ring[last_used % VIRTIO_NET_QUEUE_SIZE];
                         last_used++;
-                        continue;
-                    }
 
-                    pktlen = elem->len - sizeof(struct virtio_net_hdr);
+                        if (elem->len < sizeof(struct virtio_net_hdr)) {
+                            continue;
+                        }
 
-                    /* Enqueue packet descriptor (no copy!) */
-                    if (pktlen > 0 && pktlen <= PKTSIZE_ALIGN) {
-                        if (virtio_net_rx_enqueue(qp, elem->id, pktlen) == 0) {
-                            enqueued++;
-                        } else {
-                            /* Queue full - will process on next interrupt */
-                            break;
+                        pktlen = elem->len - sizeof(struct virtio_net_hdr);
+                        if (pktlen > 0 && pktlen <= PKTSIZE_ALIGN) {
+                            batch[nbr] = VIRTIO_NET_RX_DESC(elem->id, pktlen);
+                            batch_used[nbr] = last_used;
+                            nbr++;
                         }
                     }
 
-                    last_used++;
+                    /* One critical section and at most one wakeup per burst */
+                    posted = OSQPostBatch(qp->rx_q, batch, nbr, &err);
+                    OS_TRACE_NET_RX_POST(j, posted);
+                    if (posted < nbr) {
+                        /* Queue full - resume at the first descriptor not posted */
+                        last_used = batch_used[posted] - 1u;
+                        break;
+                    }
                 }
 
                 qp->rx_last_used = last_used;
-
-                /* Wake up RX task for this queue pair if packets were enqueued */
-                if (enqueued > 0 && qp->rx_sem) {
-                    OSSemPost(qp->rx_sem);
-                }
             }
         }
     }
@@ -555,16 +538,17 @@ static int virtio_net_init_device(struct virtio_net_dev *dev)
             return -1;
         }
 
-        /* Allocate RX buffers and setup descriptors for this queue pair */
+        /* Give every RX descriptor a pool buffer for the lifetime of the device */
         for (int j = 0; j < VIRTIO_NET_QUEUE_SIZE; j++) {
-            qp->rx_buffers[j] = (u8 *)malloc(PKTSIZE_ALIGN + sizeof(struct virtio_net_hdr));
+            qp->rx_buffers[j] = (u8 *)pktbuf_get();
             if (!qp->rx_buffers[j]) {
                 printf(DRIVERNAME ": Failed to allocate RX buffer %d for pair %d\n", j, i);
                 return -1;
             }
 
-            /* Setup RX descriptor */
-            qp->rx_desc[j].addr = virt_to_phys(qp->rx_buffers[j]);
+            /* Setup RX descriptor: header in the headroom, frame at pktbuf_data() */
+            qp->rx_desc[j].addr = virt_to_phys(pktbuf_data(qp->rx_buffers[j]) -
+                                               sizeof(struct virtio_net_hdr));
             qp->rx_desc[j].len = PKTSIZE_ALIGN + sizeof(struct virtio_net_hdr);
             qp->rx_desc[j].flags = VRING_DESC_F_WRITE;
             qp->rx_desc[j].next = 0;
@@ -586,19 +570,11 @@ static int virtio_net_init_device(struct virtio_net_dev *dev)
             return -1;
         }
 
-        /* Allocate TX buffers for this queue pair */
-        for (int j = 0; j < VIRTIO_NET_QUEUE_SIZE; j++) {
-            qp->tx_buffers[j] = (u8 *)malloc(PKTSIZE_ALIGN + sizeof(struct virtio_net_hdr));
-            if (!qp->tx_buffers[j]) {
-                printf(DRIVERNAME ": Failed to allocate TX buffer %d for pair %d\n", j, i);
-                return -1;
-            }
-        }
+        /* TX descriptors take a pool buffer per frame, see virtio_net_send() */
+        memset(qp->tx_buffers, 0, sizeof(qp->tx_buffers));
 
         qp->rx_last_used = 0;
         qp->tx_last_used = 0;
-        qp->rx_pkt_queue_head = 0;
-        qp->rx_pkt_queue_tail = 0;
     }
     printf(DRIVERNAME ": Step 9 - Queue pairs initialized\n");
 
@@ -628,32 +604,31 @@ static int virtio_net_init_device(struct virtio_net_dev *dev)
     printf(DRIVERNAME ": Creating RX processing tasks...\n");
     for (i = 0; i < dev->num_queue_pairs; i++) {
         struct virtio_net_queue_pair *qp = &dev->queue_pairs[i];
+        struct virtio_net_rx_objs *objs = &virtio_net_rx_objs[virtio_net_device_count][i];
 
-        /* Create semaphore for this queue pair */
-        qp->rx_sem = OSSemCreate(0);
-        if (!qp->rx_sem) {
-            printf(DRIVERNAME ": Failed to create RX semaphore for pair %d\n", i);
+        /* Create the RX descriptor queue for this queue pair */
+        qp->rx_q = OSQCreateStatic(&objs->q_ecb, &objs->q,
+                                   qp->rx_q_storage, VIRTIO_NET_RX_PKT_QUEUE_SIZE);
+        if (!qp->rx_q) {
+            printf(DRIVERNAME ": Failed to create RX queue for pair %d\n", i);
             return -1;
         }
 
-        /* Allocate stack for RX task (8KB) */
-        qp->rx_task_stack = (OS_STK *)malloc(8192);
-        if (!qp->rx_task_stack) {
-            printf(DRIVERNAME ": Failed to allocate RX task stack for pair %d\n", i);
-            return -1;
-        }
+        qp->rx_task_stack = objs->stk;
 
         /* Create RX processing task with unique priority
          * Base priority 10 + device_index * 10 + queue_pair_index */
         qp->rx_task_prio = 10 + (u8)virtio_net_device_count * 10 + i;
-        INT8U err = OSTaskCreate(virtio_net_rx_task,
-                                 (void *)qp,
-                                 &qp->rx_task_stack[8192/sizeof(OS_STK) - 1],
-                                 qp->rx_task_prio);
+        INT8U err = OSTaskCreateStatic(&objs->tcb,
+                                       virtio_net_rx_task,
+                                       (void *)qp,
+                                       &objs->stk[VIRTIO_NET_RX_TASK_STK_SIZE / sizeof(OS_STK) - 1],
+                                       qp->rx_task_prio);
         if (err != OS_ERR_NONE) {
             printf(DRIVERNAME ": Failed to create RX task for pair %d (err=%d)\n", i, err);
             return -1;
         }
+        OSTaskNameSet(qp->rx_task_prio, (INT8U *)"virtio-net RX", &err);
         printf(DRIVERNAME ": RX task created for queue pair %d (priority %d)\n",
                i, qp->rx_task_prio);
     }
@@ -690,6 +665,20 @@ static int virtio_net_init_device(struct virtio_net_dev *dev)
     return 0;
 }
 
+/* Return the buffers of completed TX descriptors to the pool */
+static void virtio_net_tx_reclaim(struct virtio_net_queue_pair *qp)
+{
+    struct vring_used_elem *elem;
+    u16 used_idx = qp->tx_used->idx;
+
+    while (qp->tx_last_used != used_idx) {
+        elem = &qp->tx_used->ring[qp->tx_last_used % VIRTIO_NET_QUEUE_SIZE];
+        pktbuf_put(qp->tx_buffers[elem->id]);
+        qp->tx_buffers[elem->id] = NULL;
+        qp->tx_last_used++;
+    }
+}
+
 /* Send packet */
 int virtio_net_send(struct eth_device *eth_dev, void *packet, int length)
 {
@@ -702,6 +691,11 @@ int virtio_net_send(struct eth_device *eth_dev, void *packet, int length)
     u16 in_flight;
     int tx_queue_num;
     u16 queue_idx;
+    OS_CPU_SR cpu_sr = 0u;
+
+    if (length <= 0 || length > (int)PKTBUF_DATA_SIZE) {
+        return -1;
+    }
 
     /* Select queue pair based on packet hash to maintain per-flow ordering
      * This prevents TCP out-of-order issues with multi-queue.
@@ -720,35 +714,32 @@ int virtio_net_send(struct eth_device *eth_dev, void *packet, int length)
 
     qp = &dev->queue_pairs[queue_idx];
 
-    tx_avail_idx = qp->tx_avail->idx;
+    /* Fill a pool buffer before touching the ring: virtio_net_hdr in the
+     * headroom, frame at pktbuf_data() */
+    buf = (u8 *)pktbuf_get();
+    if (!buf) {
+        return -1;
+    }
+    hdr = (struct virtio_net_hdr *)(pktbuf_data(buf) - sizeof(struct virtio_net_hdr));
+    memset(hdr, 0, sizeof(struct virtio_net_hdr));
+    memcpy(pktbuf_data(buf), packet, length);
 
-    /* Reclaim descriptors completed by the device */
-    qp->tx_last_used = qp->tx_used->idx;
+    /* RX tasks of both devices transmit, so claiming a descriptor and
+     * reclaiming completed ones must not interleave */
+    OS_ENTER_CRITICAL();
+    virtio_net_tx_reclaim(qp);
+    tx_avail_idx = qp->tx_avail->idx;
     in_flight = (u16)(tx_avail_idx - qp->tx_last_used);
-
-    /* Queue still full? refresh once more before dropping the packet */
     if (in_flight >= VIRTIO_NET_QUEUE_SIZE) {
-        qp->tx_last_used = qp->tx_used->idx;
-        in_flight = (u16)(tx_avail_idx - qp->tx_last_used);
-        if (in_flight >= VIRTIO_NET_QUEUE_SIZE) {
-            return -1;
-        }
+        OS_EXIT_CRITICAL();
+        pktbuf_put(buf);
+        return -1;
     }
 
-    /* Get next available TX buffer */
+    /* Setup descriptor; it owns the buffer until the device completes it */
     desc_idx = tx_avail_idx % VIRTIO_NET_QUEUE_SIZE;
-    buf = qp->tx_buffers[desc_idx];
-
-    /* Prepare virtio_net header */
-    hdr = (struct virtio_net_hdr *)buf;
-    memset(hdr, 0, sizeof(struct virtio_net_hdr));
-    hdr->num_buffers = 0;
-
-    /* Copy packet data */
-    memcpy(buf + sizeof(struct virtio_net_hdr), packet, length);
-
-    /* Setup descriptor */
-    qp->tx_desc[desc_idx].addr = virt_to_phys(buf);
+    qp->tx_buffers[desc_idx] = buf;
+    qp->tx_desc[desc_idx].addr = virt_to_phys(hdr);
     qp->tx_desc[desc_idx].len = length + sizeof(struct virtio_net_hdr);
     qp->tx_desc[desc_idx].flags = 0;  /* Read-only for device */
     qp->tx_desc[desc_idx].next = 0;
@@ -756,10 +747,12 @@ int virtio_net_send(struct eth_device *eth_dev, void *packet, int length)
     /* Add to available ring */
     qp->tx_avail->ring[desc_idx] = desc_idx;
     qp->tx_avail->idx = tx_avail_idx + 1;
+    OS_EXIT_CRITICAL();
 
     /* Notify device - TX queue number is (queue_pair_index * 2 + 1) */
     tx_queue_num = qp->queue_pair_index * 2 + 1;
     virtio_mmio_write(dev, VIRTIO_MMIO_QUEUE_NOTIFY, tx_queue_num);
+    OS_TRACE_NET_TX(queue_idx, length);
 
     /* Fire-and-forget: no waiting for completion! */
     return 0;
@@ -842,7 +835,8 @@ static int virtio_net_add_device(unsigned long base_addr, u32 irq)
         return 0;
     }
 
-    dev = (struct virtio_net_dev *)malloc(sizeof(struct virtio_net_dev));
+    /* The queue pairs keep ISR- and sender-written fields on separate lines */
+    dev = (struct virtio_net_dev *)memalign(VIRTIO_NET_CACHE_LINE, sizeof(struct virtio_net_dev));
     if (!dev) {
         printf(DRIVERNAME ": Failed to allocate device structure\n");
         return -1;
@@ -852,6 +846,9 @@ static int virtio_net_add_device(unsigned long base_addr, u32 irq)
 
     dev->iobase = base_addr;
     dev->irq = irq;
+    /* Interrupts follow the RX tasks, which run on the core probing the NIC
+     * (in AMP builds, the image's own core) */
+    dev->irq_cpu = BSP_CPU_IdGet();
 
     if (virtio_net_init_device(dev) < 0) {
         free(dev);
@@ -893,6 +890,10 @@ int virtio_net_initialize(unsigned long base_addr, u32 irq)
 
     printf("[%s] Initializing VirtIO Net driver\n", __func__);
 
+    if (pktbuf_init(VIRTIO_NET_PKTBUF_COUNT) != 0) {
+        return -1;
+    }
+
     found = virtio_net_scan_devices(found_addrs, found_irqs, VIRTIO_NET_MAX_DEVICES);
 
     if (found == 0 && base_addr != 0) {
@@ -902,6 +903,11 @@ int virtio_net_initialize(unsigned long base_addr, u32 irq)
     }
 
     for (int i = 0; i < found; ++i) {
+#ifdef AMP_CORE_ID
+        if (i != AMP_CORE_ID) {
+            continue;
+        }
+#endif
         int rc = virtio_net_add_device(found_addrs[i], found_irqs[i]);
         if (rc > 0) {
             printf(DRIVERNAME ": Registered device at 0x%lx IRQ %u\n",
@@ -921,9 +927,10 @@ int virtio_net_initialize(unsigned long base_addr, u32 irq)
         struct virtio_net_dev *dev = virtio_net_device_list[i];
         if (dev) {
             printf(DRIVERNAME ": Configuring IRQ %u for device %zu\n", dev->irq, i);
-            BSP_IntVectSet(dev->irq, 0u, 0u, BSP_OS_VirtioNetHandler);
+            BSP_IntVectSet(dev->irq, BSP_INT_PRIO_DFLT, 0u, BSP_OS_VirtioNetHandler);
+            BSP_IntAffinitySet(dev->irq, dev->irq_cpu);
             BSP_IntSrcEn(dev->irq);
-            printf(DRIVERNAME ": IRQ %u enabled\n", dev->irq);
+            printf(DRIVERNAME ": IRQ %u enabled on CPU%u\n", dev->irq, dev->irq_cpu);
         }
     }
     printf(DRIVERNAME ": All interrupts configured\n");
@@ -135,6 +135,7 @@ typedef unsigned long long OS_STK;
 
 /* Queue sizes and configuration */
 #define VIRTIO_NET_QUEUE_SIZE   64
+#define VIRTIO_NET_CACHE_LINE   64   /* Cortex-A57 L1/L2 line size */
 #define VIRTIO_NET_MAX_QUEUE_PAIRS  4  /* Maximum number of queue pairs */
 
 /* Queue indices for single-queue mode */
@@ -148,51 +149,50 @@ typedef unsigned long long OS_STK;
  */
 #define VIRTIO_NET_CTRL_QUEUE(n) ((n) * 2)
 
-/* RX packet queue for ISR to task communication */
+/* RX descriptor queue for ISR to task communication */
 #define VIRTIO_NET_RX_PKT_QUEUE_SIZE  128
+#define VIRTIO_NET_RX_BATCH           32   /* Descriptors per OSQPostBatch()/OSQPendBatch() */
 
-struct virtio_net_rx_pkt {
-    u16 buffer_id;   /* Index into rx_buffers[] */
-    u16 len;         /* Packet length (excluding virtio_net_hdr) */
-};
+/* An RX descriptor is the buffer index and packet length (excluding
+ * virtio_net_hdr) packed into the queue message itself, so neither the
+ * packet nor a descriptor is copied on the way to the RX task */
+#define VIRTIO_NET_RX_DESC(id, len)   ((void *)(uintptr_t)(((u32)(id) << 16) | (u32)(len)))
+#define VIRTIO_NET_RX_DESC_ID(desc)   ((u16)((uintptr_t)(desc) >> 16))
+#define VIRTIO_NET_RX_DESC_LEN(desc)  ((u16)((uintptr_t)(desc) & 0xFFFFu))
 
 /* Forward declaration */
 struct virtio_net_dev;
 
-/* Per-queue pair structure */
+/* Per-queue pair structure
+ *
+ * Fields are grouped by the context that writes them, each group starting on
+ * its own cache line, so the ISR, the RX task and a sender on another core
+ * do not keep stealing each other's lines. */
 struct virtio_net_queue_pair {
-    /* Pointer to parent device */
+    /* Read-mostly after initialization */
     struct virtio_net_dev *dev;
-
-    /* RX queue */
     struct vring_desc *rx_desc;
     struct vring_avail *rx_avail;
     struct vring_used *rx_used;
-    u16 rx_last_used;
-    u8 *rx_buffers[VIRTIO_NET_QUEUE_SIZE];
-
-    /* TX queue */
     struct vring_desc *tx_desc;
     struct vring_avail *tx_avail;
     struct vring_used *tx_used;
-    u16 tx_last_used;
-    u8 *tx_buffers[VIRTIO_NET_QUEUE_SIZE];
-
-    /* RX packet queue (ISR to task communication) */
-    struct virtio_net_rx_pkt rx_pkt_queue[VIRTIO_NET_RX_PKT_QUEUE_SIZE];
-    volatile u16 rx_pkt_queue_head;  /* Written by ISR */
-    volatile u16 rx_pkt_queue_tail;  /* Written by task */
-
-    /* Semaphore for RX task wakeup */
-    OS_EVENT *rx_sem;
-
-    /* RX processing task */
+    OS_EVENT *rx_q;                          /* RX descriptor queue (ISR to task communication) */
     OS_STK *rx_task_stack;
     u8 rx_task_prio;
-
-    /* Queue pair index */
     u16 queue_pair_index;
-};
+    u8 *rx_buffers[VIRTIO_NET_QUEUE_SIZE];   /* Pool buffers, one per descriptor for good */
+
+    /* RX used ring consumer, written by the ISR only */
+    u16 rx_last_used __attribute__((aligned(VIRTIO_NET_CACHE_LINE)));
+
+    /* TX state, written by virtio_net_send() only */
+    u16 tx_last_used __attribute__((aligned(VIRTIO_NET_CACHE_LINE)));
+    u8 *tx_buffers[VIRTIO_NET_QUEUE_SIZE];   /* Pool buffer while the device owns the slot */
+
+    /* RX descriptor queue storage, posted by the ISR and pended by the RX task */
+    void *rx_q_storage[VIRTIO_NET_RX_PKT_QUEUE_SIZE] __attribute__((aligned(VIRTIO_NET_CACHE_LINE)));
+} __attribute__((aligned(VIRTIO_NET_CACHE_LINE)));
 
 /* VirtIO Net Device Structure */
 struct virtio_net_dev {
@@ -213,15 +213,16 @@ struct virtio_net_dev {
     u16 ctrl_last_used;
     u8 *ctrl_buffer;
 
-    /* IRQ number */
+    /* IRQ number and the core it is routed to */
     u32 irq;
-
-    /* Diagnostic counts */
-    u32 irq_count;
-    u32 rx_packet_count;
+    u32 irq_cpu;
 
     /* Current TX queue pair (round-robin) */
     u16 current_tx_queue;
+
+    /* Diagnostic counts, bumped by the ISR on their own line */
+    u32 irq_count __attribute__((aligned(VIRTIO_NET_CACHE_LINE)));
+    u32 rx_packet_count;
 };
 
 /* Register access functions */
@@ -1,6 +1,8 @@
 #include <includes.h>
 #include <bsp.h>
 #include <bsp_os.h>
+#include <bsp_int.h>
+#include <aarch64.h>
 #include <uart.h>
 
 #define TEST_TASK_A_PRIO    5u
@@ -10,8 +12,27 @@
 #define TICK_TARGET         1000u
 #define TICK_TOLERANCE      150u
 
+/* ISR-to-task wakeup benchmark: an SGI to ourselves wakes a higher priority
+ * waiter, either through a semaphore or a direct task notification */
+#define BENCH_SEM_PRIO      3u
+#define BENCH_NOTIFY_PRIO   4u
+#define BENCH_SGI_ID        3u
+#define BENCH_ITERATIONS    1000u
+#define BENCH_MODE_SEM      0u
+#define BENCH_MODE_NOTIFY   1u
+#define BENCH_MODE_CNT      2u
+
 static OS_STK test_task_a_stack[TEST_STACK_SIZE];
 static OS_STK test_task_b_stack[TEST_STACK_SIZE];
+static OS_STK bench_sem_stack[TEST_STACK_SIZE];
+static OS_STK bench_notify_stack[TEST_STACK_SIZE];
+
+static OS_EVENT *bench_sem;
+static volatile INT32U bench_mode;
+static volatile CPU_INT64U bench_t0;
+static volatile INT32U bench_cnt[BENCH_MODE_CNT];
+static CPU_INT64U bench_sum[BENCH_MODE_CNT];
+static CPU_INT64U bench_max[BENCH_MODE_CNT];
 
 static volatile INT32U task_a_runs = 0;
 static volatile INT32U task_b_runs = 0;
@@ -24,6 +45,85 @@ static inline INT32U abs_diff(INT32U a, INT32U b)
     return (a > b) ? (a - b) : (b - a);
 }
 
+static void bench_isr(CPU_INT32U int_id)
+{
+    (void)int_id;
+
+    if (bench_mode == BENCH_MODE_SEM) {
+        OSSemPost(bench_sem);
+    } else {
+        OSTaskNotifyPost(BENCH_NOTIFY_PRIO, 1u, OS_NOTIFY_OPT_INC);
+    }
+}
+
+static void bench_record(INT32U mode)
+{
+    CPU_INT64U dt = raw_read_cntvct_el0() - bench_t0;
+
+    bench_sum[mode] += dt;
+    if (dt > bench_max[mode]) {
+        bench_max[mode] = dt;
+    }
+    bench_cnt[mode]++;
+}
+
+static void bench_sem_task(void *p_arg)
+{
+    INT8U err;
+
+    (void)p_arg;
+
+    for (;;) {
+        OSSemPend(bench_sem, 0u, &err);
+        if (err == OS_ERR_NONE) {
+            bench_record(BENCH_MODE_SEM);
+        }
+    }
+}
+
+static void bench_notify_task(void *p_arg)
+{
+    INT8U err;
+
+    (void)p_arg;
+
+    for (;;) {
+        OSTaskNotifyPend(0u, ~0u, &err);
+        if (err == OS_ERR_NONE) {
+            bench_record(BENCH_MODE_NOTIFY);
+        }
+    }
+}
+
+/* Returns the number of completed wakeups for 'mode' */
+static INT32U bench_run(INT32U mode)
+{
+    INT32U start = OSTimeGet();
+
+    bench_mode = mode;
+    for (INT32U i = 0u; i < BENCH_ITERATIONS; ++i) {
+        bench_t0 = raw_read_cntvct_el0();
+        BSP_SGITrig(BENCH_SGI_ID);
+        while ((bench_cnt[mode] == i) && ((OSTimeGet() - start) < 1000u)) {
+            ;                                   /* Waiter preempts us once the SGI is taken */
+        }
+    }
+
+    return bench_cnt[mode];
+}
+
+static void bench_report(const char *name, INT32U mode, CPU_INT32U freq)
+{
+    INT32U cnt = bench_cnt[mode];
+    CPU_INT64U avg = (cnt > 0u) ? (bench_sum[mode] / cnt) : 0u;
+
+    printf("[BENCH] %s wakeup_ns avg=%u max=%u count=%u\n",
+           name,
+           (INT32U)((avg * 1000000000ull) / freq),
+           (INT32U)((bench_max[mode] * 1000000000ull) / freq),
+           cnt);
+}
+
 static void task_b(void *p_arg)
 {
     (void)p_arg;
@@ -81,11 +181,26 @@ static void task_a(void *p_arg)
     INT32U duration = test_end - test_start;
     INT32U ctx_switches = OSCtxSwCtr - cs_before;
     INT32U avg_interval = (interval_sum + (TEST_ITERATIONS / 2u)) / TEST_ITERATIONS;
+    CPU_INT32U irq_lat_last;
+    CPU_INT32U irq_lat_max;
+
+    BSP_OS_TickLatencyGet(&irq_lat_last, &irq_lat_max);
+
+    BSP_IntVectSet(BENCH_SGI_ID, BSP_INT_PRIO_DFLT, 0u, bench_isr);
+    BSP_IntSrcEn(BENCH_SGI_ID);
+    INT32U bench_sem_done = bench_run(BENCH_MODE_SEM);
+    INT32U bench_notify_done = bench_run(BENCH_MODE_NOTIFY);
+    BSP_IntSrcDis(BENCH_SGI_ID);
 
     printf("[STATS] ctx_sw=%u duration_ms=%u avg_tick=%u\n",
            ctx_switches,
            duration,
            avg_interval);
+    printf("[STATS] tick_irq_latency_ns last=%u max=%u\n",
+           irq_lat_last,
+           irq_lat_max);
+    bench_report("sem", BENCH_MODE_SEM, raw_read_cntfrq_el0());
+    bench_report("notify", BENCH_MODE_NOTIFY, raw_read_cntfrq_el0());
     printf("[RESULT] ticks: min=%u max=%u count=%u/%u\n",
            min_interval,
            max_interval,
@@ -94,7 +209,9 @@ static void task_a(void *p_arg)
 
     if ((task_a_runs >= TEST_ITERATIONS) &&
         (task_b_runs >= TEST_ITERATIONS) &&
-        (within_tolerance == TEST_ITERATIONS)) {
+        (within_tolerance == TEST_ITERATIONS) &&
+        (bench_sem_done == BENCH_ITERATIONS) &&
+        (bench_notify_done == BENCH_ITERATIONS)) {
         printf("[PASS] Context switch and timer stability verified\n");
     } else {
         printf("[FAIL] Context/timer test failed\n");
@@ -128,6 +245,30 @@ int main(void)
         return 1;
     }
 
+    bench_sem = OSSemCreate(0u);
+    if (bench_sem == (OS_EVENT *)0) {
+        printf("[ERROR] Failed to create benchmark semaphore\n");
+        return 1;
+    }
+
+    err = OSTaskCreate(bench_sem_task,
+                       0,
+                       &bench_sem_stack[TEST_STACK_SIZE - 1u],
+                       BENCH_SEM_PRIO);
+    if (err != OS_ERR_NONE) {
+        printf("[ERROR] Failed to create semaphore waiter (err=%u)\n", err);
+        return 1;
+    }
+
+    err = OSTaskCreate(bench_notify_task,
+                       0,
+                       &bench_notify_stack[TEST_STACK_SIZE - 1u],
+                       BENCH_NOTIFY_PRIO);
+    if (err != OS_ERR_NONE) {
+        printf("[ERROR] Failed to create notify waiter (err=%u)\n", err);
+        return 1;
+    }
+
     err = OSTaskCreate(task_b,
                        0,
                        &test_task_b_stack[TEST_STACK_SIZE - 1u],
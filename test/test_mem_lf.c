@@ -0,0 +1,314 @@
+#include <includes.h>
+#include <bsp.h>
+#include <bsp_os.h>
+#include <bsp_int.h>
+#include <aarch64.h>
+#include <uart.h>
+
+#define TEST_TASK_PRIO      5u
+#define TEST_STACK_SIZE     4096u
+#define TEST_DURATION_MS    2000u
+
+/* A small partition so that the task and the ISR together can drain it:
+ * the task holds up to two batches of LF_TASK_BATCH, the ISR one batch of
+ * LF_ISR_BATCH, and 2 * 8 + 16 == LF_NBLKS */
+#define LF_NBLKS            32u
+#define LF_BLK_SIZE         64u
+#define LF_TASK_BATCH       8u
+#define LF_ISR_BATCH        16u
+
+/* EL1 physical timer (PPI 14), free for the test since the tick runs on
+ * the virtual timer */
+#define LF_TMR_INT_ID       30u
+#define LF_TMR_RATE_HZ      20000u
+
+#define LF_OWNER_NONE       0u
+#define LF_OWNER_TASK       1u
+#define LF_OWNER_ISR        2u
+
+static OS_STK test_task_stack[TEST_STACK_SIZE];
+
+static OS_MEM_LF lf_part;
+static INT8U lf_pool[LF_NBLKS * LF_BLK_SIZE] __attribute__((aligned(64)));
+
+/* Who holds each block right now, and a stamp written into the block while
+ * it is held: a block handed out twice shows up as a second owner or as a
+ * stamp changed under its holder */
+static volatile INT8U lf_owner[LF_NBLKS];
+static volatile INT32U lf_dups = 0u;
+static volatile INT32U lf_foreign = 0u;
+
+static void *lf_isr_blks[LF_ISR_BATCH];
+static INT32U lf_isr_held = 0u;
+static INT32U lf_isr_rng = 0x9E3779B9u;
+static volatile INT32U lf_isr_runs = 0u;
+static volatile INT32U lf_isr_blks_got = 0u;
+static volatile INT32U lf_isr_empty = 0u;
+static CPU_INT32U lf_tmr_tval;
+
+static inline INT32U lf_rand(INT32U *p_state)
+{
+    INT32U x = *p_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *p_state = x;
+
+    return x;
+}
+
+static inline void lf_tmr_arm(CPU_INT32U tval)
+{
+    __asm__ volatile("msr cntp_tval_el0, %x0" : : "rZ" (tval));
+    __asm__ volatile("msr cntp_ctl_el0, %x0" : : "rZ" (1u));
+    __asm__ volatile("isb");
+}
+
+static inline void lf_tmr_stop(void)
+{
+    __asm__ volatile("msr cntp_ctl_el0, %x0" : : "rZ" (0u));
+    __asm__ volatile("isb");
+}
+
+/* Returns the block index, or LF_NBLKS if 'pblk' is not a block of lf_pool */
+static INT32U lf_index(void *pblk)
+{
+    INT64U off = (INT64U)((INT8U *)pblk - lf_pool);
+
+    if (((INT8U *)pblk < lf_pool) ||
+        (off >= sizeof(lf_pool)) ||
+        ((off % LF_BLK_SIZE) != 0u)) {
+        return LF_NBLKS;
+    }
+
+    return (INT32U)(off / LF_BLK_SIZE);
+}
+
+/* Word 0 is the free list link, so the stamp goes in word 1 */
+static inline INT64U lf_stamp(INT32U owner, INT32U idx)
+{
+    return ((INT64U)owner << 32) | idx;
+}
+
+/* Called with interrupts masked from the task; an ISR runs masked anyway */
+static void lf_claim(void **pblks, INT32U nbr, INT8U owner)
+{
+    for (INT32U i = 0u; i < nbr; ++i) {
+        INT32U idx = lf_index(pblks[i]);
+
+        if (idx >= LF_NBLKS) {
+            lf_foreign++;
+            continue;
+        }
+        if (lf_owner[idx] != LF_OWNER_NONE) {
+            lf_dups++;
+        }
+        lf_owner[idx] = owner;
+        ((volatile INT64U *)pblks[i])[1] = lf_stamp(owner, idx);
+    }
+}
+
+static void lf_release(void **pblks, INT32U nbr, INT8U owner)
+{
+    for (INT32U i = 0u; i < nbr; ++i) {
+        INT32U idx = lf_index(pblks[i]);
+
+        if (idx >= LF_NBLKS) {
+            continue;
+        }
+        if ((lf_owner[idx] != owner) ||
+            (((volatile INT64U *)pblks[i])[1] != lf_stamp(owner, idx))) {
+            lf_dups++;
+        }
+        lf_owner[idx] = LF_OWNER_NONE;
+    }
+}
+
+/* Every tick of the physical timer returns what the ISR took last time and
+ * grabs a fresh batch, so ISR-held blocks cross task activity */
+static void lf_isr(CPU_INT32U int_id)
+{
+    (void)int_id;
+
+    lf_tmr_arm(lf_tmr_tval);
+
+    lf_release(lf_isr_blks, lf_isr_held, LF_OWNER_ISR);
+    (void)OSMemLFPutBatch(&lf_part, lf_isr_blks, lf_isr_held);
+
+    INT32U want = 1u + (lf_rand(&lf_isr_rng) % LF_ISR_BATCH);
+
+    lf_isr_held = OSMemLFGetBatch(&lf_part, lf_isr_blks, want);
+    if (lf_isr_held < want) {
+        lf_isr_empty++;
+    }
+    lf_claim(lf_isr_blks, lf_isr_held, LF_OWNER_ISR);
+
+    lf_isr_blks_got += lf_isr_held;
+    lf_isr_runs++;
+}
+
+/* Walks the free list; returns the number of distinct pool blocks on it, or
+ * LF_NBLKS + 1 if it loops, repeats a block or leaves the pool */
+static INT32U lf_free_walk(void)
+{
+    INT8U seen[LF_NBLKS] = {0u};
+    INT32U cnt = 0u;
+
+    for (void *p = lf_part.OSMemLFFreeList; p != (void *)0; p = *(void **)p) {
+        INT32U idx = lf_index(p);
+
+        if ((idx >= LF_NBLKS) || (seen[idx] != 0u)) {
+            return LF_NBLKS + 1u;
+        }
+        seen[idx] = 1u;
+        cnt++;
+    }
+
+    return cnt;
+}
+
+static void test_task(void *p_arg)
+{
+    void *set_a[LF_TASK_BATCH];
+    void *set_b[LF_TASK_BATCH];
+    INT32U rng = 0x2545F491u;
+    INT32U iterations = 0u;
+    INT32U task_blks_got = 0u;
+    INT32U task_empty = 0u;
+#if OS_CRITICAL_METHOD == 3u
+    OS_CPU_SR cpu_sr = 0u;
+#endif
+
+    (void)p_arg;
+
+    BSP_OS_TmrTickInit(1000u);
+
+    lf_tmr_tval = raw_read_cntfrq_el0() / LF_TMR_RATE_HZ;
+    BSP_IntVectSet(LF_TMR_INT_ID, BSP_INT_PRIO_DFLT, 0u, lf_isr);
+    BSP_IntSrcEn(LF_TMR_INT_ID);
+    lf_tmr_arm(lf_tmr_tval);
+
+    INT32U start = OSTimeGet();
+
+    while ((OSTimeGet() - start) < TEST_DURATION_MS) {
+        INT32U want_a = 1u + (lf_rand(&rng) % LF_TASK_BATCH);
+        INT32U want_b = 1u + (lf_rand(&rng) % LF_TASK_BATCH);
+        INT32U got_a;
+        INT32U got_b;
+
+        got_a = OSMemLFGetBatch(&lf_part, set_a, want_a);
+        OS_ENTER_CRITICAL();
+        lf_claim(set_a, got_a, LF_OWNER_TASK);
+        OS_EXIT_CRITICAL();
+
+        if ((iterations & 1u) != 0u) {  /* Single block calls ride the same stack */
+            set_b[0] = OSMemLFGet(&lf_part);
+            got_b = (set_b[0] != (void *)0) ? 1u : 0u;
+        } else {
+            got_b = OSMemLFGetBatch(&lf_part, set_b, want_b);
+        }
+        OS_ENTER_CRITICAL();
+        lf_claim(set_b, got_b, LF_OWNER_TASK);
+        OS_EXIT_CRITICAL();
+
+        if ((got_a < want_a) || (got_b == 0u)) {
+            task_empty++;
+        }
+        task_blks_got += got_a + got_b;
+
+        OS_ENTER_CRITICAL();
+        lf_release(set_a, got_a, LF_OWNER_TASK);
+        OS_EXIT_CRITICAL();
+        (void)OSMemLFPutBatch(&lf_part, set_a, got_a);
+
+        OS_ENTER_CRITICAL();
+        lf_release(set_b, got_b, LF_OWNER_TASK);
+        OS_EXIT_CRITICAL();
+        if ((iterations & 1u) != 0u) {
+            if (got_b != 0u) {
+                (void)OSMemLFPut(&lf_part, set_b[0]);
+            }
+        } else {
+            (void)OSMemLFPutBatch(&lf_part, set_b, got_b);
+        }
+
+        iterations++;
+    }
+
+    BSP_IntSrcDis(LF_TMR_INT_ID);
+    lf_tmr_stop();
+
+    lf_release(lf_isr_blks, lf_isr_held, LF_OWNER_ISR);
+    (void)OSMemLFPutBatch(&lf_part, lf_isr_blks, lf_isr_held);
+    lf_isr_held = 0u;
+
+    INT32U nfree = __atomic_load_n(&lf_part.OSMemLFNFree, __ATOMIC_RELAXED);
+    INT32U walked = lf_free_walk();
+
+    printf("[STATS] task iterations=%u blocks=%u empty=%u\n",
+           iterations,
+           task_blks_got,
+           task_empty);
+    printf("[STATS] isr runs=%u blocks=%u empty=%u\n",
+           lf_isr_runs,
+           lf_isr_blks_got,
+           lf_isr_empty);
+    printf("[RESULT] dups=%u foreign=%u nfree=%u walked=%u nblks=%u\n",
+           lf_dups,
+           lf_foreign,
+           nfree,
+           walked,
+           LF_NBLKS);
+
+    if ((lf_dups == 0u) &&
+        (lf_foreign == 0u) &&
+        (nfree == LF_NBLKS) &&
+        (walked == LF_NBLKS) &&
+        (iterations > 0u) &&
+        (lf_isr_runs > 0u)) {
+        printf("[PASS] Lock-free partition survived task/ISR contention\n");
+    } else {
+        printf("[FAIL] Lock-free partition test failed\n");
+    }
+
+    for (;;) {
+        OSTimeDlyHMSM(0u, 0u, 1u, 0u);
+    }
+}
+
+int main(void)
+{
+    INT8U err;
+
+    printf("[TEST] Lock-free memory partition validation start\n");
+
+    CPU_Init();
+    Mem_Init();
+    BSP_Init();
+
+    OSInit();
+
+    err = OSMemLFCreate(&lf_part, lf_pool, LF_NBLKS, LF_BLK_SIZE);
+    if (err != OS_ERR_NONE) {
+        printf("[ERROR] Failed to create lock-free partition (err=%u)\n", err);
+        return 1;
+    }
+
+    err = OSTaskCreate(test_task,
+                       0,
+                       &test_task_stack[TEST_STACK_SIZE - 1u],
+                       TEST_TASK_PRIO);
+    if (err != OS_ERR_NONE) {
+        printf("[ERROR] Failed to create test task (err=%u)\n", err);
+        return 1;
+    }
+
+    __asm__ volatile("msr daifclr, #0x2");
+
+    printf("[TEST] Scheduler start\n");
+    OSStart();
+
+    printf("[ERROR] Returned from OSStart()\n");
+    return 1;
+}
@@ -0,0 +1,229 @@
+/*
+ * Host-side stress test and benchmark for the firmware heap (src/heap.c).
+ *
+ * Usage: make heap-bench [HEAP_BENCH_ARGS="iterations seed"]
+ *
+ * Runs a random mix of malloc/free/memalign/realloc over a 64 MiB heap, as
+ * big as the firmware's .heap region. Every block is filled with a pattern
+ * that is checked before it is freed, and heap_check() runs at intervals, so
+ * overlapping blocks or a corrupted free list stop the run. The report gives
+ * the mean and worst-case time per operation and the fragmentation at the
+ * end. Exits non-zero on any failure.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "heap.h"
+
+#define BENCH_HEAP_SIZE         (64u << 20)
+#define BENCH_SLOTS             4096u
+#define BENCH_CHECK_EVERY       65536u
+
+enum { OP_ALLOC, OP_MEMALIGN, OP_FREE, OP_REALLOC, OP_NBR };
+
+static const char *const op_name[OP_NBR] = { "malloc", "memalign", "free", "realloc" };
+
+struct slot {
+    unsigned char *ptr;
+    size_t size;
+    unsigned char tag;
+};
+
+static struct heap bench_heap;
+static struct slot slots[BENCH_SLOTS];
+static uint64_t op_ns[OP_NBR], op_max[OP_NBR], op_cnt[OP_NBR];
+
+static uint64_t rng_state;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)rng_state;
+}
+
+/* Mostly packet-sized blocks with a tail of large ones, like the firmware */
+static size_t rand_size(void)
+{
+    uint32_t r = rng() % 100u;
+
+    if (r < 60u) {
+        return 1u + rng() % 256u;
+    }
+    if (r < 90u) {
+        return 1u + rng() % 2048u;
+    }
+    if (r < 99u) {
+        return 1u + rng() % 65536u;
+    }
+    return 1u + rng() % (1u << 20);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void account(int op, uint64_t t0)
+{
+    uint64_t dt = now_ns() - t0;
+
+    op_ns[op] += dt;
+    op_cnt[op]++;
+    if (dt > op_max[op]) {
+        op_max[op] = dt;
+    }
+}
+
+static int slot_verify(const struct slot *s, unsigned i)
+{
+    size_t k;
+
+    for (k = 0; k < s->size; k++) {
+        if (s->ptr[k] != s->tag) {
+            fprintf(stderr, "slot %u: byte %zu of %zu overwritten\n", i, k, s->size);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void slot_fill(struct slot *s, void *ptr, size_t size)
+{
+    s->ptr = ptr;
+    s->size = size;
+    s->tag = (unsigned char)(rng() | 1u);
+    memset(ptr, s->tag, size);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long iters = argc > 1 ? strtoul(argv[1], NULL, 0) : 2000000ul;
+    unsigned long it;
+    struct heap_stats st;
+    struct slot *s;
+    void *mem, *p;
+    size_t size, align;
+    uint64_t t0;
+    unsigned i;
+    int op, err;
+
+    rng_state = argc > 2 ? strtoull(argv[2], NULL, 0) : 0x9e3779b97f4a7c15ull;
+    if (rng_state == 0u) {
+        rng_state = 1u;
+    }
+
+    mem = malloc(BENCH_HEAP_SIZE);
+    if (mem) {
+        memset(mem, 0, BENCH_HEAP_SIZE);            /* Keep page faults out of the timings */
+    }
+    if (!mem || heap_init(&bench_heap, mem, BENCH_HEAP_SIZE) != 0) {
+        fprintf(stderr, "heap_init failed\n");
+        return 1;
+    }
+
+    for (it = 0; it < iters; it++) {
+        i = rng() % BENCH_SLOTS;
+        s = &slots[i];
+
+        if (s->ptr) {
+            if (slot_verify(s, i) != 0) {
+                return 1;
+            }
+            if (rng() % 4u == 0u) {
+                size = rand_size();
+                t0 = now_ns();
+                p = heap_realloc(&bench_heap, s->ptr, size);
+                account(OP_REALLOC, t0);
+                if (p) {
+                    if (memcmp(p, &s->tag, 1) != 0) {
+                        fprintf(stderr, "realloc lost the contents of slot %u\n", i);
+                        return 1;
+                    }
+                    slot_fill(s, p, size);
+                }
+                continue;
+            }
+            t0 = now_ns();
+            heap_free(&bench_heap, s->ptr);
+            account(OP_FREE, t0);
+            s->ptr = NULL;
+        } else {
+            size = rand_size();
+            if (rng() % 8u == 0u) {
+                align = (size_t)64u << (rng() % 7u);        /* 64 B .. 4 KiB */
+                t0 = now_ns();
+                p = heap_memalign(&bench_heap, align, size);
+                account(OP_MEMALIGN, t0);
+                op = OP_MEMALIGN;
+            } else {
+                align = HEAP_ALIGN;
+                t0 = now_ns();
+                p = heap_alloc(&bench_heap, size);
+                account(OP_ALLOC, t0);
+                op = OP_ALLOC;
+            }
+            if (p) {
+                if (((uintptr_t)p & (align - 1u)) != 0u) {
+                    fprintf(stderr, "%s(%zu) returned %p\n", op_name[op], align, p);
+                    return 1;
+                }
+                slot_fill(s, p, size);
+            }
+        }
+
+        if (it % BENCH_CHECK_EVERY == 0u && (err = heap_check(&bench_heap)) != 0) {
+            fprintf(stderr, "heap_check failed (%d) after %lu operations\n", err, it);
+            return 1;
+        }
+    }
+
+    heap_stats(&bench_heap, &st);
+    printf("heap: %zu KiB, %zu used blocks (%zu KiB), peak %zu KiB, %zu free blocks (%zu KiB)\n",
+           st.size >> 10, st.used_blocks, st.used >> 10, st.peak_used >> 10,
+           st.free_blocks, st.free >> 10);
+    printf("largest free %zu KiB, fragmentation %u.%u%%, %lu failed requests\n",
+           st.largest_free >> 10, st.frag_permille / 10u, st.frag_permille % 10u, st.fails);
+    t0 = now_ns();
+    for (i = 0; i < 100000u; i++) {
+        (void)now_ns();
+    }
+    printf("timings include about %llu ns of clock_gettime() per operation\n",
+           (unsigned long long)((now_ns() - t0) / 100000u));
+    for (op = 0; op < OP_NBR; op++) {
+        if (op_cnt[op]) {
+            printf("%-9s %10llu ops  mean %5llu ns  max %7llu ns\n", op_name[op],
+                   (unsigned long long)op_cnt[op],
+                   (unsigned long long)(op_ns[op] / op_cnt[op]),
+                   (unsigned long long)op_max[op]);
+        }
+    }
+
+    for (i = 0; i < BENCH_SLOTS; i++) {
+        if (slots[i].ptr) {
+            if (slot_verify(&slots[i], i) != 0) {
+                return 1;
+            }
+            heap_free(&bench_heap, slots[i].ptr);
+        }
+    }
+    heap_stats(&bench_heap, &st);
+    if ((err = heap_check(&bench_heap)) != 0 || st.free_blocks != 1u || st.used != 0u) {
+        fprintf(stderr, "heap not whole after freeing everything (check %d, %zu free blocks)\n",
+                err, st.free_blocks);
+        return 1;
+    }
+    printf("PASS\n");
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Convert an OSTraceDump() console capture into Chrome trace JSON.
+
+Usage: tools/trace2json.py console.log [-o trace.json]
+
+Press 't' on the guest console to dump the trace rings, save the console
+output (for example with `make run | tee console.log`) and open the JSON in
+https://ui.perfetto.dev or chrome://tracing. Only the last complete
+BEGIN..END block of the log is converted.
+
+Each core becomes a process. Tasks are threads keyed by priority, interrupt
+handlers share one "IRQ" thread per core. Event IDs must match os_trace.h.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+TASK_SW = 1
+ISR_ENTER = 2
+ISR_EXIT = 3
+SEM_POST = 4
+SEM_PEND = 5
+SEM_PEND_DONE = 6
+NET_RX_POST = 7
+NET_RX_BEGIN = 8
+NET_RX_END = 9
+NET_TX = 10
+
+IRQ_TID = 1000          # Above any task priority (OS_LOWEST_PRIO <= 254)
+
+LINE_RE = re.compile(r"\[TRACE\] (.*)$")
+
+
+def last_block(lines):
+    """Return the lines of the last complete BEGIN..END block."""
+    block = None
+    current = None
+    for line in lines:
+        m = LINE_RE.search(line.rstrip("\r\n"))
+        if not m:
+            continue
+        fields = m.group(1).split(None, 2)
+        if fields[0] == "BEGIN":
+            current = [fields]
+        elif current is not None:
+            if fields[0] == "END":
+                block = current
+                current = None
+            else:
+                current.append(fields if fields[0] != "R" else m.group(1).split())
+    return block
+
+
+def convert(block):
+    freq = int(block[0][1])
+    names = {}
+    records = {}
+    for fields in block[1:]:
+        if fields[0] == "TASK":
+            names[int(fields[1])] = fields[2] if len(fields) > 2 else "?"
+        elif fields[0] == "R":
+            core = int(fields[1])
+            records.setdefault(core, []).append(
+                (int(fields[2], 16), int(fields[3]), int(fields[4]), int(fields[5], 16)))
+
+    events = []
+
+    def us(ts):
+        return ts * 1e6 / freq
+
+    def task_tid(prio):
+        return prio if prio is not None else IRQ_TID
+
+    for core, recs in sorted(records.items()):
+        events.append({"ph": "M", "name": "process_name", "pid": core,
+                       "args": {"name": "Core %d" % core}})
+        events.append({"ph": "M", "name": "thread_name", "pid": core, "tid": IRQ_TID,
+                       "args": {"name": "IRQ"}})
+        seen = set()
+        cur = None
+        cur_start = recs[0][0]
+        isr_stack = []
+        rx_start = {}
+
+        for ts, eid, arg0, arg1 in recs:
+            if eid == TASK_SW:
+                if cur is None:
+                    cur = arg0
+                events.append({"ph": "X", "name": names.get(cur, "prio %d" % cur),
+                               "pid": core, "tid": cur, "ts": us(cur_start),
+                               "dur": us(ts - cur_start)})
+                seen.add(cur)
+                cur = arg1
+                cur_start = ts
+            elif eid == ISR_ENTER:
+                isr_stack.append((ts, arg0))
+            elif eid == ISR_EXIT:
+                if isr_stack:
+                    start, int_id = isr_stack.pop()
+                    events.append({"ph": "X", "name": "IRQ %d" % int_id, "pid": core,
+                                   "tid": IRQ_TID, "ts": us(start), "dur": us(ts - start)})
+            elif eid in (SEM_POST, SEM_PEND, SEM_PEND_DONE):
+                name = {SEM_POST: "OSSemPost", SEM_PEND: "OSSemPend (block)",
+                        SEM_PEND_DONE: "OSSemPend (resume)"}[eid]
+                args = {"sem": "0x%08x" % arg1}
+                if eid == SEM_POST:
+                    args["readied"] = arg0
+                elif eid == SEM_PEND_DONE:
+                    args["err"] = arg0
+                tid = IRQ_TID if isr_stack else task_tid(cur)
+                events.append({"ph": "i", "s": "t", "name": name, "pid": core,
+                               "tid": tid, "ts": us(ts), "args": args})
+            elif eid == NET_RX_POST:
+                events.append({"ph": "i", "s": "t", "name": "virtio RX post", "pid": core,
+                               "tid": IRQ_TID, "ts": us(ts),
+                               "args": {"queue": arg0, "descs": arg1}})
+            elif eid == NET_RX_BEGIN:
+                rx_start[arg0] = ts
+            elif eid == NET_RX_END:
+                start = rx_start.pop(arg0, None)
+                if start is not None:
+                    events.append({"ph": "X", "name": "virtio RX", "pid": core,
+                                   "tid": task_tid(cur), "ts": us(start),
+                                   "dur": us(ts - start),
+                                   "args": {"queue": arg0, "descs": arg1}})
+            elif eid == NET_TX:
+                tid = IRQ_TID if isr_stack else task_tid(cur)
+                events.append({"ph": "i", "s": "t", "name": "virtio TX", "pid": core,
+                               "tid": tid, "ts": us(ts),
+                               "args": {"queue": arg0, "len": arg1}})
+
+        if cur is not None:
+            events.append({"ph": "X", "name": names.get(cur, "prio %d" % cur), "pid": core,
+                           "tid": cur, "ts": us(cur_start), "dur": us(recs[-1][0] - cur_start)})
+            seen.add(cur)
+        for prio in sorted(seen):
+            events.append({"ph": "M", "name": "thread_name", "pid": core, "tid": prio,
+                           "args": {"name": "%s (%d)" % (names.get(prio, "?"), prio)}})
+            events.append({"ph": "M", "name": "thread_sort_index", "pid": core, "tid": prio,
+                           "args": {"sort_index": prio}})
+
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", help="console capture containing an OSTraceDump() block")
+    parser.add_argument("-o", "--output", help="JSON file to write (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.log, errors="replace") as f:
+        block = last_block(f)
+    if block is None:
+        sys.exit("%s: no complete [TRACE] BEGIN..END block" % args.log)
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(convert(block), out)
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()